@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "search_layouts.hpp"
+
+// Per-key cost of get_values against a loop of get_value calls. The sequence holds the even
+// numbers in [0, 2n), so about half of the (uniformly drawn) keys are hits.
+//
+// BM_InterleavedLowerBounds runs BlockIndex::lower_bounds over 64M keys (256 MB, far past
+// the cache) for every layout and a range of searches in flight; 1 is one search at a time.
+
+namespace
+{
+
+iterator_mutex::DataBlockSequence make_even_sequence(int size)
+{
+    std::vector<int> values(size);
+    for (int i = 0; i < size; ++i)
+    {
+        values[i] = 2 * i;
+    }
+    return iterator_mutex::DataBlockSequence(values);
+}
+
+std::vector<int> make_keys(int sequence_size, int count, bool sorted)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 2 * sequence_size - 1);
+    std::vector<int> keys(count);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    if (sorted)
+    {
+        std::sort(keys.begin(), keys.end());
+    }
+    return keys;
+}
+
+constexpr int kBatchSize = 4096;
+
+}  // namespace
+
+static void BM_GetValueLoop(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(static_cast<int>(state.range(0)));
+    const auto keys = make_keys(static_cast<int>(state.range(0)), kBatchSize, state.range(1) != 0);
+    for (auto _ : state)
+    {
+        for (int key : keys)
+        {
+            benchmark::DoNotOptimize(seq.get_value(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+static void BM_GetValuesBatch(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(static_cast<int>(state.range(0)));
+    const auto keys = make_keys(static_cast<int>(state.range(0)), kBatchSize, state.range(1) != 0);
+    std::vector<std::optional<int>> results(keys.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_values(keys, results));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+static void BM_GetValuesBitmap(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(static_cast<int>(state.range(0)));
+    const auto keys = make_keys(static_cast<int>(state.range(0)), kBatchSize, state.range(1) != 0);
+    std::vector<std::uint64_t> found((keys.size() + 63) / 64);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_values(keys, found));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+// Args: {sequence size, keys sorted}
+BENCHMARK(BM_GetValueLoop)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+BENCHMARK(BM_GetValuesBatch)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+BENCHMARK(BM_GetValuesBitmap)->ArgsProduct({{1 << 12, 1 << 20}, {0, 1}});
+
+static void BM_InterleavedLowerBounds(benchmark::State& state)
+{
+    constexpr int kSize = 1 << 26;
+    static const std::vector<int> blocks = []
+    {
+        std::vector<int> values(kSize);
+        for (int i = 0; i < kSize; ++i)
+        {
+            values[static_cast<size_t>(i)] = 2 * i;
+        }
+        return values;
+    }();
+    const iterator_mutex::BlockIndex<int> index(static_cast<iterator_mutex::Layout>(state.range(0)), blocks);
+    const auto keys = make_keys(kSize, kBatchSize, false);
+    const auto in_flight = static_cast<size_t>(state.range(1));
+    for (auto _ : state)
+    {
+        size_t sum = 0;
+        index.lower_bounds(blocks, keys, [&](size_t, size_t position) { sum += position; }, in_flight);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+
+// Args: {layout, searches in flight}
+BENCHMARK(BM_InterleavedLowerBounds)->ArgsProduct({{0, 1, 2, 3}, {1, 4, 8, 16, 32}});
@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "search_layouts.hpp"
+#include "thread_pool.hpp"
+
+// Construction time for shuffled input, copying into the sequence or handing it over, with
+// and without a build pool, against mapping a saved sequence. The second argument is the number of pool workers (0 = no pool),
+// so the caller's thread makes it one more. The third is the layout. Timed in wall-clock time,
+// since the pool threads do most of the work.
+// BM_BuildAcrossSizes is the single-threaded sort and build of the default sequence from
+// shuffled input, from 1K keys up.
+
+namespace
+{
+
+std::vector<int> make_shuffled(int64_t size)
+{
+    std::mt19937 rng(1);
+    std::vector<int> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i);
+    }
+    std::shuffle(values.begin(), values.end(), rng);
+    return values;
+}
+
+iterator_mutex::SequenceOptions make_options(const benchmark::State& state,
+                                             std::unique_ptr<iterator_mutex::ThreadPool>& pool)
+{
+    if (state.range(1) > 0)
+    {
+        pool = std::make_unique<iterator_mutex::ThreadPool>(static_cast<size_t>(state.range(1)));
+    }
+    iterator_mutex::SequenceOptions options;
+    options.layout = static_cast<iterator_mutex::Layout>(state.range(2));
+    options.build_pool = pool.get();
+    return options;
+}
+
+}  // namespace
+
+void BM_BuildFromCopy(benchmark::State& state)
+{
+    const auto values = make_shuffled(state.range(0));
+    std::unique_ptr<iterator_mutex::ThreadPool> pool;
+    const auto options = make_options(state, pool);
+
+    for (auto _ : state)
+    {
+        iterator_mutex::DataBlockSequence seq(values, options);
+        benchmark::DoNotOptimize(seq.get_total_size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_BuildFromRvalue(benchmark::State& state)
+{
+    const auto values = make_shuffled(state.range(0));
+    std::unique_ptr<iterator_mutex::ThreadPool> pool;
+    const auto options = make_options(state, pool);
+
+    for (auto _ : state)
+    {
+        // The copy stands in for freshly loaded input and is not part of the build.
+        state.PauseTiming();
+        std::vector<int> input = values;
+        state.ResumeTiming();
+
+        iterator_mutex::DataBlockSequence seq(std::move(input), options);
+        benchmark::DoNotOptimize(seq.get_total_size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_BuildFromSortedView(benchmark::State& state)
+{
+    auto values = make_shuffled(state.range(0));
+    std::sort(values.begin(), values.end());
+    std::unique_ptr<iterator_mutex::ThreadPool> pool;
+    const auto options = make_options(state, pool);
+
+    for (auto _ : state)
+    {
+        iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, std::span<const int>(values), options);
+        benchmark::DoNotOptimize(seq.get_total_size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OpenMmap(benchmark::State& state)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "iterator_mutex_build_bench.seq").string();
+    {
+        std::unique_ptr<iterator_mutex::ThreadPool> pool;
+        iterator_mutex::DataBlockSequence(make_shuffled(state.range(0)), make_options(state, pool)).save(path);
+    }
+
+    // The file stays in the page cache, so this is the warm start of a second process.
+    for (auto _ : state)
+    {
+        const auto seq = iterator_mutex::DataBlockSequence::open_mmap(path);
+        benchmark::DoNotOptimize(seq.get_value(42));
+    }
+    std::filesystem::remove(path);
+}
+
+void BM_BuildAcrossSizes(benchmark::State& state)
+{
+    const auto values = make_shuffled(state.range(0));
+
+    for (auto _ : state)
+    {
+        iterator_mutex::DataBlockSequence seq(values);
+        benchmark::DoNotOptimize(seq.get_total_size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void build_args(benchmark::internal::Benchmark* bench)
+{
+    for (int64_t workers : {0, 3, 7})
+    {
+        for (auto layout : {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger})
+        {
+            bench->Args({10'000'000, workers, static_cast<int64_t>(layout)});
+        }
+    }
+}
+
+BENCHMARK(BM_BuildFromCopy)->Apply(build_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFromRvalue)->Apply(build_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildFromSortedView)->Apply(build_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OpenMmap)
+    ->Args({10'000'000, 0, static_cast<int64_t>(iterator_mutex::Layout::Eytzinger)})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BuildAcrossSizes)->RangeMultiplier(16)->Range(1 << 10, 1 << 24)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "compressed_block_sequence.hpp"
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value latency and memory of the compressed sequence against the plain sorted one, on
+// dense keys with a gap every 64 keys. Random keys from the whole range, so about half are
+// hits. The bytes_per_key counter is the memory per key of the structure being searched.
+
+namespace
+{
+
+std::vector<int> make_dense(int64_t size)
+{
+    std::vector<int> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i + i / 64);
+    }
+    return values;
+}
+
+template <typename Sequence>
+void run_lookups(benchmark::State& state, const Sequence& seq, int64_t range)
+{
+    std::uint64_t bits = 0x2545F4914F6CDD1Dull;
+    for (auto _ : state)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        benchmark::DoNotOptimize(seq.get_value(static_cast<int>(bits % static_cast<std::uint64_t>(range))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+void BM_UncompressedGetValue(benchmark::State& state)
+{
+    const auto values = make_dense(state.range(0));
+    const iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, values);
+    run_lookups(state, seq, values.back());
+    state.counters["bytes_per_key"] = static_cast<double>(sizeof(int));
+}
+
+void BM_CompressedGetValue(benchmark::State& state)
+{
+    const auto values = make_dense(state.range(0));
+    const iterator_mutex::CompressedBlockSequence seq(iterator_mutex::assume_sorted, values);
+    run_lookups(state, seq, values.back());
+    state.counters["bytes_per_key"] =
+        static_cast<double>(seq.get_memory_usage()) / static_cast<double>(values.size());
+}
+
+BENCHMARK(BM_UncompressedGetValue)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK(BM_CompressedGetValue)->Arg(1'000'000)->Arg(100'000'000);
@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value on the default sequence, split by outcome: a key that is present, a key that is
+// not, and a repeat of the previous key, which the MRU hint answers without a search. The
+// sequence holds the even numbers in [0, 2n), so odd keys miss. The argument is n.
+
+namespace
+{
+
+iterator_mutex::DataBlockSequence make_sequence(int64_t size)
+{
+    std::vector<int> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 2 * static_cast<int>(i);
+    }
+    return iterator_mutex::DataBlockSequence(iterator_mutex::assume_sorted, std::move(values));
+}
+
+// Random keys of the given parity, so every one is a hit or every one a miss.
+std::vector<int> make_probes(int64_t size, int parity)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(size - 1));
+    std::vector<int> probes(1 << 16);
+    for (int& probe : probes)
+    {
+        probe = 2 * dist(rng) + parity;
+    }
+    return probes;
+}
+
+void run_lookups(benchmark::State& state, int parity)
+{
+    const auto seq = make_sequence(state.range(0));
+    const auto probes = make_probes(state.range(0), parity);
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+static void BM_GetValueHit(benchmark::State& state)
+{
+    run_lookups(state, 0);
+}
+
+static void BM_GetValueMiss(benchmark::State& state)
+{
+    run_lookups(state, 1);
+}
+
+static void BM_GetValueMruHit(benchmark::State& state)
+{
+    const auto seq = make_sequence(state.range(0));
+    const int key = static_cast<int>(state.range(0));
+    benchmark::DoNotOptimize(seq.get_value(key));
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_GetValueHit)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
+BENCHMARK(BM_GetValueMiss)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
+BENCHMARK(BM_GetValueMruHit)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
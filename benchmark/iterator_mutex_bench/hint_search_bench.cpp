@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value under each HintSearch, for a local access pattern, where every key is within a
+// few dozen positions of the previous one, and for uniformly random keys. The sequence holds
+// the even numbers in [0, 2n). The arguments are n, the HintSearch and whether access is local.
+// The hint statistics are reported as the fraction of lookups each kind answered.
+
+namespace
+{
+
+std::vector<int> make_probes(int64_t size, bool local)
+{
+    std::mt19937 rng(9);
+    std::vector<int> probes(1 << 16);
+    if (local)
+    {
+        std::uniform_int_distribution<int> step(-64, 64);
+        int key = static_cast<int>(size);
+        for (int& probe : probes)
+        {
+            key = std::clamp(key + step(rng), 0, static_cast<int>(2 * size - 1));
+            probe = key;
+        }
+    }
+    else
+    {
+        std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * size - 1));
+        for (int& probe : probes)
+        {
+            probe = dist(rng);
+        }
+    }
+    return probes;
+}
+
+}  // namespace
+
+static void BM_HintSearch(benchmark::State& state)
+{
+    std::vector<int> values(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 2 * static_cast<int>(i);
+    }
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Eytzinger;
+    options.hint_search = static_cast<iterator_mutex::HintSearch>(state.range(1));
+    options.hint_stats = true;
+    const iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, std::move(values), options);
+    const auto probes = make_probes(state.range(0), state.range(2) != 0);
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    const auto stats = seq.get_hint_stats();
+    const double total = static_cast<double>(stats.exact_hits + stats.near_hits + stats.misses);
+    state.counters["exact"] = static_cast<double>(stats.exact_hits) / total;
+    state.counters["near"] = static_cast<double>(stats.near_hits) / total;
+    state.counters["miss"] = static_cast<double>(stats.misses) / total;
+}
+
+BENCHMARK(BM_HintSearch)
+    ->ArgsProduct({{10'000'000},
+                   {static_cast<int64_t>(iterator_mutex::HintSearch::Exact),
+                    static_cast<int64_t>(iterator_mutex::HintSearch::Finger),
+                    static_cast<int64_t>(iterator_mutex::HintSearch::Interpolation)},
+                   {1, 0}});
@@ -0,0 +1,50 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value on a skewed workload, where 64 hot keys spread over the sequence take 80% of all
+// lookups and the rest are uniformly random, with and without the hot-key cache. The sequence
+// holds the even numbers in [0, 2n). The arguments are n and SequenceOptions::hot_keys.
+
+static void BM_HotKeys(benchmark::State& state)
+{
+    const auto size = static_cast<int>(state.range(0));
+    std::vector<int> values(static_cast<size_t>(size));
+    for (int i = 0; i < size; ++i)
+    {
+        values[static_cast<size_t>(i)] = 2 * i;
+    }
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Eytzinger;
+    options.hot_keys = static_cast<size_t>(state.range(1));
+    options.hint_stats = true;
+    const iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, std::move(values), options);
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> hot(0, 63);
+    std::uniform_int_distribution<int> cold(0, 2 * size - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<int> probes(1 << 16);
+    for (int& probe : probes)
+    {
+        probe = percent(rng) < 80 ? 2 * (hot(rng) * (size / 64)) : cold(rng);
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    const auto stats = seq.get_hint_stats();
+    const double total = static_cast<double>(stats.exact_hits + stats.hot_key_hits + stats.near_hits + stats.misses);
+    state.counters["cached"] = static_cast<double>(stats.exact_hits + stats.hot_key_hits) / total;
+}
+
+BENCHMARK(BM_HotKeys)->ArgsProduct({{10'000'000}, {0, 64, 256}});
@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value when 70% of keys are absent, with and without the key filter. The sequence holds
+// the even numbers in [0, 2n) and absent keys are odd. The arguments are n and
+// SequenceOptions::filter_bits_per_key.
+
+static void BM_FilteredMisses(benchmark::State& state)
+{
+    std::vector<int> values(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 2 * static_cast<int>(i);
+    }
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Eytzinger;
+    options.filter_bits_per_key = static_cast<size_t>(state.range(1));
+    const iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, std::move(values), options);
+
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(state.range(0) - 1));
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<int> probes(1 << 16);
+    for (int& probe : probes)
+    {
+        probe = 2 * dist(rng) + (percent(rng) < 70 ? 1 : 0);
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["filter_bytes"] = static_cast<double>(seq.get_filter_bytes());
+}
+
+BENCHMARK(BM_FilteredMisses)->ArgsProduct({{1'000'000, 10'000'000}, {0, 10}});
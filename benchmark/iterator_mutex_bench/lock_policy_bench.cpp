@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <shared_mutex>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+// How get_value throughput scales with the number of reader threads for each lock policy.
+// All threads read the same sequence; items_per_second is the aggregate rate.
+//
+// BM_SnapshotReaders does the same lookups through snapshot(), state.range(0) of them per
+// snapshot, so the lock is taken once per run of lookups instead of once per lookup.
+
+namespace
+{
+
+constexpr int kSequenceSize = 1 << 16;
+
+template <typename LockPolicy>
+std::unique_ptr<iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>>& shared_sequence()
+{
+    static std::unique_ptr<iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>> seq;
+    return seq;
+}
+
+}  // namespace
+
+template <typename LockPolicy, iterator_mutex::MruMode Mode>
+void BM_GetValueReaders(benchmark::State& state)
+{
+    auto& seq = shared_sequence<LockPolicy>();
+    // Thread 0 sets up before the loop; the others wait at the loop start until it is done.
+    if (state.thread_index() == 0)
+    {
+        std::vector<int> values(kSequenceSize);
+        std::iota(values.begin(), values.end(), 0);
+        iterator_mutex::SequenceOptions options;
+        options.mru_mode = Mode;
+        seq = std::make_unique<iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>>(values, options);
+    }
+
+    // Each thread walks its own pseudo-random key stream, repeating every key once so the
+    // MRU hint has something to hit.
+    std::uint32_t state_bits = 0x9E3779B9u * static_cast<std::uint32_t>(state.thread_index() + 1);
+    std::uint64_t iteration = 0;
+    int key = 0;
+    for (auto _ : state)
+    {
+        if ((iteration++ & 1) == 0)
+        {
+            state_bits = state_bits * 1664525u + 1013904223u;
+            key = static_cast<int>(state_bits % kSequenceSize);
+        }
+        benchmark::DoNotOptimize(seq->get_value(key));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        seq.reset();
+    }
+}
+
+template <typename LockPolicy>
+void BM_SnapshotReaders(benchmark::State& state)
+{
+    auto& seq = shared_sequence<LockPolicy>();
+    if (state.thread_index() == 0)
+    {
+        std::vector<int> values(kSequenceSize);
+        std::iota(values.begin(), values.end(), 0);
+        iterator_mutex::SequenceOptions options;
+        options.mru_mode = iterator_mutex::MruMode::PerThread;
+        seq = std::make_unique<iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>>(values, options);
+    }
+
+    const auto per_snapshot = static_cast<int>(state.range(0));
+    std::uint32_t state_bits = 0x9E3779B9u * static_cast<std::uint32_t>(state.thread_index() + 1);
+    for (auto _ : state)
+    {
+        const auto snap = seq->snapshot();
+        for (int i = 0; i < per_snapshot; ++i)
+        {
+            state_bits = state_bits * 1664525u + 1013904223u;
+            benchmark::DoNotOptimize(snap.get_value(static_cast<int>(state_bits % kSequenceSize)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * per_snapshot);
+
+    if (state.thread_index() == 0)
+    {
+        seq.reset();
+    }
+}
+
+using iterator_mutex::EpochMutex;
+using iterator_mutex::ExclusiveMutex;
+using iterator_mutex::MruMode;
+
+BENCHMARK_TEMPLATE(BM_GetValueReaders, ExclusiveMutex, MruMode::Shared)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GetValueReaders, std::shared_mutex, MruMode::Shared)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GetValueReaders, std::shared_mutex, MruMode::PerThread)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GetValueReaders, EpochMutex, MruMode::Shared)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GetValueReaders, EpochMutex, MruMode::PerThread)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_SnapshotReaders, std::shared_mutex)->Arg(1)->Arg(16)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SnapshotReaders, EpochMutex)->Arg(1)->Arg(16)->ThreadRange(1, 32)->UseRealTime();
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "memory_resources.hpp"
+
+// A rebuild cycle, loading fresh keys and swapping them into a live sequence, with the keys
+// from the default heap, from huge pages and from a recycling pool over either. Then random
+// lookups in a sequence on default pages against one on huge pages, where the difference is
+// the TLB misses. The argument is the number of keys.
+
+namespace
+{
+
+enum Resource : int64_t
+{
+    kDefault,
+    kHugePages,
+    kRecycling,
+    kRecyclingHugePages,
+};
+
+std::pmr::vector<int> make_keys(int64_t size, std::pmr::memory_resource* resource)
+{
+    std::pmr::vector<int> keys(static_cast<size_t>(size), resource);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<int>(i) * 2;
+    }
+    return keys;
+}
+
+}  // namespace
+
+void BM_RebuildCycle(benchmark::State& state)
+{
+    iterator_mutex::HugePageResource huge_pages;
+    iterator_mutex::RecyclingResource recycling_default;
+    iterator_mutex::RecyclingResource recycling_huge(&huge_pages);
+    std::pmr::memory_resource* resources[] = {std::pmr::new_delete_resource(), &huge_pages, &recycling_default,
+                                              &recycling_huge};
+    auto* resource = resources[state.range(1)];
+
+    iterator_mutex::pmr::DataBlockSequence seq(iterator_mutex::assume_sorted, make_keys(state.range(0), resource));
+    for (auto _ : state)
+    {
+        seq = iterator_mutex::pmr::DataBlockSequence(iterator_mutex::assume_sorted,
+                                                     make_keys(state.range(0), resource));
+        benchmark::DoNotOptimize(seq.get_total_size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LookupOnPages(benchmark::State& state)
+{
+    iterator_mutex::HugePageResource huge_pages;
+    auto* resource = state.range(1) == kHugePages ? static_cast<std::pmr::memory_resource*>(&huge_pages)
+                                                  : std::pmr::new_delete_resource();
+    const iterator_mutex::pmr::DataBlockSequence seq(iterator_mutex::assume_sorted,
+                                                     make_keys(state.range(0), resource));
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(state.range(0)) * 2);
+    std::vector<int> probes(1 << 16);
+    for (int& probe : probes)
+    {
+        probe = dist(rng);
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RebuildCycle)
+    ->ArgsProduct({{10'000'000}, {kDefault, kHugePages, kRecycling, kRecyclingHugePages}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LookupOnPages)->ArgsProduct({{10'000'000, 100'000'000}, {kDefault, kHugePages}});
@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+// Move construction and move assignment, for each lock policy, while state.range(0) reader
+// threads call get_value on the sequence being moved in a tight loop, so every move has to
+// wait for the readers in the lock and every reader sees the sequence come and go. Each
+// iteration moves the keys out and back, so the sequence is whole again at the start of the
+// next; items are moves, or swaps for BM_SwapUnderReaders. The readers' aggregate lookup
+// rate is reported as "lookups".
+// Readers that never pause can hold a reader-preferring lock such as glibc's
+// std::shared_mutex indefinitely once there are more of them than cores, so keep the reader
+// count below the core count when comparing machines.
+//
+// BM_VectorGrowth fills a std::vector of small sequences without reserving, so every
+// reallocation relocates all the sequences so far by move construction.
+
+namespace
+{
+
+constexpr int kSequenceSize = 1 << 20;
+
+template <typename Sequence>
+class Readers
+{
+public:
+    Readers(const Sequence& seq, int64_t count)
+    {
+        for (int64_t t = 0; t < count; ++t)
+        {
+            threads_.emplace_back([this, &seq, t] {
+                std::uint32_t state_bits = 0x9E3779B9u * static_cast<std::uint32_t>(t + 1);
+                std::uint64_t lookups = 0;
+                while (!stop_.load(std::memory_order_relaxed))
+                {
+                    state_bits = state_bits * 1664525u + 1013904223u;
+                    benchmark::DoNotOptimize(seq.get_value(static_cast<int>(state_bits % kSequenceSize)));
+                    ++lookups;
+                }
+                lookups_.fetch_add(lookups, std::memory_order_relaxed);
+            });
+        }
+    }
+
+    Readers(const Readers&) = delete;
+    Readers& operator=(const Readers&) = delete;
+
+    // Stops and joins the readers; returns how many lookups they made.
+    std::uint64_t stop()
+    {
+        stop_.store(true, std::memory_order_relaxed);
+        for (auto& thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+        return lookups_.load(std::memory_order_relaxed);
+    }
+
+    ~Readers()
+    {
+        stop();
+    }
+
+private:
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> lookups_{0};
+};
+
+template <typename LockPolicy>
+using Sequence = iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>;
+
+template <typename LockPolicy, typename MoveOutAndBack>
+void run_moves(benchmark::State& state, MoveOutAndBack&& move_out_and_back)
+{
+    std::vector<int> values(kSequenceSize);
+    std::iota(values.begin(), values.end(), 0);
+    Sequence<LockPolicy> seq(iterator_mutex::assume_sorted, std::move(values));
+    Readers readers(seq, state.range(0));
+
+    for (auto _ : state)
+    {
+        move_out_and_back(seq);
+    }
+
+    const std::uint64_t lookups = readers.stop();
+    state.SetItemsProcessed(state.iterations() * 2);
+    state.counters["lookups"] = benchmark::Counter(static_cast<double>(lookups), benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+template <typename LockPolicy>
+void BM_MoveConstructUnderReaders(benchmark::State& state)
+{
+    run_moves<LockPolicy>(state, [](Sequence<LockPolicy>& seq) {
+        Sequence<LockPolicy> moved(std::move(seq));
+        seq = std::move(moved);
+    });
+}
+
+template <typename LockPolicy>
+void BM_MoveAssignUnderReaders(benchmark::State& state)
+{
+    Sequence<LockPolicy> spare(std::vector<int>{});
+    run_moves<LockPolicy>(state, [&spare](Sequence<LockPolicy>& seq) {
+        spare = std::move(seq);
+        seq = std::move(spare);
+    });
+}
+
+template <typename LockPolicy>
+void BM_SwapUnderReaders(benchmark::State& state)
+{
+    Sequence<LockPolicy> spare(std::vector<int>{1, 2, 3});
+    run_moves<LockPolicy>(state, [&spare](Sequence<LockPolicy>& seq) {
+        seq.swap(spare);
+        seq.swap(spare);
+    });
+}
+
+static void BM_VectorGrowth(benchmark::State& state)
+{
+    const auto count = static_cast<size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::vector<iterator_mutex::DataBlockSequence> sequences;
+        for (size_t i = 0; i < count; ++i)
+        {
+            sequences.emplace_back(iterator_mutex::assume_sorted, std::vector<int>{0, 1, 2, 3});
+        }
+        benchmark::DoNotOptimize(sequences.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using iterator_mutex::EpochMutex;
+using iterator_mutex::ExclusiveMutex;
+
+BENCHMARK_TEMPLATE(BM_MoveConstructUnderReaders, ExclusiveMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MoveConstructUnderReaders, std::shared_mutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MoveConstructUnderReaders, EpochMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MoveAssignUnderReaders, ExclusiveMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MoveAssignUnderReaders, std::shared_mutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_MoveAssignUnderReaders, EpochMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SwapUnderReaders, ExclusiveMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SwapUnderReaders, std::shared_mutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SwapUnderReaders, EpochMutex)->DenseRange(0, 2)->UseRealTime();
+BENCHMARK(BM_VectorGrowth)->Arg(1'000)->Arg(100'000);
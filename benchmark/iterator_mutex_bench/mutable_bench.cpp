@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "mutable_block_sequence.hpp"
+
+// Updates against the mutable sequence, and what a pending delta costs lookups. The rebuild
+// benchmark is the alternative without it: a new sorted vector moved into the sequence per
+// batch of changes. Odd keys are inserted, even keys are in the base array.
+
+namespace
+{
+
+std::vector<int> make_even(int64_t size)
+{
+    std::vector<int> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i * 2);
+    }
+    return values;
+}
+
+std::uint64_t next_bits(std::uint64_t& bits)
+{
+    bits ^= bits << 13;
+    bits ^= bits >> 7;
+    bits ^= bits << 17;
+    return bits;
+}
+
+}  // namespace
+
+// One insert and one erase of a random odd key per iteration, with background compaction.
+void BM_MutableInsertErase(benchmark::State& state)
+{
+    const int64_t size = state.range(0);
+    iterator_mutex::MutableBlockSequence seq(make_even(size));
+    std::uint64_t bits = 0x2545F4914F6CDD1Dull;
+    for (auto _ : state)
+    {
+        const int key = static_cast<int>(next_bits(bits) % static_cast<std::uint64_t>(size)) * 2 + 1;
+        benchmark::DoNotOptimize(seq.insert(key));
+        benchmark::DoNotOptimize(seq.erase(key));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// Rebuilding the immutable sequence for a batch of state.range(1) inserts.
+void BM_RebuildPerBatch(benchmark::State& state)
+{
+    const auto base = make_even(state.range(0));
+    iterator_mutex::DataBlockSequence seq(iterator_mutex::assume_sorted, base);
+    for (auto _ : state)
+    {
+        std::vector<int> values = base;
+        for (int64_t i = 0; i < state.range(1); ++i)
+        {
+            values.push_back(static_cast<int>(i * 2 + 1));
+        }
+        seq = iterator_mutex::DataBlockSequence(std::move(values));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+// Random lookups with state.range(1) changes pending in the delta.
+void BM_MutableGetValue(benchmark::State& state)
+{
+    const int64_t size = state.range(0);
+    iterator_mutex::MutableSequenceOptions options;
+    options.background_compaction = false;
+    options.compaction_threshold = SIZE_MAX;
+    iterator_mutex::MutableBlockSequence seq(make_even(size), options);
+    for (int64_t i = 0; i < state.range(1); ++i)
+    {
+        seq.insert(static_cast<int>(i * 2 + 1));
+    }
+
+    std::uint64_t bits = 0x2545F4914F6CDD1Dull;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq.get_value(static_cast<int>(next_bits(bits) % static_cast<std::uint64_t>(size))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_MutableInsertErase)->Arg(1'000'000);
+BENCHMARK(BM_RebuildPerBatch)->Args({1'000'000, 1024});
+BENCHMARK(BM_MutableGetValue)->Args({1'000'000, 0})->Args({1'000'000, 4096});
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "query_executor.hpp"
+
+// Throughput of lookups through a QueryExecutor, answered by callback, for a range of
+// max_batch values; 1 answers every request on its own, as a pool that calls get_value per
+// request would. BM_ExecutorDirectGetValue is the same keys looked up inline on the
+// benchmark thread, the floor the executor's queueing and hand-off are measured against.
+// The sequence holds the even numbers in [0, 2n), so about half of the keys are hits.
+
+namespace
+{
+
+constexpr int kSequenceSize = 1 << 22;
+constexpr int kRequests = 1 << 14;
+
+std::vector<int> make_keys()
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, 2 * kSequenceSize - 1);
+    std::vector<int> keys(kRequests);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    return keys;
+}
+
+std::vector<iterator_mutex::DataBlockSequence> make_sequences()
+{
+    std::vector<int> values(kSequenceSize);
+    for (int i = 0; i < kSequenceSize; ++i)
+    {
+        values[i] = 2 * i;
+    }
+    std::vector<iterator_mutex::DataBlockSequence> sequences;
+    sequences.emplace_back(iterator_mutex::assume_sorted, std::move(values));
+    return sequences;
+}
+
+}  // namespace
+
+static void BM_ExecutorDirectGetValue(benchmark::State& state)
+{
+    const auto sequences = make_sequences();
+    const auto keys = make_keys();
+    for (auto _ : state)
+    {
+        for (int key : keys)
+        {
+            benchmark::DoNotOptimize(sequences[0].get_value(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kRequests);
+}
+BENCHMARK(BM_ExecutorDirectGetValue);
+
+static void BM_ExecutorLookups(benchmark::State& state)
+{
+    iterator_mutex::QueryExecutorOptions options;
+    options.max_batch = static_cast<size_t>(state.range(0));
+    iterator_mutex::QueryExecutor executor(make_sequences(), options);
+    const auto keys = make_keys();
+
+    std::atomic<int> answered{0};
+    const auto on_done = [&answered](std::optional<int> result) {
+        benchmark::DoNotOptimize(result);
+        answered.fetch_add(1, std::memory_order_relaxed);
+    };
+    for (auto _ : state)
+    {
+        answered.store(0, std::memory_order_relaxed);
+        for (int key : keys)
+        {
+            executor.lookup(0, key, on_done);
+        }
+        while (answered.load(std::memory_order_relaxed) < kRequests)
+        {
+            std::this_thread::yield();
+        }
+    }
+    state.counters["workers"] = static_cast<double>(executor.worker_count());
+    state.SetItemsProcessed(state.iterations() * kRequests);
+}
+BENCHMARK(BM_ExecutorLookups)->Arg(1)->Arg(8)->Arg(64)->Arg(256)->UseRealTime();
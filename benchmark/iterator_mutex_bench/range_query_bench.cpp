@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// Range scans over the even numbers in [0, 2n): count_range and for_each_in_range against
+// probing every candidate key of the range with get_value, which is what callers did before.
+// The first argument is n, the second the width of the range in key space.
+
+namespace
+{
+
+iterator_mutex::DataBlockSequence make_even_sequence(int64_t size)
+{
+    std::vector<int> values(static_cast<size_t>(size));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 2 * static_cast<int>(i);
+    }
+    return iterator_mutex::DataBlockSequence(values);
+}
+
+std::vector<int> make_starts(int64_t size, int64_t width)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * size - width));
+    std::vector<int> starts(1 << 12);
+    for (int& start : starts)
+    {
+        start = dist(rng);
+    }
+    return starts;
+}
+
+}  // namespace
+
+static void BM_CountRange(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(state.range(0));
+    const auto starts = make_starts(state.range(0), state.range(1));
+    const int width = static_cast<int>(state.range(1));
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        const int lo = starts[i++ & (starts.size() - 1)];
+        benchmark::DoNotOptimize(seq.count_range(lo, lo + width));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ForEachInRange(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(state.range(0));
+    const auto starts = make_starts(state.range(0), state.range(1));
+    const int width = static_cast<int>(state.range(1));
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        const int lo = starts[i++ & (starts.size() - 1)];
+        std::int64_t sum = 0;
+        seq.for_each_in_range(lo, lo + width, [&](int key) { sum += key; });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_RangeByPointLookups(benchmark::State& state)
+{
+    const auto seq = make_even_sequence(state.range(0));
+    const auto starts = make_starts(state.range(0), state.range(1));
+    const int width = static_cast<int>(state.range(1));
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        const int lo = starts[i++ & (starts.size() - 1)];
+        std::int64_t sum = 0;
+        for (int key = lo; key < lo + width; ++key)
+        {
+            if (const auto value = seq.get_value(key))
+            {
+                sum += *value;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CountRange)->ArgsProduct({{1'000'000}, {16, 1024, 65536}});
+BENCHMARK(BM_ForEachInRange)->ArgsProduct({{1'000'000}, {16, 1024, 65536}});
+BENCHMARK(BM_RangeByPointLookups)->ArgsProduct({{1'000'000}, {16, 1024}});
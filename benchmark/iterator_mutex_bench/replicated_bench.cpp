@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include "replicated_block_sequence.hpp"
+
+// get_value throughput over reader threads with one replica per NUMA node against a single
+// unplaced replica (state.range(0) == 0). On a multi-socket machine the difference is the
+// cross-socket traffic saved; on one node it is the cost of routing. items_per_second is the
+// aggregate rate.
+
+namespace
+{
+
+constexpr int kSequenceSize = 1 << 22;
+
+std::unique_ptr<iterator_mutex::ReplicatedBlockSequence>& shared_sequence()
+{
+    static std::unique_ptr<iterator_mutex::ReplicatedBlockSequence> seq;
+    return seq;
+}
+
+}  // namespace
+
+void BM_ReplicatedGetValueReaders(benchmark::State& state)
+{
+    auto& seq = shared_sequence();
+    // Thread 0 sets up before the loop; the others wait at the loop start until it is done.
+    if (state.thread_index() == 0)
+    {
+        std::vector<int> values(kSequenceSize);
+        std::iota(values.begin(), values.end(), 0);
+        iterator_mutex::ReplicatedSequenceOptions options;
+        options.sequence.mru_mode = iterator_mutex::MruMode::PerThread;
+        options.replicate = state.range(0) != 0;
+        seq = std::make_unique<iterator_mutex::ReplicatedBlockSequence>(values, options);
+        state.counters["replicas"] = static_cast<double>(seq->get_replica_count());
+    }
+
+    std::uint32_t state_bits = 0x9E3779B9u * static_cast<std::uint32_t>(state.thread_index() + 1);
+    for (auto _ : state)
+    {
+        state_bits = state_bits * 1664525u + 1013904223u;
+        benchmark::DoNotOptimize(seq->get_value(static_cast<int>(state_bits % kSequenceSize)));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        seq.reset();
+    }
+}
+
+BENCHMARK(BM_ReplicatedGetValueReaders)->Arg(0)->Arg(1)->ThreadRange(1, 32)->UseRealTime();
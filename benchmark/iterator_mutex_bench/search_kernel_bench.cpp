@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "search_kernels.hpp"
+
+// Search kernels against std::lower_bound: the 16-key leaf scan on its own and a full
+// lower_bound over arrays that fit in L1, L2 and RAM. Kernels the CPU lacks are skipped.
+
+namespace
+{
+
+std::uint64_t next_random(std::uint64_t& bits)
+{
+    bits ^= bits << 13;
+    bits ^= bits >> 7;
+    bits ^= bits << 17;
+    return bits;
+}
+
+bool select_kernel(benchmark::State& state, iterator_mutex::SearchKernel kernel)
+{
+    if (!iterator_mutex::is_search_kernel_supported(kernel))
+    {
+        state.SkipWithError("kernel not supported on this CPU");
+        return false;
+    }
+    iterator_mutex::use_search_kernel(kernel);
+    return true;
+}
+
+}  // namespace
+
+template <iterator_mutex::SearchKernel Kernel>
+void BM_CountLessLeaf(benchmark::State& state)
+{
+    if (!select_kernel(state, Kernel))
+    {
+        return;
+    }
+    std::vector<int> leaf(16);
+    std::iota(leaf.begin(), leaf.end(), 0);
+    std::uint64_t bits = 0x9E3779B97F4A7C15ull;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(iterator_mutex::count_less(leaf.data(), leaf.size(), static_cast<int>(next_random(bits) % 17)));
+    }
+    state.SetItemsProcessed(state.iterations());
+    iterator_mutex::use_search_kernel(iterator_mutex::detected_search_kernel());
+}
+
+template <iterator_mutex::SearchKernel Kernel>
+void BM_SearchLowerBound(benchmark::State& state)
+{
+    if (!select_kernel(state, Kernel))
+    {
+        return;
+    }
+    std::vector<int> data(static_cast<size_t>(state.range(0)));
+    std::iota(data.begin(), data.end(), 0);
+    std::uint64_t bits = 0x9E3779B97F4A7C15ull;
+    for (auto _ : state)
+    {
+        const int value = static_cast<int>(next_random(bits) % data.size());
+        benchmark::DoNotOptimize(iterator_mutex::search_lower_bound(data.data(), data.size(), value));
+    }
+    state.SetItemsProcessed(state.iterations());
+    iterator_mutex::use_search_kernel(iterator_mutex::detected_search_kernel());
+}
+
+static void BM_StdLowerBound(benchmark::State& state)
+{
+    std::vector<int> data(static_cast<size_t>(state.range(0)));
+    std::iota(data.begin(), data.end(), 0);
+    std::uint64_t bits = 0x9E3779B97F4A7C15ull;
+    for (auto _ : state)
+    {
+        const int value = static_cast<int>(next_random(bits) % data.size());
+        benchmark::DoNotOptimize(std::lower_bound(data.begin(), data.end(), value));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+using iterator_mutex::SearchKernel;
+
+BENCHMARK_TEMPLATE(BM_CountLessLeaf, SearchKernel::Scalar);
+BENCHMARK_TEMPLATE(BM_CountLessLeaf, SearchKernel::Avx2);
+BENCHMARK_TEMPLATE(BM_CountLessLeaf, SearchKernel::Avx512);
+BENCHMARK_TEMPLATE(BM_CountLessLeaf, SearchKernel::Neon);
+
+BENCHMARK(BM_StdLowerBound)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 24);
+BENCHMARK_TEMPLATE(BM_SearchLowerBound, SearchKernel::Scalar)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 24);
+BENCHMARK_TEMPLATE(BM_SearchLowerBound, SearchKernel::Avx2)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 24);
+BENCHMARK_TEMPLATE(BM_SearchLowerBound, SearchKernel::Avx512)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 24);
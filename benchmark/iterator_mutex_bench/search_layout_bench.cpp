@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "search_layouts.hpp"
+
+// get_value latency per layout at 1K, 1M and 100M elements. Keys are drawn at random from
+// the sequence, so every lookup is a hit that the MRU hint practically never catches and
+// the search kernel dominates. The 100M case needs about 1 GB of memory.
+//
+// BM_LearnedEpsilon sweeps the Learned layout's error bound over 10M uniformly random keys,
+// which no single line fits, and reports the model size next to the latency. Its argument 0
+// runs the Sorted layout on the same keys as the baseline.
+
+namespace
+{
+
+iterator_mutex::DataBlockSequence make_sequence(int64_t size, iterator_mutex::Layout layout)
+{
+    std::vector<int> values(static_cast<size_t>(size));
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::SequenceOptions options;
+    options.layout = layout;
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    return iterator_mutex::DataBlockSequence(values, options);
+}
+
+}  // namespace
+
+template <iterator_mutex::Layout L>
+void BM_LayoutGetValue(benchmark::State& state)
+{
+    const int64_t size = state.range(0);
+    const auto seq = make_sequence(size, L);
+
+    std::uint64_t bits = 0x2545F4914F6CDD1Dull;
+    for (auto _ : state)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        benchmark::DoNotOptimize(seq.get_value(static_cast<int>(bits % static_cast<std::uint64_t>(size))));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+using iterator_mutex::Layout;
+
+BENCHMARK_TEMPLATE(BM_LayoutGetValue, Layout::Sorted)->Arg(1'000)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK_TEMPLATE(BM_LayoutGetValue, Layout::Eytzinger)->Arg(1'000)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK_TEMPLATE(BM_LayoutGetValue, Layout::BTree)->Arg(1'000)->Arg(1'000'000)->Arg(100'000'000);
+BENCHMARK_TEMPLATE(BM_LayoutGetValue, Layout::Learned)->Arg(1'000)->Arg(1'000'000)->Arg(100'000'000);
+
+static void BM_LearnedEpsilon(benchmark::State& state)
+{
+    constexpr size_t kSize = 10'000'000;
+    std::mt19937_64 rng(23);
+    std::vector<std::int64_t> values(kSize);
+    for (auto& value : values)
+    {
+        value = static_cast<std::int64_t>(rng() >> 1);
+    }
+    std::sort(values.begin(), values.end());
+
+    iterator_mutex::SequenceOptions options;
+    options.layout = state.range(0) == 0 ? Layout::Sorted : Layout::Learned;
+    options.learned_epsilon = static_cast<size_t>(state.range(0));
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    const iterator_mutex::BlockIndex<std::int64_t> model(options.layout, values, {}, nullptr, options.learned_epsilon);
+    const size_t segments = model.image().learned_segments.size();
+    const iterator_mutex::BasicDataBlockSequence<std::int64_t> seq(iterator_mutex::assume_sorted, values, options);
+
+    std::uint64_t bits = 0x2545F4914F6CDD1Dull;
+    for (auto _ : state)
+    {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        benchmark::DoNotOptimize(seq.get_value(values[bits % kSize]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["segments"] = static_cast<double>(segments);
+    state.counters["model_bytes"] =
+        static_cast<double>(segments * (sizeof(iterator_mutex::LearnedSegment) + sizeof(std::int64_t)));
+}
+
+BENCHMARK(BM_LearnedEpsilon)->Arg(0)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "search_kernels.hpp"
+
+// Intersections of a sequence of 1M keys with one state.range(0) times smaller, the keys of
+// both drawn from [0, 4M): BM_IntersectGetValueLoop is the get_value call per key of the
+// smaller one that intersect_count replaces, run on every kernel. items_per_second counts the
+// keys of both inputs. BM_MergeUnion merges state.range(0) sequences of 1M keys in total.
+
+namespace
+{
+
+constexpr int kLargeSize = 1 << 20;
+constexpr int kKeyRange = 4 * kLargeSize;
+
+std::vector<int> random_keys(int count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, kKeyRange - 1);
+    std::vector<int> keys(static_cast<size_t>(count));
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+struct Inputs
+{
+    iterator_mutex::DataBlockSequence large;
+    iterator_mutex::DataBlockSequence small;
+};
+
+Inputs make_inputs(benchmark::State& state)
+{
+    const int small_size = kLargeSize / static_cast<int>(state.range(0));
+    return {iterator_mutex::DataBlockSequence(iterator_mutex::assume_sorted, random_keys(kLargeSize, 1)),
+            iterator_mutex::DataBlockSequence(iterator_mutex::assume_sorted, random_keys(small_size, 2))};
+}
+
+}  // namespace
+
+static void BM_IntersectGetValueLoop(benchmark::State& state)
+{
+    const Inputs inputs = make_inputs(state);
+    for (auto _ : state)
+    {
+        size_t found = 0;
+        for (int key : inputs.small.get_keys())
+        {
+            found += inputs.large.get_value(key).has_value() ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * (kLargeSize + inputs.small.get_total_size()));
+}
+BENCHMARK(BM_IntersectGetValueLoop)->RangeMultiplier(8)->Range(1, 4096);
+
+template <iterator_mutex::SearchKernel Kernel>
+void BM_IntersectCount(benchmark::State& state)
+{
+    if (!iterator_mutex::is_search_kernel_supported(Kernel))
+    {
+        state.SkipWithError("kernel not supported on this CPU");
+        return;
+    }
+    iterator_mutex::use_search_kernel(Kernel);
+    const Inputs inputs = make_inputs(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(iterator_mutex::DataBlockSequence::intersect_count(inputs.small, inputs.large));
+    }
+    state.SetItemsProcessed(state.iterations() * (kLargeSize + inputs.small.get_total_size()));
+    iterator_mutex::use_search_kernel(iterator_mutex::detected_search_kernel());
+}
+BENCHMARK_TEMPLATE(BM_IntersectCount, iterator_mutex::SearchKernel::Scalar)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK_TEMPLATE(BM_IntersectCount, iterator_mutex::SearchKernel::Avx2)->RangeMultiplier(8)->Range(1, 4096);
+BENCHMARK_TEMPLATE(BM_IntersectCount, iterator_mutex::SearchKernel::Avx512)->RangeMultiplier(8)->Range(1, 4096);
+
+static void BM_Intersect(benchmark::State& state)
+{
+    const Inputs inputs = make_inputs(state);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(iterator_mutex::DataBlockSequence::intersect(inputs.small, inputs.large));
+    }
+    state.SetItemsProcessed(state.iterations() * (kLargeSize + inputs.small.get_total_size()));
+}
+BENCHMARK(BM_Intersect)->Arg(1)->Arg(64);
+
+static void BM_MergeUnion(benchmark::State& state)
+{
+    const auto count = static_cast<int>(state.range(0));
+    std::vector<iterator_mutex::DataBlockSequence> sequences;
+    std::vector<const iterator_mutex::DataBlockSequence*> inputs;
+    sequences.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        const auto seed = static_cast<unsigned>(i);
+        sequences.emplace_back(iterator_mutex::assume_sorted, random_keys(kLargeSize / count, seed));
+        inputs.push_back(&sequences.back());
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(iterator_mutex::DataBlockSequence::merge_union(inputs));
+    }
+    state.SetItemsProcessed(state.iterations() * kLargeSize);
+}
+BENCHMARK(BM_MergeUnion)->Arg(2)->Arg(4)->Arg(16);
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <shared_mutex>
+#include <vector>
+
+#include "sharded_block_sequence.hpp"
+
+// How get_value throughput scales with reader threads when the keys are split into
+// state.range(0) shards, each with its own std::shared_mutex and shared MRU hint. One shard
+// is the unsharded baseline. items_per_second is the aggregate rate.
+
+namespace
+{
+
+constexpr int kSequenceSize = 1 << 16;
+
+std::unique_ptr<iterator_mutex::ShardedBlockSequence>& shared_sequence()
+{
+    static std::unique_ptr<iterator_mutex::ShardedBlockSequence> seq;
+    return seq;
+}
+
+}  // namespace
+
+void BM_ShardedGetValueReaders(benchmark::State& state)
+{
+    auto& seq = shared_sequence();
+    // Thread 0 sets up before the loop; the others wait at the loop start until it is done.
+    if (state.thread_index() == 0)
+    {
+        std::vector<int> values(kSequenceSize);
+        std::iota(values.begin(), values.end(), 0);
+        iterator_mutex::ShardedSequenceOptions options;
+        options.shard_count = static_cast<size_t>(state.range(0));
+        seq = std::make_unique<iterator_mutex::ShardedBlockSequence>(values, options);
+    }
+
+    std::uint32_t state_bits = 0x9E3779B9u * static_cast<std::uint32_t>(state.thread_index() + 1);
+    for (auto _ : state)
+    {
+        state_bits = state_bits * 1664525u + 1013904223u;
+        benchmark::DoNotOptimize(seq->get_value(static_cast<int>(state_bits % kSequenceSize)));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        seq.reset();
+    }
+}
+
+BENCHMARK(BM_ShardedGetValueReaders)->Arg(1)->Arg(16)->Arg(64)->ThreadRange(1, 32)->UseRealTime();
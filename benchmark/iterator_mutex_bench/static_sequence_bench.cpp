@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "static_block_sequence.hpp"
+
+// get_value on a small table of the even numbers in [0, 2N): a StaticBlockSequence built at
+// compile time against a DataBlockSequence of the same keys. Probes are random keys in
+// [0, 2N), so half of them miss, and change on every call so the MRU hint never answers.
+
+namespace
+{
+
+template <size_t N>
+constexpr std::array<int, N> even_keys()
+{
+    std::array<int, N> keys{};
+    for (size_t i = 0; i < N; ++i)
+    {
+        // Reversed, so the compile-time sort has work to do.
+        keys[i] = 2 * static_cast<int>(N - 1 - i);
+    }
+    return keys;
+}
+
+template <size_t N>
+constexpr iterator_mutex::StaticBlockSequence<N> kTable{even_keys<N>()};
+
+std::vector<int> make_probes(size_t size)
+{
+    std::mt19937 rng(29);
+    std::uniform_int_distribution<int> dist(0, 2 * static_cast<int>(size) - 1);
+    std::vector<int> probes(1 << 12);
+    for (int& probe : probes)
+    {
+        probe = dist(rng);
+    }
+    return probes;
+}
+
+template <typename Sequence>
+void run_lookups(benchmark::State& state, const Sequence& sequence)
+{
+    const auto probes = make_probes(sequence.get_total_size());
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(sequence.get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+template <size_t N>
+static void BM_StaticGetValue(benchmark::State& state)
+{
+    run_lookups(state, kTable<N>);
+}
+
+template <size_t N>
+static void BM_StaticBaselineGetValue(benchmark::State& state)
+{
+    const auto keys = kTable<N>.get_keys();
+    const iterator_mutex::DataBlockSequence sequence(iterator_mutex::assume_sorted,
+                                                     std::vector<int>(keys.begin(), keys.end()));
+    run_lookups(state, sequence);
+}
+
+BENCHMARK(BM_StaticGetValue<16>);
+BENCHMARK(BM_StaticGetValue<64>);
+BENCHMARK(BM_StaticGetValue<256>);
+BENCHMARK(BM_StaticBaselineGetValue<16>);
+BENCHMARK(BM_StaticBaselineGetValue<64>);
+BENCHMARK(BM_StaticBaselineGetValue<256>);
@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// get_value on uniformly random keys, from one or more threads, as the cost of the stats:
+// run it from a build configured with -DITERATOR_MUTEX_STATS=ON and one without. The
+// sequence holds the even numbers in [0, 2n). The argument is n. With stats compiled in,
+// the lookup count and hit rate of the run are reported.
+
+namespace
+{
+
+std::unique_ptr<iterator_mutex::DataBlockSequence> g_sequence;
+
+}  // namespace
+
+static void BM_StatsOverhead(benchmark::State& state)
+{
+    auto& seq = g_sequence;
+    // Thread 0 sets up before the loop; the others wait at the loop start until it is done.
+    if (state.thread_index() == 0)
+    {
+        std::vector<int> values(static_cast<size_t>(state.range(0)));
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = 2 * static_cast<int>(i);
+        }
+        iterator_mutex::SequenceOptions options;
+        options.layout = iterator_mutex::Layout::Eytzinger;
+        seq = std::make_unique<iterator_mutex::DataBlockSequence>(iterator_mutex::assume_sorted, std::move(values),
+                                                                  options);
+    }
+
+    std::mt19937 rng(17 + static_cast<unsigned>(state.thread_index()));
+    std::uniform_int_distribution<int> dist(0, static_cast<int>(2 * state.range(0) - 1));
+    std::vector<int> probes(1 << 16);
+    for (int& probe : probes)
+    {
+        probe = dist(rng);
+    }
+
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(seq->get_value(probes[i++ & (probes.size() - 1)]));
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0)
+    {
+        const auto stats = seq->stats();
+        if (stats.lookups > 0)
+        {
+            state.counters["lookups"] = static_cast<double>(stats.lookups);
+            state.counters["hit_rate"] = static_cast<double>(stats.lookup_hits) / static_cast<double>(stats.lookups);
+        }
+        seq.reset();
+    }
+}
+
+BENCHMARK(BM_StatsOverhead)->Arg(1'000'000)->Threads(1)->Threads(4)->UseRealTime();
@@ -0,0 +1,379 @@
+// A load generator for one sequence: readers calling get_value as fast as they can while
+// writers periodically move the keys out of the sequence and back, reporting throughput and
+// latency percentiles per operation. Unlike stress_test.py, which only reruns the unit tests
+// until one crashes, it shows what a lock policy costs readers while moves race with them.
+//
+//   iterator_mutex_load --readers=8 --writers=1 --lock=shared --distribution=zipf --seconds=10
+//
+// Run with --help for every option.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_distributions.hpp"
+#include "lock_policies.hpp"
+#include "sequence_stats.hpp"
+
+namespace
+{
+
+using iterator_mutex::KeyDistribution;
+using iterator_mutex::LatencyHistogram;
+
+enum class Lock
+{
+    Exclusive,
+    Shared,
+    Epoch,
+};
+
+struct LoadOptions
+{
+    unsigned readers = 4;
+    unsigned writers = 1;
+    std::uint64_t keys = 1'000'000;
+    double seconds = 5.0;
+    // Pause of each writer between moving the keys out and back and doing it again.
+    std::chrono::microseconds move_interval{1000};
+    KeyDistribution distribution = KeyDistribution::Uniform;
+    double zipf_exponent = 0.99;
+    Lock lock = Lock::Shared;
+    iterator_mutex::MruMode mru_mode = iterator_mutex::MruMode::Shared;
+    iterator_mutex::Layout layout = iterator_mutex::Layout::Sorted;
+    bool json = false;
+};
+
+constexpr std::string_view kUsage = R"(Usage: iterator_mutex_load [options]
+
+  --readers=N            get_value threads (default 4)
+  --writers=N            threads moving the keys out of the sequence and back (default 1)
+  --keys=N               keys in the sequence (default 1000000)
+  --seconds=S            how long to run (default 5)
+  --move-interval-us=N   pause of each writer between moves (default 1000)
+  --distribution=D       uniform, zipf or sequential (default uniform)
+  --zipf-exponent=S      skew of the Zipf distribution (default 0.99)
+  --lock=L               exclusive, shared or epoch (default shared)
+  --mru=M                shared or per-thread (default shared)
+  --layout=L             sorted, eytzinger, btree or learned (default sorted)
+  --json                 print the report as JSON
+)";
+
+template <typename Enum>
+Enum parse_choice(std::string_view option, std::string_view value,
+                  std::initializer_list<std::pair<std::string_view, Enum>> choices)
+{
+    for (const auto& [name, choice] : choices)
+    {
+        if (value == name)
+        {
+            return choice;
+        }
+    }
+    throw std::invalid_argument("unknown value for " + std::string(option) + ": " + std::string(value));
+}
+
+// Throws std::invalid_argument on anything it does not understand.
+LoadOptions parse_options(int argc, char** argv)
+{
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const auto equals = arg.find('=');
+        const std::string_view name = arg.substr(0, equals);
+        const std::string value(equals == std::string_view::npos ? std::string_view{} : arg.substr(equals + 1));
+
+        if (name == "--readers")
+        {
+            options.readers = static_cast<unsigned>(std::stoul(value));
+        }
+        else if (name == "--writers")
+        {
+            options.writers = static_cast<unsigned>(std::stoul(value));
+        }
+        else if (name == "--keys")
+        {
+            options.keys = std::stoull(value);
+        }
+        else if (name == "--seconds")
+        {
+            options.seconds = std::stod(value);
+        }
+        else if (name == "--move-interval-us")
+        {
+            options.move_interval = std::chrono::microseconds(std::stoll(value));
+        }
+        else if (name == "--distribution")
+        {
+            options.distribution = parse_choice<KeyDistribution>(name, value,
+                                                                 {{"uniform", KeyDistribution::Uniform},
+                                                                  {"zipf", KeyDistribution::Zipf},
+                                                                  {"sequential", KeyDistribution::Sequential}});
+        }
+        else if (name == "--zipf-exponent")
+        {
+            options.zipf_exponent = std::stod(value);
+        }
+        else if (name == "--lock")
+        {
+            options.lock = parse_choice<Lock>(
+                name, value, {{"exclusive", Lock::Exclusive}, {"shared", Lock::Shared}, {"epoch", Lock::Epoch}});
+        }
+        else if (name == "--mru")
+        {
+            options.mru_mode = parse_choice<iterator_mutex::MruMode>(
+                name, value,
+                {{"shared", iterator_mutex::MruMode::Shared}, {"per-thread", iterator_mutex::MruMode::PerThread}});
+        }
+        else if (name == "--layout")
+        {
+            options.layout = parse_choice<iterator_mutex::Layout>(name, value,
+                                                                  {{"sorted", iterator_mutex::Layout::Sorted},
+                                                                   {"eytzinger", iterator_mutex::Layout::Eytzinger},
+                                                                   {"btree", iterator_mutex::Layout::BTree},
+                                                                   {"learned", iterator_mutex::Layout::Learned}});
+        }
+        else if (name == "--json")
+        {
+            options.json = true;
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option: " + std::string(arg));
+        }
+    }
+
+    if (options.keys == 0 || options.keys > static_cast<std::uint64_t>(INT32_MAX / 2))
+    {
+        throw std::invalid_argument("--keys must be in [1, 2^30)");
+    }
+    if (options.zipf_exponent <= 0.0)
+    {
+        throw std::invalid_argument("--zipf-exponent must be positive");
+    }
+    return options;
+}
+
+// What one thread measured. Each thread has its own, merged after the run.
+struct ThreadResult
+{
+    LatencyHistogram latency;
+    std::uint64_t hits = 0;
+};
+
+struct Report
+{
+    std::string_view operation;
+    LatencyHistogram latency;
+    std::uint64_t hits = 0;
+};
+
+std::uint64_t nanoseconds_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+template <typename LockPolicy>
+std::vector<Report> run(const LoadOptions& options)
+{
+    using Sequence = iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>;
+
+    // 1. The even numbers in [0, 2 * keys), so a key the readers ask for is present unless a
+    //    writer has moved the keys out.
+    std::vector<int> values(options.keys);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = 2 * static_cast<int>(i);
+    }
+    iterator_mutex::SequenceOptions sequence_options;
+    sequence_options.mru_mode = options.mru_mode;
+    sequence_options.layout = options.layout;
+    Sequence seq(iterator_mutex::assume_sorted, std::move(values), sequence_options);
+
+    // 2. Start every thread, then let them go at once.
+    std::atomic<bool> start{false};
+    std::atomic<bool> stop{false};
+    std::vector<ThreadResult> reader_results(options.readers);
+    std::vector<ThreadResult> writer_results(options.writers);
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < options.readers; ++t)
+    {
+        threads.emplace_back([&, t] {
+            iterator_mutex::KeyGenerator next_key(options.distribution, options.keys, options.zipf_exponent, t);
+            ThreadResult& result = reader_results[t];
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const int key = 2 * static_cast<int>(next_key());
+                const auto before = std::chrono::steady_clock::now();
+                const bool hit = seq.get_value(key).has_value();
+                result.latency.record(nanoseconds_between(before, std::chrono::steady_clock::now()));
+                result.hits += hit;
+            }
+        });
+    }
+
+    for (unsigned t = 0; t < options.writers; ++t)
+    {
+        threads.emplace_back([&, t] {
+            Sequence spare(std::vector<int>{}, sequence_options);
+            ThreadResult& result = writer_results[t];
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                // Out and back, so the sequence is whole again between rounds. Each move is
+                // timed on its own, since each takes the lock on its own. If another writer
+                // has the keys out, this one got an empty sequence and must not move it back
+                // over the keys when they return.
+                auto before = std::chrono::steady_clock::now();
+                spare = std::move(seq);
+                auto after = std::chrono::steady_clock::now();
+                result.latency.record(nanoseconds_between(before, after));
+
+                if (spare.get_total_size() > 0)
+                {
+                    before = after;
+                    seq = std::move(spare);
+                    after = std::chrono::steady_clock::now();
+                    result.latency.record(nanoseconds_between(before, after));
+                }
+
+                std::this_thread::sleep_for(options.move_interval);
+            }
+        });
+    }
+
+    start.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // 3. Merge per operation.
+    std::vector<Report> reports{{"get_value", {}, 0}, {"move_assign", {}, 0}};
+    for (const ThreadResult& result : reader_results)
+    {
+        reports[0].latency.merge(result.latency);
+        reports[0].hits += result.hits;
+    }
+    for (const ThreadResult& result : writer_results)
+    {
+        reports[1].latency.merge(result.latency);
+    }
+    return reports;
+}
+
+void print_text(const LoadOptions& options, const std::vector<Report>& reports)
+{
+    std::printf("%-12s %14s %14s %10s %10s %10s %10s\n", "operation", "ops", "ops/sec", "p50 ns", "p99 ns",
+                "p999 ns", "max ns");
+    for (const Report& report : reports)
+    {
+        const auto& latency = report.latency;
+        std::printf("%-12s %14llu %14.0f %10llu %10llu %10llu %10llu\n", std::string(report.operation).c_str(),
+                    static_cast<unsigned long long>(latency.count()),
+                    static_cast<double>(latency.count()) / options.seconds,
+                    static_cast<unsigned long long>(latency.percentile(0.5)),
+                    static_cast<unsigned long long>(latency.percentile(0.99)),
+                    static_cast<unsigned long long>(latency.percentile(0.999)),
+                    static_cast<unsigned long long>(latency.percentile(1.0)));
+    }
+    if (reports[0].latency.count() > 0)
+    {
+        std::printf("get_value hit rate: %.4f\n",
+                    static_cast<double>(reports[0].hits) / static_cast<double>(reports[0].latency.count()));
+    }
+}
+
+void print_json(const LoadOptions& options, const std::vector<Report>& reports)
+{
+    std::printf("{\n  \"readers\": %u,\n  \"writers\": %u,\n  \"keys\": %llu,\n  \"seconds\": %g,\n"
+                "  \"operations\": [\n",
+                options.readers, options.writers, static_cast<unsigned long long>(options.keys), options.seconds);
+    for (size_t i = 0; i < reports.size(); ++i)
+    {
+        const auto& latency = reports[i].latency;
+        std::printf("    {\"name\": \"%s\", \"ops\": %llu, \"ops_per_sec\": %.1f, \"hits\": %llu, \"mean_ns\": %.1f, "
+                    "\"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu}%s\n",
+                    std::string(reports[i].operation).c_str(), static_cast<unsigned long long>(latency.count()),
+                    static_cast<double>(latency.count()) / options.seconds,
+                    static_cast<unsigned long long>(reports[i].hits), latency.mean(),
+                    static_cast<unsigned long long>(latency.percentile(0.5)),
+                    static_cast<unsigned long long>(latency.percentile(0.99)),
+                    static_cast<unsigned long long>(latency.percentile(0.999)),
+                    static_cast<unsigned long long>(latency.percentile(1.0)), i + 1 < reports.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string_view(argv[i]) == "--help")
+        {
+            std::cout << kUsage;
+            return 0;
+        }
+    }
+
+    LoadOptions options;
+    try
+    {
+        options = parse_options(argc, argv);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "iterator_mutex_load: " << e.what() << "\n\n" << kUsage;
+        return 2;
+    }
+
+    std::vector<Report> reports;
+    switch (options.lock)
+    {
+        case Lock::Exclusive:
+            reports = run<iterator_mutex::ExclusiveMutex>(options);
+            break;
+        case Lock::Shared:
+            reports = run<std::shared_mutex>(options);
+            break;
+        case Lock::Epoch:
+            reports = run<iterator_mutex::EpochMutex>(options);
+            break;
+    }
+
+    if (options.json)
+    {
+        print_json(options, reports);
+    }
+    else
+    {
+        print_text(options, reports);
+    }
+    return 0;
+}
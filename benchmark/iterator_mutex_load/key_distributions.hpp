@@ -0,0 +1,117 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace iterator_mutex
+{
+
+enum class KeyDistribution
+{
+    Uniform,
+    Zipf,
+    Sequential,
+};
+
+// Zipf-distributed ranks in [1, n], P(k) proportional to 1 / k^exponent, by rejection
+// inversion (Hörmann and Derflinger, 1996): constant memory and a few transcendental calls
+// per sample, however large n is. exponent must be positive.
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(std::uint64_t n, double exponent)
+        : n_(static_cast<double>(n)),
+          exponent_(exponent),
+          h_x1_(big_h(1.5) - 1.0),
+          h_n_(big_h(n_ + 0.5)),
+          s_(2.0 - big_h_inverse(big_h(2.5) - h(2.0)))
+    {
+    }
+
+    template <typename Engine>
+    std::uint64_t operator()(Engine& engine) const
+    {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        while (true)
+        {
+            const double u = h_n_ + uniform(engine) * (h_x1_ - h_n_);
+            const double x = big_h_inverse(u);
+            const double k = std::clamp(std::round(x), 1.0, n_);
+            if (k - x <= s_ || u >= big_h(k + 0.5) - h(k))
+            {
+                return static_cast<std::uint64_t>(k);
+            }
+        }
+    }
+
+private:
+    double h(double x) const
+    {
+        return std::exp(-exponent_ * std::log(x));
+    }
+
+    // The integral of h, shifted so that it is continuous in exponent at 1.
+    double big_h(double x) const
+    {
+        const double log_x = std::log(x);
+        return exponent_ == 1.0 ? log_x : std::expm1((1.0 - exponent_) * log_x) / (1.0 - exponent_);
+    }
+
+    double big_h_inverse(double y) const
+    {
+        return exponent_ == 1.0 ? std::exp(y) : std::exp(std::log1p((1.0 - exponent_) * y) / (1.0 - exponent_));
+    }
+
+    double n_;
+    double exponent_;
+    double h_x1_;
+    double h_n_;
+    double s_;
+};
+
+// Positions in [0, n) for one thread. Zipf ranks are scattered over the positions by a
+// multiplicative hash, so the hottest keys are not neighbours and an MRU hint or finger
+// search cannot lean on that. Sequential walks from a per-thread start, so threads do not
+// walk in lockstep.
+class KeyGenerator
+{
+public:
+    KeyGenerator(KeyDistribution distribution, std::uint64_t n, double zipf_exponent, unsigned thread)
+        : distribution_(distribution),
+          n_(n),
+          engine_(0x5EED + thread),
+          uniform_(0, n - 1),
+          zipf_(n, zipf_exponent),
+          next_(n * thread / 64 % n)
+    {
+    }
+
+    std::uint64_t operator()()
+    {
+        switch (distribution_)
+        {
+            case KeyDistribution::Uniform:
+                return uniform_(engine_);
+            case KeyDistribution::Zipf:
+                return (zipf_(engine_) * 0x9E3779B97F4A7C15ull) % n_;
+            case KeyDistribution::Sequential:
+                break;
+        }
+        const std::uint64_t position = next_;
+        next_ = next_ + 1 == n_ ? 0 : next_ + 1;
+        return position;
+    }
+
+private:
+    KeyDistribution distribution_;
+    std::uint64_t n_;
+    std::mt19937_64 engine_;
+    std::uniform_int_distribution<std::uint64_t> uniform_;
+    ZipfDistribution zipf_;
+    std::uint64_t next_;
+};
+
+}  // namespace iterator_mutex
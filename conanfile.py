@@ -13,3 +13,4 @@ class Recipe(ConanFile):
 
     def build_requirements(self):
         self.test_requires("gtest/1.14.0")
+        self.test_requires("benchmark/1.8.3")
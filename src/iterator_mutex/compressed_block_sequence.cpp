@@ -0,0 +1,222 @@
+#include "compressed_block_sequence.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "parallel_sort.hpp"
+#include "search_kernels.hpp"
+
+namespace iterator_mutex
+{
+
+namespace
+{
+
+// Blocks encoded per parallel_for index when building on a pool.
+constexpr size_t kBlocksPerTask = 1024;
+
+}  // namespace
+
+template <typename T, typename LockPolicy>
+BasicCompressedBlockSequence<T, LockPolicy>::BasicCompressedBlockSequence(const std::vector<T>& values,
+                                                                          CompressedSequenceOptions options)
+    : BasicCompressedBlockSequence(std::vector<T>(values), options)
+{
+}
+
+template <typename T, typename LockPolicy>
+BasicCompressedBlockSequence<T, LockPolicy>::BasicCompressedBlockSequence(std::vector<T>&& values,
+                                                                          CompressedSequenceOptions options)
+{
+    parallel_sort(values, std::less<T>(), options.build_pool);
+    encode(values, options.build_pool);
+}
+
+template <typename T, typename LockPolicy>
+BasicCompressedBlockSequence<T, LockPolicy>::BasicCompressedBlockSequence(assume_sorted_t,
+                                                                          std::span<const T> sorted_keys,
+                                                                          CompressedSequenceOptions options)
+{
+#ifndef NDEBUG
+    if (!std::is_sorted(sorted_keys.begin(), sorted_keys.end()))
+    {
+        throw std::invalid_argument("CompressedBlockSequence: keys passed as sorted are not sorted");
+    }
+#endif
+    encode(sorted_keys, options.build_pool);
+}
+
+// Custom Move Constructor
+template <typename T, typename LockPolicy>
+BasicCompressedBlockSequence<T, LockPolicy>::BasicCompressedBlockSequence(
+    BasicCompressedBlockSequence&& other) noexcept
+{
+    std::scoped_lock lock(mutex_, other.mutex_);
+    heads_ = std::move(other.heads_);
+    blocks_ = std::move(other.blocks_);
+    words_ = std::move(other.words_);
+    size_ = std::exchange(other.size_, 0);
+}
+
+// Custom Move Assignment Operator
+template <typename T, typename LockPolicy>
+BasicCompressedBlockSequence<T, LockPolicy>& BasicCompressedBlockSequence<T, LockPolicy>::operator=(
+    BasicCompressedBlockSequence&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    std::scoped_lock lock(mutex_, other.mutex_);
+    heads_ = std::move(other.heads_);
+    blocks_ = std::move(other.blocks_);
+    words_ = std::move(other.words_);
+    size_ = std::exchange(other.size_, 0);
+    return *this;
+}
+
+template <typename T, typename LockPolicy>
+void BasicCompressedBlockSequence<T, LockPolicy>::encode(std::span<const T> sorted_keys, ThreadPool* pool)
+{
+    size_ = sorted_keys.size();
+    const size_t block_count = (size_ + kBlockSize - 1) / kBlockSize;
+    heads_.resize(block_count);
+    blocks_.resize(block_count);
+
+    // 1. Heads and widths. Keys are sorted, so the largest offset in a block is its last key's.
+    std::uint64_t total_words = 0;
+    for (size_t block = 0; block < block_count; ++block)
+    {
+        const size_t first = block * kBlockSize;
+        const size_t count = std::min(kBlockSize, size_ - first);
+        const T head = sorted_keys[first];
+        const auto span = static_cast<Offset>(static_cast<Offset>(sorted_keys[first + count - 1]) -
+                                              static_cast<Offset>(head));
+
+        heads_[block] = head;
+        BlockInfo& info = blocks_[block];
+        info.first_word = total_words;
+        info.width = static_cast<std::uint32_t>(std::bit_width(span));
+        info.count = static_cast<std::uint32_t>(count);
+        total_words += (count * info.width + 63) / 64;
+    }
+    words_.assign(total_words + 2, 0);
+
+    // 2. Pack. Every block owns whole words, so blocks can be packed independently.
+    parallel_for(pool, (block_count + kBlocksPerTask - 1) / kBlocksPerTask,
+                 [&](size_t task)
+                 {
+                     const size_t end = std::min(block_count, (task + 1) * kBlocksPerTask);
+                     for (size_t block = task * kBlocksPerTask; block < end; ++block)
+                     {
+                         const BlockInfo& info = blocks_[block];
+                         if (info.width == 0)
+                         {
+                             continue;
+                         }
+                         std::uint64_t* words = words_.data() + info.first_word;
+                         const T* keys = sorted_keys.data() + block * kBlockSize;
+                         for (size_t i = 0; i < info.count; ++i)
+                         {
+                             const auto offset = static_cast<std::uint64_t>(
+                                 static_cast<Offset>(static_cast<Offset>(keys[i]) - static_cast<Offset>(keys[0])));
+                             const size_t bit = i * info.width;
+                             const size_t shift = bit % 64;
+                             words[bit / 64] |= offset << shift;
+                             if (shift + info.width > 64)
+                             {
+                                 words[bit / 64 + 1] |= offset >> (64 - shift);
+                             }
+                         }
+                     }
+                 });
+}
+
+template <typename T, typename LockPolicy>
+void BasicCompressedBlockSequence<T, LockPolicy>::decode_block(size_t block, Offset* out) const
+{
+    const BlockInfo& info = blocks_[block];
+    const std::uint64_t* words = words_.data() + info.first_word;
+    const unsigned width = info.width;
+    const std::uint64_t mask = width == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << width) - 1;
+
+    // Branch-free: the bits from the next word are shifted in unconditionally (in two steps,
+    // so a shift of 0 never becomes a shift by 64) and the mask drops them when unused.
+    for (size_t i = 0; i < info.count; ++i)
+    {
+        const size_t bit = i * width;
+        const unsigned shift = bit % 64;
+        const std::uint64_t low = words[bit / 64] >> shift;
+        const std::uint64_t high = (words[bit / 64 + 1] << 1) << (63 - shift);
+        out[i] = static_cast<Offset>((low | high) & mask);
+    }
+}
+
+template <typename T, typename LockPolicy>
+std::optional<T> BasicCompressedBlockSequence<T, LockPolicy>::get_value(T value) const
+{
+    std::shared_lock<LockPolicy> lock(mutex_);
+
+    // 1. Find the block: the last one whose head is not greater than value.
+    const size_t next = search_lower_bound(heads_.data(), heads_.size(), value);
+    if (next < heads_.size() && heads_[next] == value)
+    {
+        return value;
+    }
+    if (next == 0)
+    {
+        return std::nullopt;
+    }
+    const size_t block = next - 1;
+
+    // 2. Decode it and look for the offset value would have.
+    std::array<Offset, kBlockSize> offsets;
+    decode_block(block, offsets.data());
+    const size_t count = blocks_[block].count;
+    const auto target = static_cast<Offset>(static_cast<Offset>(value) - static_cast<Offset>(heads_[block]));
+    const size_t position = count_less(offsets.data(), count, target);
+
+    // 3. Check if we found the exact value.
+    if (position < count && offsets[position] == target)
+    {
+        return value;
+    }
+    return std::nullopt;
+}
+
+template <typename T, typename LockPolicy>
+size_t BasicCompressedBlockSequence<T, LockPolicy>::get_total_size() const
+{
+    return size_;
+}
+
+template <typename T, typename LockPolicy>
+size_t BasicCompressedBlockSequence<T, LockPolicy>::get_memory_usage() const
+{
+    std::shared_lock<LockPolicy> lock(mutex_);
+    return heads_.capacity() * sizeof(T) + blocks_.capacity() * sizeof(BlockInfo) +
+           words_.capacity() * sizeof(std::uint64_t);
+}
+
+template class BasicCompressedBlockSequence<int, NullMutex>;
+template class BasicCompressedBlockSequence<int, ExclusiveMutex>;
+template class BasicCompressedBlockSequence<int, std::shared_mutex>;
+template class BasicCompressedBlockSequence<int, EpochMutex>;
+
+template class BasicCompressedBlockSequence<std::int64_t, NullMutex>;
+template class BasicCompressedBlockSequence<std::int64_t, ExclusiveMutex>;
+template class BasicCompressedBlockSequence<std::int64_t, std::shared_mutex>;
+template class BasicCompressedBlockSequence<std::int64_t, EpochMutex>;
+
+template class BasicCompressedBlockSequence<std::uint64_t, NullMutex>;
+template class BasicCompressedBlockSequence<std::uint64_t, ExclusiveMutex>;
+template class BasicCompressedBlockSequence<std::uint64_t, std::shared_mutex>;
+template class BasicCompressedBlockSequence<std::uint64_t, EpochMutex>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+#include "search_layouts.hpp"
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+struct CompressedSequenceOptions
+{
+    // Sorts and encodes on these threads; only used while the constructor runs.
+    ThreadPool* build_pool = nullptr;
+};
+
+// A sorted sequence of integer keys stored frame-of-reference encoded: the keys are cut into
+// fixed blocks of kBlockSize, and every key is stored as its distance from the first key of
+// its block, bit-packed at the smallest width that fits the block. Dense monotonic keys need
+// a few bits each instead of sizeof(T) bytes.
+//
+// The first keys of all blocks are kept uncompressed and cache-aligned in a skip array. A
+// lookup binary-searches that array with the vector search kernels, decodes the one block
+// that can hold the key, and finds the key's offset with another count_less pass. Lookups
+// and get_total_size behave exactly as in BasicDataBlockSequence; there is no MRU hint,
+// since decoding a block costs about as much as checking a hint would save.
+//
+// Readers take LockPolicy in shared mode and moves take it exclusively, as in
+// BasicDataBlockSequence. Instantiated for int, std::int64_t and std::uint64_t under every
+// lock policy.
+template <typename T, typename LockPolicy = std::shared_mutex>
+class BasicCompressedBlockSequence
+{
+    static_assert(std::is_integral_v<T>, "frame-of-reference encoding needs integer keys");
+
+public:
+    using value_type = T;
+
+    static constexpr size_t kBlockSize = 128;
+
+    explicit BasicCompressedBlockSequence(const std::vector<T>& values, CompressedSequenceOptions options = {});
+    // Sorts values in place before encoding it, so no copy of the input is made.
+    explicit BasicCompressedBlockSequence(std::vector<T>&& values, CompressedSequenceOptions options = {});
+    // Encodes keys sorted in ascending order. Builds without NDEBUG check the order and throw
+    // std::invalid_argument if it does not hold.
+    BasicCompressedBlockSequence(assume_sorted_t, std::span<const T> sorted_keys,
+                                 CompressedSequenceOptions options = {});
+
+    BasicCompressedBlockSequence(const BasicCompressedBlockSequence&) = delete;
+    BasicCompressedBlockSequence& operator=(const BasicCompressedBlockSequence&) = delete;
+    BasicCompressedBlockSequence(BasicCompressedBlockSequence&& other) noexcept;
+    BasicCompressedBlockSequence& operator=(BasicCompressedBlockSequence&& other) noexcept;
+
+    std::optional<T> get_value(T value) const;
+
+    size_t get_total_size() const;
+
+    // Bytes held by the encoded keys, the skip array and the block descriptors.
+    size_t get_memory_usage() const;
+
+private:
+    // Offsets from the block head, in an unsigned type so the distance between any two keys fits.
+    using Offset = std::make_unsigned_t<T>;
+
+    struct BlockInfo
+    {
+        std::uint64_t first_word = 0;  // Into words_.
+        std::uint32_t width = 0;       // Bits per offset, 0 if every key equals the head.
+        std::uint32_t count = 0;       // Keys in the block; only the last one can be short.
+    };
+
+    // Unpacks the offsets of block into out[0, count).
+    void decode_block(size_t block, Offset* out) const;
+
+    // Encodes sorted keys into heads_, blocks_ and words_.
+    void encode(std::span<const T> sorted_keys, ThreadPool* pool);
+
+    // First key of every block, searched with the vector kernels.
+    std::vector<T, CacheAlignedAllocator<T>> heads_;
+    std::vector<BlockInfo> blocks_;
+    // Bit-packed offsets of all blocks, each block starting on a word boundary. Two zero words
+    // at the end let the decoder read one word past any offset without a bounds check.
+    std::vector<std::uint64_t> words_;
+    size_t size_ = 0;
+    mutable LockPolicy mutex_;
+};
+
+extern template class BasicCompressedBlockSequence<int, NullMutex>;
+extern template class BasicCompressedBlockSequence<int, ExclusiveMutex>;
+extern template class BasicCompressedBlockSequence<int, std::shared_mutex>;
+extern template class BasicCompressedBlockSequence<int, EpochMutex>;
+
+extern template class BasicCompressedBlockSequence<std::int64_t, NullMutex>;
+extern template class BasicCompressedBlockSequence<std::int64_t, ExclusiveMutex>;
+extern template class BasicCompressedBlockSequence<std::int64_t, std::shared_mutex>;
+extern template class BasicCompressedBlockSequence<std::int64_t, EpochMutex>;
+
+extern template class BasicCompressedBlockSequence<std::uint64_t, NullMutex>;
+extern template class BasicCompressedBlockSequence<std::uint64_t, ExclusiveMutex>;
+extern template class BasicCompressedBlockSequence<std::uint64_t, std::shared_mutex>;
+extern template class BasicCompressedBlockSequence<std::uint64_t, EpochMutex>;
+
+using CompressedBlockSequence = BasicCompressedBlockSequence<int>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,51 @@
+#include "epoch_domain.hpp"
+
+#include <thread>
+
+#include "thread_slot.hpp"
+
+namespace iterator_mutex
+{
+
+EpochDomain::ReadGuard::ReadGuard(EpochDomain& domain)
+{
+    // The phase only steers new readers away from the counter synchronize() is draining.
+    // Correctness does not depend on seeing the latest phase.
+    const unsigned phase = domain.phase_.load(std::memory_order_relaxed) & 1u;
+    counter_ = &domain.readers_[this_thread_slot() % kReaderSlots].active[phase];
+    // seq_cst orders the increment before the caller's seq_cst load of the shared pointer,
+    // which is what synchronize() relies on.
+    counter_->fetch_add(1, std::memory_order_seq_cst);
+}
+
+EpochDomain::ReadGuard::~ReadGuard()
+{
+    counter_->fetch_sub(1, std::memory_order_release);
+}
+
+void EpochDomain::wait_for_phase(unsigned phase)
+{
+    for (auto& slot : readers_)
+    {
+        while (slot.active[phase].load(std::memory_order_seq_cst) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void EpochDomain::synchronize()
+{
+    std::lock_guard<std::mutex> lock(synchronize_mutex_);
+
+    // Flip the phase so new readers use the other counter, and wait for the old one to
+    // drain. Doing it twice covers readers that entered on either counter before the call,
+    // while new readers cannot keep either counter from reaching zero.
+    for (int flip = 0; flip < 2; ++flip)
+    {
+        const unsigned old_phase = phase_.fetch_xor(1u, std::memory_order_seq_cst) & 1u;
+        wait_for_phase(old_phase);
+    }
+}
+
+}  // namespace iterator_mutex
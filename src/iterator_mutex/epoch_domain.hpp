@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace iterator_mutex
+{
+
+// Read-side critical sections for safe memory reclamation, using a two-phase counter scheme
+// in the style of SRCU. A reader enters and leaves with one atomic increment and one
+// decrement on a counter in its own cache line, so read sections are wait-free.
+// synchronize() returns once every read section that was running when it was called has
+// ended. Anything unlinked from shared view before the call can then be freed.
+class EpochDomain
+{
+public:
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(EpochDomain& domain);
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        std::atomic<std::uint64_t>* counter_;
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Blocks the caller, never the readers. Concurrent callers are serialized.
+    void synchronize();
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kReaderSlots = 64;
+
+    struct alignas(kCacheLineSize) ReaderSlot
+    {
+        std::array<std::atomic<std::uint64_t>, 2> active{};
+    };
+
+    void wait_for_phase(unsigned phase);
+
+    std::array<ReaderSlot, kReaderSlots> readers_;
+    alignas(kCacheLineSize) std::atomic<unsigned> phase_{0};
+    std::mutex synchronize_mutex_;
+};
+
+}  // namespace iterator_mutex
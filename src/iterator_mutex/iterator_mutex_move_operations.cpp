@@ -1,39 +1,375 @@
 #include "iterator_mutex_move_operations.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "epoch_domain.hpp"
+#include "parallel_sort.hpp"
+#include "sequence_file.hpp"
+#include "set_operations.hpp"
 
 namespace iterator_mutex
 {
 
-DataBlockSequence::DataBlockSequence(const std::vector<int>& values) : blocks_(values)
+namespace
+{
+
+// A per-thread MRU hint: the position of the last value this thread found in one sequence.
+struct MruSlot
+{
+    std::uint64_t instance_id = 0;  // 0 never belongs to a sequence, so fresh slots never match.
+    size_t index = 0;
+};
+
+// Each thread keeps a small direct-mapped table of hints keyed by sequence instance id.
+// Consecutive ids land in different slots, so a thread can work with several sequences
+// before they start evicting each other.
+constexpr size_t kMruSlotsPerThread = 16;
+thread_local std::array<MruSlot, kMruSlotsPerThread> t_mru_slots;
+
+std::atomic<std::uint64_t> g_next_instance_id{1};
+
+std::uint64_t nanoseconds_between(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+std::uint64_t nanoseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return nanoseconds_between(start, std::chrono::steady_clock::now());
+}
+
+// Whether moves and contended shared locks read the clock: for the stats or the trace events.
+constexpr bool kTimeLocks = kStatsEnabled || kTracingEnabled;
+
+// Times a move for the stats and the trace events: how long it waits for both locks and how
+// long it then holds them. Construct it before taking the locks so it is destroyed after they
+// are released.
+template <typename Recorder>
+class MoveTimer
+{
+public:
+    MoveTimer(const Recorder& stats, const void* sequence) : stats_(stats), sequence_(sequence)
+    {
+        if constexpr (kTimeLocks)
+        {
+            trace(TraceEvent::MoveBegin, sequence_);
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    MoveTimer(const MoveTimer&) = delete;
+    MoveTimer& operator=(const MoveTimer&) = delete;
+
+    ~MoveTimer()
+    {
+        if constexpr (kTimeLocks)
+        {
+            const std::uint64_t held = nanoseconds_since(acquired_);
+            stats_.add(StatCounter::Moves);
+            stats_.record(StatHistogram::MoveHold, held);
+            trace(TraceEvent::MoveEnd, sequence_, held);
+        }
+    }
+
+    void acquired()
+    {
+        if constexpr (kTimeLocks)
+        {
+            acquired_ = std::chrono::steady_clock::now();
+            const std::uint64_t waited = nanoseconds_between(start_, acquired_);
+            stats_.record(StatHistogram::ExclusiveLockWait, waited);
+            trace(TraceEvent::MoveLocked, sequence_, waited);
+        }
+    }
+
+private:
+    const Recorder& stats_;
+    const void* sequence_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point acquired_;
+};
+
+std::uint64_t next_instance_id()
+{
+    return g_next_instance_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+MruSlot& mru_slot_for(std::uint64_t instance_id)
+{
+    return t_mru_slots[instance_id % kMruSlotsPerThread];
+}
+
+// Read sections of key filter probes, for every sequence. One domain for all of them, since a
+// filter moves between sequences along with their keys, and a probe is too short for the
+// sharing to hold anyone up.
+EpochDomain& filter_domain()
+{
+    static EpochDomain domain;
+    return domain;
+}
+
+// Frees a filter once no probe can still be reading it.
+void retire_filter(const BlockedBloomFilter* filter)
+{
+    if (filter != nullptr)
+    {
+        filter_domain().synchronize();
+        delete filter;
+    }
+}
+
+// Holds a filter a move has unlinked until the end of the move. Construct it before taking
+// the locks, so readers are not kept waiting while it waits for the probes.
+class RetiredFilter
+{
+public:
+    RetiredFilter() = default;
+    RetiredFilter(const RetiredFilter&) = delete;
+    RetiredFilter& operator=(const RetiredFilter&) = delete;
+
+    ~RetiredFilter()
+    {
+        retire_filter(filter_);
+    }
+
+    void retire(const BlockedBloomFilter* filter)
+    {
+        filter_ = filter;
+    }
+
+private:
+    const BlockedBloomFilter* filter_ = nullptr;
+};
+
+// Returns the first position in [first, last) not less than value, searching forward from
+// first with doubling steps. Costs O(log d) for a result d positions away, so a sorted batch
+// of keys is answered in one pass over the blocks.
+template <typename Iterator, typename T, typename Compare>
+Iterator gallop_lower_bound(Iterator first, Iterator last, const T& value, const Compare& comp)
 {
-    std::sort(blocks_.begin(), blocks_.end());
-    if (!blocks_.empty())
+    size_t step = 1;
+    auto low = first;
+    while (static_cast<size_t>(last - low) > step && comp(low[step], value))
     {
-        mru_block_iterator_ = blocks_.cbegin();
+        low += step;
+        step *= 2;
     }
+    const auto high = static_cast<size_t>(last - low) > step ? low + step + 1 : last;
+    const size_t offset = search_lower_bound(std::to_address(low), static_cast<size_t>(high - low), value, comp);
+    return low + static_cast<std::ptrdiff_t>(offset);
+}
+
+// An empty hot-key cache entry: unreferenced, with a position past the end of any sequence.
+constexpr std::uint64_t kEmptyHotKey = ~std::uint64_t{1};
+
+std::uint64_t mix_bits(std::uint64_t x)
+{
+    // The MurmurHash3 finalizer, so keys that differ in their low bits spread over all sets.
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Keys with a hash the hot-key cache and the key filter can use.
+template <typename T>
+inline constexpr bool has_key_hash_v = std::is_integral_v<T> || std::has_unique_object_representations_v<T>;
+
+template <typename T>
+std::uint64_t key_hash(const T& key)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        return mix_bits(static_cast<std::uint64_t>(key));
+    }
+    else if constexpr (std::has_unique_object_representations_v<T>)
+    {
+        std::uint64_t hash = 0;
+        for (size_t offset = 0; offset < sizeof(T); offset += sizeof(std::uint64_t))
+        {
+            std::uint64_t word = 0;
+            std::memcpy(&word, reinterpret_cast<const char*>(&key) + offset,
+                        std::min(sizeof(word), sizeof(T) - offset));
+            hash = mix_bits(hash ^ word);
+        }
+        return hash;
+    }
+    else
+    {
+        return 0;  // No byte hash to trust; every key shares one set, which is slow but correct.
+    }
+}
+
+}  // namespace
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(
+    const std::vector<T, Allocator>& values, SequenceOptions options, const Compare& comp)
+    : BasicDataBlockSequence(std::vector<T, Allocator>(values), options, comp)
+{
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(std::vector<T, Allocator>&& values,
+                                                                                  SequenceOptions options,
+                                                                                  const Compare& comp)
+    : owned_(std::move(values)),
+      comp_(comp),
+      mru_mode_(options.mru_mode),
+      hint_search_(options.hint_search),
+      hint_stats_(options.hint_stats),
+      instance_id_(next_instance_id())
+{
+    trace(TraceEvent::BuildBegin, this, owned_.size());
+    parallel_sort(owned_, comp_, options.build_pool);
+    trace(TraceEvent::SortEnd, this, owned_.size());
+    adopt(owned_, options);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(
+    assume_sorted_t, const std::vector<T, Allocator>& values, SequenceOptions options, const Compare& comp)
+    : BasicDataBlockSequence(assume_sorted, std::vector<T, Allocator>(values), options, comp)
+{
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(assume_sorted_t,
+                                                                                  std::vector<T, Allocator>&& values,
+                                                                                  SequenceOptions options,
+                                                                                  const Compare& comp)
+    : owned_(std::move(values)),
+      comp_(comp),
+      mru_mode_(options.mru_mode),
+      hint_search_(options.hint_search),
+      hint_stats_(options.hint_stats),
+      instance_id_(next_instance_id())
+{
+    trace(TraceEvent::BuildBegin, this, owned_.size());
+    adopt(owned_, options);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(assume_sorted_t,
+                                                                                  std::span<const T> sorted_keys,
+                                                                                  SequenceOptions options,
+                                                                                  const Compare& comp)
+    : comp_(comp),
+      mru_mode_(options.mru_mode),
+      hint_search_(options.hint_search),
+      hint_stats_(options.hint_stats),
+      instance_id_(next_instance_id())
+{
+    trace(TraceEvent::BuildBegin, this, sorted_keys.size());
+    adopt(sorted_keys, options);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::adopt(std::span<const T> sorted_keys,
+                                                                      const SequenceOptions& options)
+{
+#ifndef NDEBUG
+    // Every search relies on the order, so catch a wrong assume_sorted before it turns into
+    // silently missed keys. Release builds trust the caller and skip the extra pass.
+    if (!std::is_sorted(sorted_keys.begin(), sorted_keys.end(), comp_))
+    {
+        throw std::invalid_argument("DataBlockSequence: keys passed as sorted are not sorted");
+    }
+#endif
+    blocks_ = sorted_keys;
+    index_ = BlockIndex<T, Compare>(options.layout, blocks_, comp_, options.build_pool, options.learned_epsilon);
+
+    if (options.hot_keys > 0)
+    {
+        const size_t sets = std::bit_ceil(std::max(options.hot_keys, kHotKeyWays)) / kHotKeyWays;
+        hot_keys_ = std::make_unique<HotKeySet[]>(sets);
+        hot_key_set_mask_ = sets - 1;
+        clear_hot_keys();
+    }
+
+    if constexpr (has_key_hash_v<T>)
+    {
+        if (options.filter_bits_per_key > 0)
+        {
+            auto filter = std::make_unique<BlockedBloomFilter>(blocks_.size(), options.filter_bits_per_key);
+            for (const T& key : blocks_)
+            {
+                filter->insert(key_hash(key));
+            }
+            filter_.store(filter.release(), std::memory_order_release);
+        }
+    }
+    trace(TraceEvent::BuildEnd, this, blocks_.size());
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::~BasicDataBlockSequence()
+{
+    // Readers of this sequence are gone, but a probe of the sequence it was moved from may
+    // still be reading the filter it took over.
+    retire_filter(filter_.load(std::memory_order_relaxed));
 }
 
 // Custom Move Constructor
-DataBlockSequence::DataBlockSequence(DataBlockSequence&& other) noexcept
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::BasicDataBlockSequence(
+    BasicDataBlockSequence&& other) noexcept
 {
-    // Lock both mutexes to prevent deadlock and ensure safe transfer.
-    // std::scoped_lock is preferred for locking multiple mutexes.
-    std::scoped_lock lock(mru_mutex_, other.mru_mutex_);
+    // No one else can see this object until the constructor returns, so only other's readers
+    // need to be kept out. Nothing of other is read before its lock is held: a swap or move
+    // assignment running on other writes its comparator and its vector under that lock.
+    MoveTimer timer(stats_, this);
+    const std::unique_lock lock(other.mru_mutex_);
+    timer.acquired();
 
-    // 1. Move the vector.
-    blocks_ = std::move(other.blocks_);
+    // 1. Take over the vector, allocator included, which only its construction can set; the
+    //    default-constructed one owns nothing. The view of a moved vector still points at its
+    //    buffer.
+    std::destroy_at(&owned_);
+    std::construct_at(&owned_, std::move(other.owned_));
+    comp_ = other.comp_;
+    mru_mode_ = other.mru_mode_;
+    hint_search_ = other.hint_search_;
+    hint_stats_ = other.hint_stats_;
 
-    // 2. The iterator from 'other' is now invalid. Initialize our iterator.
-    mru_block_iterator_ = blocks_.cbegin();
+    // 2. Move the index and what else belongs to the keys.
+    mapping_ = std::move(other.mapping_);
+    blocks_ = std::exchange(other.blocks_, {});
+    index_ = std::move(other.index_);
+    other.index_ = BlockIndex<T, Compare>();
+    hot_keys_ = std::move(other.hot_keys_);
+    hot_key_set_mask_ = std::exchange(other.hot_key_set_mask_, 0);
+    // Whoever gets to see this object synchronizes with the end of the constructor.
+    filter_.store(other.filter_.exchange(nullptr), std::memory_order_relaxed);
 
-    // 3. Reset the moved-from object to a valid, empty state.
-    other.mru_block_iterator_ = other.blocks_.cbegin();
+    // 3. The hints from 'other' refer to its old contents. Point ours at the beginning.
+    clear_hot_keys();
+    mru_block_index_.store(0, std::memory_order_relaxed);
+
+    // 4. Reset the moved-from object to a valid, empty state.
+    other.mru_block_index_.store(0, std::memory_order_relaxed);
+
+    // 5. Both objects now hold different contents, so per-thread hints must not match either.
+    instance_id_.store(next_instance_id(), std::memory_order_relaxed);
+    other.instance_id_.store(next_instance_id(), std::memory_order_relaxed);
 }
 
 // Custom Move Assignment Operator
-DataBlockSequence& DataBlockSequence::operator=(DataBlockSequence&& other) noexcept
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::operator=(BasicDataBlockSequence&& other) noexcept
+    -> BasicDataBlockSequence&
 {
     // Protect against self-assignment
     if (this == &other)
@@ -42,46 +378,1057 @@ DataBlockSequence& DataBlockSequence::operator=(DataBlockSequence&& other) noexc
     }
 
     // Lock both mutexes to prevent deadlock and ensure safe transfer.
+    RetiredFilter retired;
+    MoveTimer timer(stats_, this);
     std::scoped_lock lock(mru_mutex_, other.mru_mutex_);
+    timer.acquired();
 
-    // 1. Move the vector's contents.
-    blocks_ = std::move(other.blocks_);
+    // 1. Move the vector's contents, its ordering and its index. An allocator that does not
+    //    propagate on move, such as std::pmr's, moves the keys element by element into our
+    //    memory when the two differ, so blocks_ is pointed at owned_ instead of taken over,
+    //    and the buffer other is left with goes back to its allocator.
+    const bool owns_keys = !other.owned_.empty();
+    owned_ = std::move(other.owned_);
+    other.owned_ = std::vector<T, Allocator>(other.owned_.get_allocator());
+    mapping_ = std::move(other.mapping_);
+    blocks_ = owns_keys ? std::span<const T>(owned_) : other.blocks_;
+    other.blocks_ = {};
+    comp_ = other.comp_;
+    index_ = std::move(other.index_);
+    other.index_ = BlockIndex<T, Compare>();
+    // Probes may still be reading our old filter; it is freed once the locks are released.
+    retired.retire(filter_.exchange(other.filter_.exchange(nullptr)));
 
-    // 2. Re-initialize our iterator to be valid for the new data.
-    mru_block_iterator_ = blocks_.cbegin();
+    // 2. Re-initialize our hints to be valid for the new data.
+    mru_block_index_.store(0, std::memory_order_relaxed);
+    clear_hot_keys();
 
     // 3. Reset the moved-from object to a valid, empty state.
-    other.mru_block_iterator_ = other.blocks_.cbegin();
+    other.mru_block_index_.store(0, std::memory_order_relaxed);
+    other.clear_hot_keys();
+
+    // 4. Invalidate per-thread hints for both objects.
+    instance_id_.store(next_instance_id(), std::memory_order_relaxed);
+    other.instance_id_.store(next_instance_id(), std::memory_order_relaxed);
 
     return *this;
 }
 
-std::optional<int> DataBlockSequence::get_value(int value) const
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::swap(BasicDataBlockSequence& other) noexcept
+{
+    if (this == &other)
+    {
+        return;
+    }
+
+    MoveTimer timer(stats_, this);
+    std::scoped_lock lock(mru_mutex_, other.mru_mutex_);
+    timer.acquired();
+
+    // 1. Exchange the keys. Vectors only swap buffers if their allocators propagate on swap or
+    //    compare equal; otherwise each side's keys are moved into the other's memory. Either
+    //    way a sequence that owned its keys points blocks_ at where they now are.
+    const bool owns_keys = !owned_.empty();
+    const bool other_owns_keys = !other.owned_.empty();
+    if (std::allocator_traits<Allocator>::propagate_on_container_swap::value ||
+        owned_.get_allocator() == other.owned_.get_allocator())
+    {
+        owned_.swap(other.owned_);
+    }
+    else
+    {
+        std::vector<T, Allocator> theirs(std::move(owned_), other.owned_.get_allocator());
+        owned_ = std::move(other.owned_);
+        other.owned_ = std::move(theirs);
+    }
+    std::swap(blocks_, other.blocks_);
+    if (other_owns_keys)
+    {
+        blocks_ = owned_;
+    }
+    if (owns_keys)
+    {
+        other.blocks_ = other.owned_;
+    }
+
+    // 2. Exchange what belongs to the keys. Probes of either sequence that still read the
+    //    filter it had are safe: both filters stay alive.
+    using std::swap;
+    swap(comp_, other.comp_);
+    mapping_.swap(other.mapping_);
+    swap(index_, other.index_);
+    filter_.store(other.filter_.exchange(filter_.load()));
+
+    // 3. The hints of both refer to the old contents.
+    mru_block_index_.store(0, std::memory_order_relaxed);
+    other.mru_block_index_.store(0, std::memory_order_relaxed);
+    clear_hot_keys();
+    other.clear_hot_keys();
+    instance_id_.store(next_instance_id(), std::memory_order_relaxed);
+    other.instance_id_.store(next_instance_id(), std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_value(const T& value) const
 {
-    std::lock_guard<std::mutex> lock(mru_mutex_);
+    if (filter_rejects(value, StatCounter::Lookups))
+    {
+        return std::nullopt;
+    }
 
+    // Readers never modify blocks_ and both kinds of hint tolerate concurrent updates, so
+    // readers share the lock. It keeps a concurrent move from pulling blocks_ out from
+    // under them.
+    const auto lock = lock_shared();
+    return get_value_locked(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_value_locked(const T& value) const
+{
+    std::optional<T> result =
+        mru_mode_ == MruMode::PerThread ? get_value_per_thread_mru(value) : get_value_shared_mru(value);
+    stats_.add(StatCounter::Lookups);
+    stats_.add(StatCounter::LookupHits, result.has_value());
+    return result;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_value_shared_mru(const T& value) const
+{
     // 1. Check the MRU cache first.
-    if (mru_block_iterator_ != blocks_.cend() && *mru_block_iterator_ == value)
+    const size_t mru = mru_block_index_.load(std::memory_order_relaxed);
+    if (mru < blocks_.size() && equivalent(blocks_[mru], value))
+    {
+        count_hint(HintOutcome::ExactHit);
+        return blocks_[mru];
+    }
+
+    if (const auto hot = probe_hot_keys(value))
     {
-        return *mru_block_iterator_;
+        count_hint(HintOutcome::HotKeyHit);
+        return blocks_[*hot];
     }
 
-    // 2. If not in cache, perform a binary search.
-    auto it = std::lower_bound(blocks_.cbegin(), blocks_.cend(), value);
+    // 2. If not in cache, search from the hint or with the configured layout.
+    auto it = blocks_.begin() + static_cast<std::ptrdiff_t>(search_from_hint(mru, value));
 
     // 3. Check if we found the exact value.
-    if (it != blocks_.cend() && *it == value)
+    if (it != blocks_.end() && !comp_(value, *it))
     {
-        mru_block_iterator_ = it;  // Update cache
+        const auto position = static_cast<size_t>(it - blocks_.begin());
+        mru_block_index_.store(position, std::memory_order_relaxed);
+        remember_hot_key(value, position);
         return *it;
     }
     // 4. Value not found.
     return std::nullopt;
 }
 
-size_t DataBlockSequence::get_total_size() const
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_value_per_thread_mru(
+    const T& value) const
+{
+    // 1. Check this thread's MRU hint first. The slot only matches while our contents are
+    //    unchanged, so its index is always in range.
+    const std::uint64_t instance_id = instance_id_.load(std::memory_order_relaxed);
+    MruSlot& slot = mru_slot_for(instance_id);
+    const bool have_hint = slot.instance_id == instance_id;
+    if (have_hint && equivalent(blocks_[slot.index], value))
+    {
+        count_hint(HintOutcome::ExactHit);
+        return blocks_[slot.index];
+    }
+
+    if (const auto hot = probe_hot_keys(value))
+    {
+        count_hint(HintOutcome::HotKeyHit);
+        return blocks_[*hot];
+    }
+
+    // 2. If not in cache, search from the hint or with the configured layout.
+    const size_t hint = have_hint ? slot.index : blocks_.size();
+    auto it = blocks_.begin() + static_cast<std::ptrdiff_t>(search_from_hint(hint, value));
+
+    // 3. Check if we found the exact value.
+    if (it != blocks_.end() && !comp_(value, *it))
+    {
+        slot.instance_id = instance_id;
+        slot.index = static_cast<size_t>(it - blocks_.begin());
+        remember_hot_key(value, slot.index);
+        return *it;
+    }
+    // 4. Value not found.
+    return std::nullopt;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_values(std::span<const T> keys,
+                                                                             std::span<std::optional<T>> results) const
+{
+    clear_batch_output(keys, results);
+    const auto lock = lock_shared();
+    return get_values_locked(keys, results);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::clear_batch_output(std::span<const T> keys,
+                                                                                  std::span<std::optional<T>> results)
+{
+    if (results.size() < keys.size())
+    {
+        throw std::invalid_argument("get_values: results is smaller than keys");
+    }
+    std::fill_n(results.begin(), keys.size(), std::nullopt);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_values_locked(
+    std::span<const T> keys, std::span<std::optional<T>> results) const
+{
+    const size_t hits = lookup_batch(keys, [&](size_t i) { results[i] = keys[i]; });
+    stats_.add(StatCounter::BatchLookups);
+    stats_.add(StatCounter::BatchKeys, keys.size());
+    stats_.add(StatCounter::BatchHits, hits);
+    return hits;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_values(std::span<const T> keys,
+                                                                             std::span<std::uint64_t> found) const
+{
+    clear_batch_output(keys, found);
+    const auto lock = lock_shared();
+    return get_values_locked(keys, found);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::clear_batch_output(std::span<const T> keys,
+                                                                                  std::span<std::uint64_t> found)
+{
+    const size_t words = (keys.size() + 63) / 64;
+    if (found.size() < words)
+    {
+        throw std::invalid_argument("get_values: found bitmap is smaller than keys");
+    }
+    std::fill_n(found.begin(), words, 0);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_values_locked(
+    std::span<const T> keys, std::span<std::uint64_t> found) const
+{
+    const size_t hits = lookup_batch(keys, [&](size_t i) { found[i / 64] |= std::uint64_t{1} << (i % 64); });
+    stats_.add(StatCounter::BatchLookups);
+    stats_.add(StatCounter::BatchKeys, keys.size());
+    stats_.add(StatCounter::BatchHits, hits);
+    return hits;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+template <typename OnFound>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::lookup_batch(std::span<const T> keys,
+                                                                               OnFound&& on_found) const
+{
+    size_t hits = 0;
+
+    if (std::is_sorted(keys.begin(), keys.end(), comp_))
+    {
+        // Merge walk: every key starts where the previous one ended.
+        auto position = blocks_.begin();
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            position = gallop_lower_bound(position, blocks_.end(), keys[i], comp_);
+            if (position == blocks_.end())
+            {
+                break;  // Every remaining key is larger than all blocks.
+            }
+            if (!comp_(keys[i], *position))
+            {
+                on_found(i);
+                ++hits;
+            }
+        }
+        return hits;
+    }
+
+    // Independent searches, interleaved so that their cache misses overlap.
+    index_.lower_bounds(blocks_, keys,
+                        [&](size_t i, size_t position)
+                        {
+                            if (position < blocks_.size() && !comp_(keys[i], blocks_[position]))
+                            {
+                                on_found(i);
+                                ++hits;
+                            }
+                        });
+    return hits;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::find_index(const T& value) const
+{
+    if (filter_rejects(value, StatCounter::PositionQueries))
+    {
+        return std::nullopt;
+    }
+    const auto lock = lock_shared();
+    return find_index_locked(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::find_index_locked(
+    const T& value) const
+{
+    stats_.add(StatCounter::PositionQueries);
+    const size_t position = hinted_lower_bound(value);
+    if (position < blocks_.size() && !comp_(value, blocks_[position]))
+    {
+        return position;
+    }
+    return std::nullopt;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::lower_bound(const T& value) const
+{
+    const auto lock = lock_shared();
+    stats_.add(StatCounter::PositionQueries);
+    return hinted_lower_bound(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::count_range(const T& lo, const T& hi) const
+{
+    const auto lock = lock_shared();
+    const auto [first, last] = range_bounds(lo, hi);
+    return last - first;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::span<const T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_range(const T& lo,
+                                                                                     const T& hi) const
+{
+    const auto lock = lock_shared();
+    const auto [first, last] = range_bounds(lo, hi);
+    return blocks_.subspan(first, last - first);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::hinted_lower_bound(const T& value) const
+{
+    // 1. Fetch the hint of the configured kind. A slot of another sequence gives no hint.
+    const std::uint64_t instance_id = instance_id_.load(std::memory_order_relaxed);
+    MruSlot* slot = nullptr;
+    size_t hint = blocks_.size();
+    if (mru_mode_ == MruMode::PerThread)
+    {
+        slot = &mru_slot_for(instance_id);
+        if (slot->instance_id == instance_id)
+        {
+            hint = slot->index;
+        }
+    }
+    else
+    {
+        hint = mru_block_index_.load(std::memory_order_relaxed);
+    }
+
+    // 2. The hint is the answer if value fits between the key before it and the key at it.
+    //    Unlike get_value this also checks the key before, so duplicates resolve to the first.
+    if (hint < blocks_.size() && !comp_(blocks_[hint], value) && (hint == 0 || comp_(blocks_[hint - 1], value)))
+    {
+        count_hint(HintOutcome::ExactHit);
+        return hint;
+    }
+
+    // 3. Then the hot-key cache, whose entry may be any of several duplicates.
+    if (const auto hot = probe_hot_keys(value); hot && (*hot == 0 || comp_(blocks_[*hot - 1], value)))
+    {
+        count_hint(HintOutcome::HotKeyHit);
+        return *hot;
+    }
+
+    // 4. Otherwise search from the hint or with the configured layout, and remember exact matches.
+    const size_t position = search_from_hint(hint, value);
+    if (position < blocks_.size() && !comp_(value, blocks_[position]))
+    {
+        remember_hot_key(value, position);
+        if (slot != nullptr)
+        {
+            slot->instance_id = instance_id;
+            slot->index = position;
+        }
+        else
+        {
+            mru_block_index_.store(position, std::memory_order_relaxed);
+        }
+    }
+    return position;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::search_from_hint(size_t hint, const T& value) const
+{
+    if (hint_search_ != HintSearch::Exact && !blocks_.empty())
+    {
+        size_t start = hint;
+        if (hint_search_ == HintSearch::Interpolation)
+        {
+            const size_t estimate = interpolate(value);
+            start = estimate < blocks_.size() ? estimate : hint;
+        }
+        if (start < blocks_.size())
+        {
+            if (const auto position = gallop_from(start, value))
+            {
+                count_hint(HintOutcome::NearHit);
+                return *position;
+            }
+        }
+    }
+    count_hint(HintOutcome::Miss);
+    return index_.lower_bound(blocks_, value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::gallop_from(size_t start,
+                                                                                         const T& value) const
+{
+    const T* keys = blocks_.data();
+    const size_t n = blocks_.size();
+
+    if (comp_(keys[start], value))
+    {
+        // 1. Forward: keys[low] < value throughout, until a probe lands on or past value.
+        size_t low = start;
+        for (size_t step = 1; step <= kFingerReach; step *= 2)
+        {
+            const size_t probe = low + step;
+            if (probe >= n || !comp_(keys[probe], value))
+            {
+                stats_.record(StatHistogram::FingerSteps, std::bit_width(step));
+                const size_t high = std::min(probe, n);
+                return low + 1 + search_lower_bound(keys + low + 1, high - low - 1, value, comp_);
+            }
+            low = probe;
+        }
+        stats_.record(StatHistogram::FingerSteps, std::bit_width(kFingerReach));
+        return std::nullopt;
+    }
+
+    // 2. Backward: keys[high] >= value throughout, until a probe lands before value.
+    size_t high = start;
+    for (size_t step = 1; step <= kFingerReach; step *= 2)
+    {
+        if (high < step)
+        {
+            stats_.record(StatHistogram::FingerSteps, std::bit_width(step));
+            return search_lower_bound(keys, high, value, comp_);
+        }
+        const size_t probe = high - step;
+        if (comp_(keys[probe], value))
+        {
+            stats_.record(StatHistogram::FingerSteps, std::bit_width(step));
+            return probe + 1 + search_lower_bound(keys + probe + 1, high - probe - 1, value, comp_);
+        }
+        high = probe;
+    }
+    stats_.record(StatHistogram::FingerSteps, std::bit_width(kFingerReach));
+    return std::nullopt;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::interpolate(const T& value) const
+{
+    if constexpr (std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<T>>)
+    {
+        const T& first = blocks_.front();
+        const T& last = blocks_.back();
+        if (!(first < value))
+        {
+            return 0;
+        }
+        if (!(value < last))
+        {
+            return blocks_.size() - 1;
+        }
+        // Doubles hold the 64-bit keys only approximately, which is fine for a starting point.
+        const double span = static_cast<double>(last) - static_cast<double>(first);
+        const double fraction = (static_cast<double>(value) - static_cast<double>(first)) / span;
+        return std::min(static_cast<size_t>(fraction * static_cast<double>(blocks_.size() - 1)), blocks_.size() - 1);
+    }
+    else
+    {
+        return blocks_.size();  // No estimate; the caller starts from the hint instead.
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+bool BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::filter_rejects(const T& value,
+                                                                           StatCounter query) const
+{
+    if (!rejected_by_filter(value))
+    {
+        return false;
+    }
+    stats_.add(query);
+    stats_.add(StatCounter::FilterRejections);
+    return true;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+bool BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::rejected_by_filter(const T& value) const
+{
+    if constexpr (has_key_hash_v<T>)
+    {
+        // Most sequences have no filter and never will, so they skip the read section. One
+        // that gets a filter by move assignment while this runs need not use it yet.
+        if (filter_.load(std::memory_order_relaxed) == nullptr)
+        {
+            return false;
+        }
+        EpochDomain::ReadGuard guard(filter_domain());
+        // seq_cst pairs with the increment in EpochDomain::ReadGuard, see epoch_domain.hpp.
+        const BlockedBloomFilter* filter = filter_.load(std::memory_order_seq_cst);
+        return filter != nullptr && !filter->may_contain(key_hash(value));
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::count_hint(HintOutcome outcome) const
+{
+    if (hint_stats_)
+    {
+        hint_counters_.counts[static_cast<size_t>(outcome)].fetch_add(1, std::memory_order_relaxed);
+    }
+    stats_.add(static_cast<StatCounter>(static_cast<size_t>(StatCounter::ExactHits) + static_cast<size_t>(outcome)));
+    if (outcome == HintOutcome::Miss)
+    {
+        trace(TraceEvent::HintMiss, this);
+    }
+    else
+    {
+        trace(TraceEvent::HintHit, this, static_cast<std::uint64_t>(outcome));
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::probe_hot_keys(const T& value) const
+{
+    if (!hot_keys_)
+    {
+        return std::nullopt;
+    }
+    HotKeySet& set = hot_keys_[key_hash(value) & hot_key_set_mask_];
+    for (auto& way : set.ways)
+    {
+        const std::uint64_t entry = way.load(std::memory_order_relaxed);
+        const size_t position = static_cast<size_t>(entry >> 1);
+        if (position < blocks_.size() && equivalent(blocks_[position], value))
+        {
+            // Write only if the bit is clear, so a hot entry's line is not dirtied on every hit.
+            if ((entry & 1) == 0)
+            {
+                way.store(entry | 1, std::memory_order_relaxed);
+            }
+            return position;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::remember_hot_key(const T& value,
+                                                                                 size_t position) const
+{
+    if (!hot_keys_)
+    {
+        return;
+    }
+    // An empty way first. Otherwise CLOCK within the set: referenced entries get a second
+    // chance and lose their bit, the first unreferenced one is replaced. A new entry starts
+    // unreferenced, so keys seen once replace each other and leave the keys that keep hitting
+    // alone.
+    HotKeySet& set = hot_keys_[key_hash(value) & hot_key_set_mask_];
+    const std::uint64_t entry = static_cast<std::uint64_t>(position) << 1;
+    for (auto& way : set.ways)
+    {
+        if (way.load(std::memory_order_relaxed) == kEmptyHotKey)
+        {
+            way.store(entry, std::memory_order_relaxed);
+            return;
+        }
+    }
+    for (auto& way : set.ways)
+    {
+        const std::uint64_t current = way.load(std::memory_order_relaxed);
+        if ((current & 1) == 0)
+        {
+            way.store(entry, std::memory_order_relaxed);
+            return;
+        }
+        way.store(current & ~std::uint64_t{1}, std::memory_order_relaxed);
+    }
+    set.ways[0].store(entry, std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::clear_hot_keys()
+{
+    if (!hot_keys_)
+    {
+        return;
+    }
+    for (size_t i = 0; i <= hot_key_set_mask_; ++i)
+    {
+        for (auto& way : hot_keys_[i].ways)
+        {
+            way.store(kEmptyHotKey, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::pair<size_t, size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::range_bounds(const T& lo,
+                                                                                               const T& hi) const
+{
+    stats_.add(StatCounter::RangeQueries);
+    const size_t first = hinted_lower_bound(lo);
+    if (!comp_(lo, hi))
+    {
+        return {first, first};
+    }
+    // The end gallops forward from the start, so a short range costs a few comparisons on
+    // lines the first search just loaded rather than a second search from the root.
+    const auto start = blocks_.begin() + static_cast<std::ptrdiff_t>(first);
+    const auto last = gallop_lower_bound(start, blocks_.end(), hi, comp_);
+    return {first, static_cast<size_t>(last - blocks_.begin())};
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+bool BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::equivalent(const T& a, const T& b) const
+{
+    return !comp_(a, b) && !comp_(b, a);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_total_size() const
 {
     return blocks_.size();
 }
 
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::span<const T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_keys() const
+{
+    const auto lock = lock_shared();
+    return blocks_;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::snapshot() const -> Snapshot
+{
+    return Snapshot(*this);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::uint64_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::generation() const
+{
+    return instance_id_.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::Snapshot(const BasicDataBlockSequence& sequence)
+    : sequence_(&sequence), lock_(sequence.lock_shared())
+{
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_value(const T& value) const
+{
+    if (sequence_->filter_rejects(value, StatCounter::Lookups))
+    {
+        return std::nullopt;
+    }
+    return sequence_->get_value_locked(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_values(
+    std::span<const T> keys, std::span<std::optional<T>> results) const
+{
+    clear_batch_output(keys, results);
+    return sequence_->get_values_locked(keys, results);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_values(
+    std::span<const T> keys, std::span<std::uint64_t> found) const
+{
+    clear_batch_output(keys, found);
+    return sequence_->get_values_locked(keys, found);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::optional<size_t> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::find_index(
+    const T& value) const
+{
+    if (sequence_->filter_rejects(value, StatCounter::PositionQueries))
+    {
+        return std::nullopt;
+    }
+    return sequence_->find_index_locked(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::lower_bound(const T& value) const
+{
+    sequence_->stats_.add(StatCounter::PositionQueries);
+    return sequence_->hinted_lower_bound(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::count_range(const T& lo,
+                                                                                     const T& hi) const
+{
+    const auto [first, last] = sequence_->range_bounds(lo, hi);
+    return last - first;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::span<const T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_range(const T& lo,
+                                                                                               const T& hi) const
+{
+    const auto [first, last] = sequence_->range_bounds(lo, hi);
+    return sequence_->blocks_.subspan(first, last - first);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::span<const T> BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_keys() const
+{
+    return sequence_->blocks_;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::get_total_size() const
+{
+    return sequence_->blocks_.size();
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+std::uint64_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::Snapshot::generation() const
+{
+    return sequence_->instance_id_.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+void BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::save(const std::string& path) const
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable keys can be saved");
+
+    const auto lock = lock_shared();
+    const BlockIndexImage<T> image = index_.image();
+
+    SequenceFileHeader header;
+    header.key_size = sizeof(T);
+    header.key_type = kSequenceFileKeyType<T>;
+    header.layout = static_cast<std::uint32_t>(image.layout);
+    header.eytzinger_height = image.eytzinger_height;
+    header.leaf_count = image.leaf_count;
+    header.btree_top_count = image.btree_top_count;
+    header.learned_epsilon = image.learned_epsilon;
+    header.keys.count = blocks_.size();
+    header.learned_segments.count = image.learned_segments.size();
+
+    std::vector<std::span<const std::byte>> sections;
+    for (size_t i = 0; i < image.sections.size(); ++i)
+    {
+        header.index_sections[i].count = image.sections[i].size();
+        sections.push_back(std::as_bytes(image.sections[i]));
+    }
+    write_sequence_file(path, header, std::as_bytes(blocks_), sections, std::as_bytes(image.learned_segments));
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::open_mmap(const std::string& path,
+                                                                      SequenceOptions options, const Compare& comp)
+    -> BasicDataBlockSequence
+{
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable keys can be mapped");
+
+    auto file = std::make_shared<const MappedFile>(path);
+    const SequenceFileHeader& header = read_sequence_file_header(*file, sizeof(T), kSequenceFileKeyType<T>);
+    // The header checked that every section is in bounds and aligned for T.
+    auto section = [&](const SequenceFileSection& s)
+    {
+        return std::span<const T>(reinterpret_cast<const T*>(file->bytes().data() + s.offset),
+                                  static_cast<size_t>(s.count));
+    };
+
+    BlockIndexImage<T> image;
+    image.layout = static_cast<Layout>(header.layout);
+    image.leaf_count = static_cast<size_t>(header.leaf_count);
+    image.eytzinger_height = header.eytzinger_height;
+    image.btree_top_count = static_cast<size_t>(header.btree_top_count);
+    image.learned_epsilon = static_cast<size_t>(header.learned_epsilon);
+    for (std::uint32_t i = 0; i < header.index_section_count; ++i)
+    {
+        image.sections.push_back(section(header.index_sections[i]));
+    }
+    image.learned_segments = {reinterpret_cast<const LearnedSegment*>(file->bytes().data() +
+                                                                      header.learned_segments.offset),
+                              static_cast<size_t>(header.learned_segments.count)};
+    const std::span<const T> keys = section(header.keys);
+    if (header.layout > static_cast<std::uint32_t>(Layout::Learned) ||
+        !BlockIndex<T, Compare>::is_consistent(image, keys.size()))
+    {
+        throw std::runtime_error("sequence file: index does not match the keys");
+    }
+
+    // A view over the mapped keys with no index of its own; the mapped one is put in place
+    // before anyone else can see the sequence.
+    options.layout = Layout::Sorted;
+    options.build_pool = nullptr;
+    BasicDataBlockSequence sequence(assume_sorted, keys, options, comp);
+    sequence.index_ = BlockIndex<T, Compare>::view(image, comp);
+    sequence.mapping_ = std::move(file);
+    return sequence;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::intersect(const BasicDataBlockSequence& a,
+                                                                      const BasicDataBlockSequence& b,
+                                                                      SequenceOptions options) -> BasicDataBlockSequence
+{
+    const auto locks = lock_all_shared({&a, &b});
+
+    // 1. The result is at most a, so each part writes where its share of a starts.
+    const std::span<const T> ranges[] = {a.blocks_, b.blocks_};
+    const size_t pivot = a.blocks_.size() >= b.blocks_.size() ? 0 : 1;
+    std::vector<T, Allocator> keys(a.blocks_.size(), a.owned_.get_allocator());
+    const size_t count = detail::partitioned<T>(
+        ranges, 1, pivot, keys.data(), a.comp_, options.build_pool,
+        [&](std::span<const std::span<const T>> parts, size_t offset)
+        { return detail::intersect_ranges(parts[0], parts[1], keys.data() + offset, a.comp_); });
+
+    // 2. Give back what a much smaller result does not need.
+    keys.resize(count);
+    if (count < keys.capacity() / 2)
+    {
+        keys.shrink_to_fit();
+    }
+    return BasicDataBlockSequence(assume_sorted, std::move(keys), options, a.comp_);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::intersect_count(const BasicDataBlockSequence& a,
+                                                                              const BasicDataBlockSequence& b,
+                                                                              ThreadPool* pool)
+{
+    const auto locks = lock_all_shared({&a, &b});
+    const std::span<const T> ranges[] = {a.blocks_, b.blocks_};
+    const size_t pivot = a.blocks_.size() >= b.blocks_.size() ? 0 : 1;
+    return detail::partitioned<T>(ranges, 1, pivot, nullptr, a.comp_, pool,
+                                  [&](std::span<const std::span<const T>> parts, size_t)
+                                  { return detail::intersect_ranges<T>(parts[0], parts[1], nullptr, a.comp_); });
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::merge_union(
+    std::span<const BasicDataBlockSequence* const> inputs, SequenceOptions options) -> BasicDataBlockSequence
+{
+    if (inputs.empty())
+    {
+        return BasicDataBlockSequence(assume_sorted, std::vector<T, Allocator>(), options);
+    }
+    const BasicDataBlockSequence& first = *inputs.front();
+    const auto locks = lock_all_shared(std::vector<const BasicDataBlockSequence*>(inputs.begin(), inputs.end()));
+
+    // 1. The union is at most every key of every input; each part writes where its keys
+    //    would start if the inputs were laid end to end. The largest input gives the cuts.
+    std::vector<std::span<const T>> ranges;
+    size_t total = 0;
+    size_t pivot = 0;
+    for (const BasicDataBlockSequence* input : inputs)
+    {
+        if (input->blocks_.size() > inputs[pivot]->blocks_.size())
+        {
+            pivot = ranges.size();
+        }
+        ranges.push_back(input->blocks_);
+        total += input->blocks_.size();
+    }
+    std::vector<T, Allocator> keys(total, first.owned_.get_allocator());
+    const size_t count = detail::partitioned<T>(
+        ranges, ranges.size(), pivot, keys.data(), first.comp_, options.build_pool,
+        [&](std::span<const std::span<const T>> parts, size_t offset)
+        { return detail::union_ranges(parts, keys.data() + offset, first.comp_); });
+
+    // 2. Repeated keys make the union smaller than the inputs together.
+    keys.resize(count);
+    if (count < keys.capacity() / 2)
+    {
+        keys.shrink_to_fit();
+    }
+    return BasicDataBlockSequence(assume_sorted, std::move(keys), options, first.comp_);
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+bool BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::is_view() const
+{
+    const auto lock = lock_shared();
+    return !blocks_.empty() && owned_.empty();
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+MruMode BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_mru_mode() const
+{
+    return mru_mode_;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+HintSearch BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_hint_search() const
+{
+    return hint_search_;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+HintStats BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_hint_stats() const
+{
+    auto count = [&](HintOutcome outcome)
+    { return hint_counters_.counts[static_cast<size_t>(outcome)].load(std::memory_order_relaxed); };
+    HintStats stats;
+    stats.exact_hits = count(HintOutcome::ExactHit);
+    stats.hot_key_hits = count(HintOutcome::HotKeyHit);
+    stats.near_hits = count(HintOutcome::NearHit);
+    stats.misses = count(HintOutcome::Miss);
+    return stats;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+SequenceStats BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::stats() const
+{
+    return stats_.snapshot();
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::lock_shared() const -> shared_lock_type
+{
+    if constexpr (kTimeLocks)
+    {
+        std::shared_lock<LockPolicy> lock(mru_mutex_, std::try_to_lock);
+        std::uint64_t waited = 0;
+        if (!lock.owns_lock())
+        {
+            const auto start = std::chrono::steady_clock::now();
+            lock.lock();
+            waited = nanoseconds_since(start);
+            stats_.add(StatCounter::ContendedLocks);
+            stats_.record(StatHistogram::SharedLockWait, waited);
+        }
+        trace(TraceEvent::SharedLockAcquire, this, waited);
+        if constexpr (kTracingEnabled)
+        {
+            return shared_lock_type(std::move(lock), this);
+        }
+        else
+        {
+            return lock;
+        }
+    }
+    else
+    {
+        return std::shared_lock<LockPolicy>(mru_mutex_);
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+auto BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::lock_all_shared(
+    std::vector<const BasicDataBlockSequence*> sequences) -> std::vector<shared_lock_type>
+{
+    // One fixed order for every caller, and one lock per sequence however often it is named:
+    // a shared lock of a writer-preferring mutex can block on itself.
+    std::sort(sequences.begin(), sequences.end(), std::less<const BasicDataBlockSequence*>{});
+    sequences.erase(std::unique(sequences.begin(), sequences.end()), sequences.end());
+    std::vector<shared_lock_type> locks;
+    locks.reserve(sequences.size());
+    for (const BasicDataBlockSequence* sequence : sequences)
+    {
+        locks.push_back(sequence->lock_shared());
+    }
+    return locks;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_filter_bytes() const
+{
+    const auto lock = lock_shared();
+    const BlockedBloomFilter* filter = filter_.load(std::memory_order_relaxed);
+    return filter != nullptr ? filter->size_in_bytes() : 0;
+}
+
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+Layout BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::get_layout() const
+{
+    const auto lock = lock_shared();
+    return index_.layout();
+}
+
+template class BasicDataBlockSequence<int, std::less<int>, NullMutex>;
+template class BasicDataBlockSequence<int, std::less<int>, ExclusiveMutex>;
+template class BasicDataBlockSequence<int, std::less<int>, std::shared_mutex>;
+template class BasicDataBlockSequence<int, std::less<int>, EpochMutex>;
+
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+template class BasicDataBlockSequence<int, std::less<int>, NullMutex, std::pmr::polymorphic_allocator<int>>;
+template class BasicDataBlockSequence<int, std::less<int>, ExclusiveMutex, std::pmr::polymorphic_allocator<int>>;
+template class BasicDataBlockSequence<int, std::less<int>, std::shared_mutex, std::pmr::polymorphic_allocator<int>>;
+template class BasicDataBlockSequence<int, std::less<int>, EpochMutex, std::pmr::polymorphic_allocator<int>>;
+
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex,
+                                      std::pmr::polymorphic_allocator<std::int64_t>>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex,
+                                      std::pmr::polymorphic_allocator<std::int64_t>>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex,
+                                      std::pmr::polymorphic_allocator<std::int64_t>>;
+template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex,
+                                      std::pmr::polymorphic_allocator<std::int64_t>>;
+
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex,
+                                      std::pmr::polymorphic_allocator<std::uint64_t>>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex,
+                                      std::pmr::polymorphic_allocator<std::uint64_t>>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex,
+                                      std::pmr::polymorphic_allocator<std::uint64_t>>;
+template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex,
+                                      std::pmr::polymorphic_allocator<std::uint64_t>>;
+
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex,
+                                      std::pmr::polymorphic_allocator<CompositeKey>>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex,
+                                      std::pmr::polymorphic_allocator<CompositeKey>>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex,
+                                      std::pmr::polymorphic_allocator<CompositeKey>>;
+template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex,
+                                      std::pmr::polymorphic_allocator<CompositeKey>>;
+
 }  // namespace iterator_mutex
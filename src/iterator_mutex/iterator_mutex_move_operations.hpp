@@ -1,32 +1,517 @@
 #pragma once
 
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "key_filter.hpp"
+#include "key_types.hpp"
+#include "lock_policies.hpp"
+#include "search_layouts.hpp"
+#include "sequence_stats.hpp"
+#include "thread_pool.hpp"
+#include "trace_points.hpp"
+
 namespace iterator_mutex
 {
 
-class DataBlockSequence
+class MappedFile;
+
+// Where get_value keeps its most-recently-used hint.
+enum class MruMode
+{
+    // One hint shared by all readers. Any reader may overwrite it, so with many readers it
+    // rarely hits and its cache line bounces between cores.
+    Shared,
+    // Every thread keeps its own hint, so readers never overwrite each other's hint.
+    PerThread,
+};
+
+// What get_value does with its MRU hint when the key there is not the one asked for.
+enum class HintSearch
+{
+    // Searches the layout from the top, so only a repeat of the same key is cheaper.
+    Exact,
+    // Finger search: gallops outward from the hint, so a key d positions away costs
+    // O(log d). Past a fixed reach it gives up and searches the layout from the top. Suits
+    // lookups that walk through the keys or stay near the previous one.
+    Finger,
+    // As Finger, but starts from where the key would be if the keys were spread evenly
+    // between the first and the last, ignoring the hint. Suits uniformly distributed keys
+    // accessed at random. Arithmetic keys ordered by std::less only; other keys use Finger.
+    Interpolation,
+};
+
+struct SequenceOptions
+{
+    MruMode mru_mode = MruMode::Shared;
+    Layout layout = Layout::Sorted;
+    // Sorts the keys and builds the layout index on these threads, and splits intersect and
+    // merge_union over them. Only used while the constructor or the set operation runs;
+    // without a pool the work is single-threaded.
+    ThreadPool* build_pool = nullptr;
+    HintSearch hint_search = HintSearch::Exact;
+    // Counts HintStats for get_value, find_index and the other single-key queries. Off by
+    // default: every reader then updates shared counters, which costs a contended cache line.
+    bool hint_stats = false;
+    // Entries in the hot-key cache, 0 for none. It remembers the positions of recently found
+    // keys in a 4-way set-associative table shared by all readers, and is probed after the
+    // MRU hint and before any search, so a few hot keys no longer evict each other the way
+    // they do from the single hint. Each entry takes 8 bytes: 64 to 512 entries fit in L1.
+    // Rounded up to a power of two of at least 4.
+    size_t hot_keys = 0;
+    // Bits per key of a BlockedBloomFilter over the keys, 0 for none. get_value and find_index
+    // check it before taking the lock, so a key it rules out costs one cache line and no
+    // search: at 10 bits that is all but about 1% of absent keys. Built by the constructor,
+    // which then reads every key, also for a view or open_mmap. Keys without a byte hash,
+    // ones with padding, get no filter.
+    size_t filter_bits_per_key = 0;
+    // How far the Learned layout's model may be off, in positions: the size/latency knob of
+    // that layout. The search after the model reads 2 * learned_epsilon + 1 keys, but each
+    // halving of it takes about four times the segments, 16 bytes plus a key each. 32 keeps
+    // the final search to a few cache lines and the model small for near-uniform keys.
+    size_t learned_epsilon = kDefaultLearnedEpsilon;
+};
+
+// Tags a constructor argument as already sorted by the sequence's comparator, so the sort is
+// skipped. Builds without NDEBUG still verify the order and throw std::invalid_argument if
+// it does not hold.
+struct assume_sorted_t
+{
+    explicit assume_sorted_t() = default;
+};
+inline constexpr assume_sorted_t assume_sorted{};
+
+// A sorted, searchable sequence of keys of type T, ordered by Compare. Two keys are equal
+// when neither orders before the other. Integral keys ordered by std::less take the vector
+// search kernels, see has_simd_kernel_v; every other T goes through branch-free comparisons.
+//
+// LockPolicy is any type meeting the SharedMutex requirements, see lock_policies.hpp.
+// Readers take it in shared mode and the move operations take it exclusively, so the
+// policy decides how well get_value scales with the number of reader threads.
+//
+// Allocator allocates the keys the sequence owns. The vector constructors take a vector with
+// that allocator, so the rvalue ones adopt its buffer as they do with std::allocator. With
+// std::pmr::polymorphic_allocator, see pmr::BasicDataBlockSequence, the memory resource
+// travels with the vector, e.g. a HugePageResource or a RecyclingResource from
+// memory_resources.hpp.
+//
+// The member functions are defined in the library and instantiated for int, std::int64_t,
+// std::uint64_t and CompositeKey with their default comparator, under every lock policy, with
+// std::allocator and with std::pmr::polymorphic_allocator.
+template <typename T, typename Compare = std::less<T>, typename LockPolicy = std::shared_mutex,
+          typename Allocator = std::allocator<T>>
+class BasicDataBlockSequence
 {
 public:
-    DataBlockSequence(const std::vector<int>& values);
+    using value_type = T;
+    using key_compare = Compare;
+    using allocator_type = Allocator;
+    // What readers hold the lock with: std::shared_lock, or with tracing a TracedLock around
+    // it that reports the release.
+    using shared_lock_type = std::conditional_t<kTracingEnabled, TracedLock<std::shared_lock<LockPolicy>>,
+                                                std::shared_lock<LockPolicy>>;
+
+    // Copies values, with the allocator of values, and sorts the copy.
+    BasicDataBlockSequence(const std::vector<T, Allocator>& values, SequenceOptions options = {},
+                           const Compare& comp = Compare{});
+    // Takes over the buffer of values and sorts it in place, so a rebuild costs no copy. With
+    // a build pool the sort needs a second buffer of the same size for merging.
+    BasicDataBlockSequence(std::vector<T, Allocator>&& values, SequenceOptions options = {},
+                           const Compare& comp = Compare{});
+    // As above, for values that are already sorted.
+    BasicDataBlockSequence(assume_sorted_t, const std::vector<T, Allocator>& values, SequenceOptions options = {},
+                           const Compare& comp = Compare{});
+    BasicDataBlockSequence(assume_sorted_t, std::vector<T, Allocator>&& values, SequenceOptions options = {},
+                           const Compare& comp = Compare{});
+    // Non-owning: searches the caller's sorted keys in place, e.g. a memory-mapped file. They
+    // must stay alive and unchanged for as long as this sequence, or whatever it is moved
+    // into, refers to them. Only the layout index is allocated.
+    BasicDataBlockSequence(assume_sorted_t, std::span<const T> sorted_keys, SequenceOptions options = {},
+                           const Compare& comp = Compare{});
 
     // Delete copy constructor and assignment operator
-    DataBlockSequence(const DataBlockSequence&) = delete;
-    DataBlockSequence& operator=(const DataBlockSequence&) = delete;
-    // Allow move constructor and assignment operator
-    DataBlockSequence(DataBlockSequence&& other) noexcept;
-    DataBlockSequence& operator=(DataBlockSequence&& other) noexcept;
+    BasicDataBlockSequence(const BasicDataBlockSequence&) = delete;
+    BasicDataBlockSequence& operator=(const BasicDataBlockSequence&) = delete;
+    // Allow move constructor and assignment operator. Move assignment keeps this sequence's
+    // allocator, as std containers do; if other's allocator differs and does not propagate,
+    // the keys are moved into newly allocated memory, and failing to get it terminates.
+    // Both leave other empty and ready for reuse. The move constructor only locks other,
+    // since no one else can see the new sequence yet, so std::vector and other containers
+    // can relocate sequences cheaply.
+    BasicDataBlockSequence(BasicDataBlockSequence&& other) noexcept;
+    BasicDataBlockSequence& operator=(BasicDataBlockSequence&& other) noexcept;
+    ~BasicDataBlockSequence();
 
-    std::optional<int> get_value(int value) const;
+    // Exchanges the keys, their index, key filter and mapping with other's, under both locks.
+    // As with move assignment, each object keeps its options, hot-key table and stats, and
+    // both lose their hints. O(1) unless the allocators differ and do not propagate on swap;
+    // then the keys are moved element by element, and failing to allocate terminates.
+    void swap(BasicDataBlockSequence& other) noexcept;
+    friend void swap(BasicDataBlockSequence& a, BasicDataBlockSequence& b) noexcept
+    {
+        a.swap(b);
+    }
+
+    std::optional<T> get_value(const T& value) const;
+
+    // Batch lookups. Every key is looked up under a single lock acquisition, and the result
+    // for keys[i] goes to slot i of the output. When keys are sorted in ascending order, the
+    // search walks the blocks once with galloping steps instead of running an independent
+    // binary search per key. Otherwise the independent searches of up to 16 keys run side by
+    // side through the layout, each prefetching its next step while the others run, which on
+    // sequences far larger than the cache hides most of the memory latency of all but one
+    // of them. MRU hints are neither used nor updated. Both return the
+    // number of keys found and throw std::invalid_argument if the output is too small.
+    //
+    // results[i] holds the value if keys[i] is present and std::nullopt otherwise.
+    size_t get_values(std::span<const T> keys, std::span<std::optional<T>> results) const;
+    // found is a bitmap: bit (i % 64) of word (i / 64) is set if keys[i] is present. It needs
+    // at least (keys.size() + 63) / 64 words, and all of those words are overwritten.
+    size_t get_values(std::span<const T> keys, std::span<std::uint64_t> found) const;
+
+    // Position and range queries. Each takes the lock once and starts from the same MRU hint
+    // as get_value, which they also update when they find a key equal to the one asked for.
+    //
+    // The position of value among the sorted keys, the first one if it occurs more than
+    // once, or std::nullopt if it is absent.
+    std::optional<size_t> find_index(const T& value) const;
+    // The number of keys ordered before value, i.e. the position of the first key that is not,
+    // or get_total_size() if there is none.
+    size_t lower_bound(const T& value) const;
+    // The number of keys in [lo, hi); 0 unless lo orders before hi.
+    size_t count_range(const T& lo, const T& hi) const;
+    // The keys in [lo, hi), which are one contiguous run of get_keys() and valid as long.
+    std::span<const T> get_range(const T& lo, const T& hi) const;
+    // Calls fn(key) for every key in [lo, hi) in order, streaming over the run get_range
+    // returns, and returns how many there were. The lock is held in shared mode while fn runs,
+    // so fn must not move or assign to this sequence.
+    template <typename Fn>
+    size_t for_each_in_range(const T& lo, const T& hi, Fn&& fn) const;
 
     size_t get_total_size() const;
 
+    // The sorted keys, e.g. for merging them into a new sequence. The span stays valid until
+    // this sequence is moved from or assigned to.
+    std::span<const T> get_keys() const;
+
+    // A read-only view of one generation of a sequence's contents, see snapshot(). Its queries
+    // behave as the sequence's own, hints included, but take no lock, and every one of them
+    // sees the same keys. A moved-from snapshot may only be destroyed or assigned to.
+    class Snapshot
+    {
+    public:
+        std::optional<T> get_value(const T& value) const;
+        size_t get_values(std::span<const T> keys, std::span<std::optional<T>> results) const;
+        size_t get_values(std::span<const T> keys, std::span<std::uint64_t> found) const;
+        std::optional<size_t> find_index(const T& value) const;
+        size_t lower_bound(const T& value) const;
+        size_t count_range(const T& lo, const T& hi) const;
+        // Spans into the keys, valid as long as the snapshot.
+        std::span<const T> get_range(const T& lo, const T& hi) const;
+        std::span<const T> get_keys() const;
+        size_t get_total_size() const;
+        // The sequence's generation() when the snapshot was taken, for as long as it lives.
+        std::uint64_t generation() const;
+
+    private:
+        friend class BasicDataBlockSequence;
+        explicit Snapshot(const BasicDataBlockSequence& sequence);
+
+        const BasicDataBlockSequence* sequence_;
+        shared_lock_type lock_;
+    };
+
+    // Pins the current contents for a run of queries that must agree with each other, with one
+    // lock acquisition for all of them. The snapshot holds this sequence's lock in shared mode
+    // until it is destroyed, so moves and swaps of the sequence wait for it: keep snapshots
+    // short, and publish through SnapshotBlockSequence for views that must live long. A thread
+    // holding a snapshot must not move or swap the sequence, and should query the snapshot
+    // rather than the sequence, since a second shared lock may queue behind a waiting writer.
+    Snapshot snapshot() const;
+
+    // Names the current contents. It changes whenever the keys change hands, by a move into
+    // or out of this sequence or a swap, to a value no sequence in the process has had before,
+    // so a cache built on top can tag what it stores with the generation it was computed at
+    // and drop it once that no longer matches. One relaxed atomic load, no lock.
+    std::uint64_t generation() const;
+
+    // Writes the sorted keys and the layout index to path in the format of sequence_file.hpp,
+    // replacing the file atomically. The comparator is not stored, so open the file with the
+    // one it was saved with. Throws std::system_error on I/O errors.
+    void save(const std::string& path) const;
+
+    // Maps a file written by save() and searches the mapped pages in place: nothing is read,
+    // sorted or built up front, and processes mapping the same file share one copy in the page
+    // cache. The file's layout is used and options.layout is ignored. The file must not be
+    // modified while mapped; save() replaces it by rename, which is safe. Throws
+    // std::system_error if the file cannot be mapped and std::runtime_error if it is not a
+    // sequence file of this key type.
+    static BasicDataBlockSequence open_mmap(const std::string& path, SequenceOptions options = {},
+                                            const Compare& comp = Compare{});
+
+    // Set operations over sequences ordered the same way. Each holds every input's lock in
+    // shared mode while it reads, taken in address order so two operations never wait on each
+    // other, and builds the result with the comparator and allocator of the first input from
+    // keys that come out in order, so nothing is sorted. With options.build_pool, large inputs
+    // are cut at the same keys into one part per thread, the parts run on the pool, and the
+    // result's index is built there too.
+    //
+    // The keys of a that are equivalent to some key of b, in order. A key a holds several
+    // times is kept every time, so for sequences without repeated keys this is the
+    // intersection. Sizes within a factor of 32 are merged with intersect_sorted, which
+    // vectorizes the integral keys; otherwise each key of the smaller one is galloped to in
+    // the larger one.
+    static BasicDataBlockSequence intersect(const BasicDataBlockSequence& a, const BasicDataBlockSequence& b,
+                                            SequenceOptions options = {});
+    // intersect(a, b).get_total_size() without building the result, split over pool if any.
+    static size_t intersect_count(const BasicDataBlockSequence& a, const BasicDataBlockSequence& b,
+                                  ThreadPool* pool = nullptr);
+    // Every key of the inputs, as many times as the input holding it most often has it: the
+    // union, and for two inputs what std::set_union gives. More inputs are merged pairwise as
+    // a balanced tree, in log k passes. inputs must not hold null pointers; an empty list
+    // gives an empty sequence.
+    static BasicDataBlockSequence merge_union(std::span<const BasicDataBlockSequence* const> inputs,
+                                              SequenceOptions options = {});
+
+    // True if the sequence searches keys it does not own, see the span constructor. An empty
+    // sequence has nothing to refer to and is never a view.
+    bool is_view() const;
+
+    MruMode get_mru_mode() const;
+
+    HintSearch get_hint_search() const;
+
+    // All zero unless the sequence was built with SequenceOptions::hint_stats. The counters
+    // belong to this object and are not carried over by moves.
+    HintStats get_hint_stats() const;
+
+    // Counters and histograms of everything this sequence did, see SequenceStats. Collected
+    // only in builds with ITERATOR_MUTEX_STATS, see kStatsEnabled, and all zero otherwise. Like
+    // the hint statistics they belong to this object and are not carried over by moves.
+    SequenceStats stats() const;
+
+    Layout get_layout() const;
+
+    // The memory taken by the key filter, 0 without one. The filter travels with the keys, by
+    // move construction and by move assignment alike.
+    size_t get_filter_bytes() const;
+
 private:
-    std::vector<int> blocks_;
-    mutable std::vector<int>::const_iterator mru_block_iterator_;
-    mutable std::mutex mru_mutex_;
+    // How many keys from its start a finger search may gallop before it falls back to the
+    // layout. About ten steps, which stays cheaper than a search from the top of a large
+    // sequence even when it fails.
+    static constexpr size_t kFingerReach = 1024;
+
+    // Ways per set of the hot-key cache, which makes a set half a cache line.
+    static constexpr size_t kHotKeyWays = 4;
+
+    // How a single-key query was answered, in the order of the HintStats fields.
+    enum class HintOutcome : size_t
+    {
+        ExactHit,
+        HotKeyHit,
+        NearHit,
+        Miss,
+        Count,
+    };
+
+    struct alignas(64) HintCounters
+    {
+        std::array<std::atomic<std::uint64_t>, static_cast<size_t>(HintOutcome::Count)> counts{};
+    };
+
+    // Takes mru_mutex_ in shared mode. With stats or tracing, a reader that cannot take it at
+    // once has its wait timed.
+    shared_lock_type lock_shared() const;
+    // The bodies of the queries of the same name, for callers that hold mru_mutex_ in shared
+    // mode: the public functions take it for one query, a Snapshot holds it for many. Both
+    // check the output size and the key filter before that, with the helpers below.
+    std::optional<T> get_value_locked(const T& value) const;
+    size_t get_values_locked(std::span<const T> keys, std::span<std::optional<T>> results) const;
+    size_t get_values_locked(std::span<const T> keys, std::span<std::uint64_t> found) const;
+    std::optional<size_t> find_index_locked(const T& value) const;
+    // Throw std::invalid_argument if the output of get_values is too small, and clear it.
+    static void clear_batch_output(std::span<const T> keys, std::span<std::optional<T>> results);
+    static void clear_batch_output(std::span<const T> keys, std::span<std::uint64_t> found);
+    // True if the key filter rules value out, which is then counted as a query of kind query
+    // that the filter rejected. Takes no lock.
+    bool filter_rejects(const T& value, StatCounter query) const;
+
+    // Takes the shared lock of every distinct sequence in sequences, in address order.
+    static std::vector<shared_lock_type> lock_all_shared(
+        std::vector<const BasicDataBlockSequence*> sequences);
+
+    // Both expect the caller to hold mru_mutex_ in shared mode.
+    std::optional<T> get_value_shared_mru(const T& value) const;
+    std::optional<T> get_value_per_thread_mru(const T& value) const;
+    // The position of the first key not less than value. A hint that already is that position
+    // answers without a search. Expects the caller to hold mru_mutex_ in shared mode.
+    size_t hinted_lower_bound(const T& value) const;
+    // The position of the first key not less than value, found by the configured HintSearch
+    // from hint, which may be past the end, or by the layout. Counts a near hit or a miss.
+    size_t search_from_hint(size_t hint, const T& value) const;
+    // The finger search proper: gallops from start towards value and returns std::nullopt
+    // once that takes it more than kFingerReach positions away.
+    std::optional<size_t> gallop_from(size_t start, const T& value) const;
+    // Where value would be if the keys were spread evenly between the first and the last.
+    size_t interpolate(const T& value) const;
+    void count_hint(HintOutcome outcome) const;
+
+    // An entry is (position << 1) | referenced. Readers validate a position against the key
+    // stored there before trusting it, so a racing update or an entry left over from older
+    // contents can only cost a miss, never a wrong answer.
+    struct alignas(kHotKeyWays * sizeof(std::uint64_t)) HotKeySet
+    {
+        std::atomic<std::uint64_t> ways[kHotKeyWays];
+    };
+    // A position holding a key equivalent to value, if the hot-key cache has one. The caller
+    // holds mru_mutex_.
+    std::optional<size_t> probe_hot_keys(const T& value) const;
+    // Records where value was found, replacing an entry not referenced since the last sweep
+    // of its set. The caller holds mru_mutex_.
+    void remember_hot_key(const T& value, size_t position) const;
+    // Empties every entry; the caller holds mru_mutex_ exclusively.
+    void clear_hot_keys();
+    // The positions [first, last) of the keys in [lo, hi); the caller holds mru_mutex_.
+    std::pair<size_t, size_t> range_bounds(const T& lo, const T& hi) const;
+    // Calls on_found(i) for every present keys[i]; the caller holds mru_mutex_.
+    template <typename OnFound>
+    size_t lookup_batch(std::span<const T> keys, OnFound&& on_found) const;
+    // True if neither key orders before the other.
+    bool equivalent(const T& a, const T& b) const;
+    // Points blocks_ at sorted keys and builds the index and the key filter over them.
+    void adopt(std::span<const T> sorted_keys, const SequenceOptions& options);
+    // True if the key filter rules value out. Takes no lock.
+    bool rejected_by_filter(const T& value) const;
+
+    // Backing storage when the sequence owns its keys, empty for a view.
+    std::vector<T, Allocator> owned_;
+    // The sorted keys every search runs on: owned_, or the caller's memory for a view. Moving
+    // owned_ keeps its buffer, so blocks_ travels along with it.
+    std::span<const T> blocks_;
+    [[no_unique_address]] Compare comp_;
+    // Keeps the file alive for a sequence opened with open_mmap; blocks_ and index_ point into it.
+    std::shared_ptr<const MappedFile> mapping_;
+    // Built from blocks_ and moved along with it.
+    BlockIndex<T, Compare> index_;
+    // Set by the constructors, the move constructor copying them from other under its lock,
+    // and not carried over by move assignment or swap.
+    MruMode mru_mode_{};
+    HintSearch hint_search_{};
+    bool hint_stats_ = false;
+    // Tags the current contents in the per-thread MRU slots, and is the generation(). A new id
+    // is drawn whenever blocks_ changes hands, so hints left behind by other threads can never
+    // match stale data. Only written under the exclusive lock, but generation() reads it
+    // without one.
+    std::atomic<std::uint64_t> instance_id_;
+    // Readers update the shared hint while holding the lock in shared mode, hence atomic.
+    // An index at or past the end means there is no hint.
+    mutable std::atomic<size_t> mru_block_index_{0};
+    mutable LockPolicy mru_mutex_;
+    // The hot-key cache, null without one. Moves keep each object's own table and empty it,
+    // except that the move constructor takes over other's, leaving other without a cache.
+    std::unique_ptr<HotKeySet[]> hot_keys_;
+    size_t hot_key_set_mask_ = 0;
+    // The key filter, null without one. Readers probe it without the lock, inside a read
+    // section of a domain shared by all sequences, so whoever replaces or destroys it waits
+    // for that domain before freeing the old one.
+    std::atomic<const BlockedBloomFilter*> filter_{nullptr};
+    // Only touched with hint_stats_ set. On a line of its own, so readers counting do not
+    // slow down readers of the fields above.
+    mutable HintCounters hint_counters_;
+    [[no_unique_address]] StatsRecorder stats_;
 };
 
+template <typename T, typename Compare, typename LockPolicy, typename Allocator>
+template <typename Fn>
+size_t BasicDataBlockSequence<T, Compare, LockPolicy, Allocator>::for_each_in_range(const T& lo, const T& hi,
+                                                                                   Fn&& fn) const
+{
+    const auto lock = lock_shared();
+    const auto [first, last] = range_bounds(lo, hi);
+    for (const T& key : blocks_.subspan(first, last - first))
+    {
+        fn(key);
+    }
+    return last - first;
+}
+
+extern template class BasicDataBlockSequence<int, std::less<int>, NullMutex>;
+extern template class BasicDataBlockSequence<int, std::less<int>, ExclusiveMutex>;
+extern template class BasicDataBlockSequence<int, std::less<int>, std::shared_mutex>;
+extern template class BasicDataBlockSequence<int, std::less<int>, EpochMutex>;
+
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+extern template class BasicDataBlockSequence<int, std::less<int>, NullMutex, std::pmr::polymorphic_allocator<int>>;
+extern template class BasicDataBlockSequence<int, std::less<int>, ExclusiveMutex, std::pmr::polymorphic_allocator<int>>;
+extern template class BasicDataBlockSequence<int, std::less<int>, std::shared_mutex,
+                                             std::pmr::polymorphic_allocator<int>>;
+extern template class BasicDataBlockSequence<int, std::less<int>, EpochMutex, std::pmr::polymorphic_allocator<int>>;
+
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex,
+                                             std::pmr::polymorphic_allocator<std::int64_t>>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex,
+                                             std::pmr::polymorphic_allocator<std::int64_t>>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex,
+                                             std::pmr::polymorphic_allocator<std::int64_t>>;
+extern template class BasicDataBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex,
+                                             std::pmr::polymorphic_allocator<std::int64_t>>;
+
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex,
+                                             std::pmr::polymorphic_allocator<std::uint64_t>>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex,
+                                             std::pmr::polymorphic_allocator<std::uint64_t>>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex,
+                                             std::pmr::polymorphic_allocator<std::uint64_t>>;
+extern template class BasicDataBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex,
+                                             std::pmr::polymorphic_allocator<std::uint64_t>>;
+
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex,
+                                             std::pmr::polymorphic_allocator<CompositeKey>>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex,
+                                             std::pmr::polymorphic_allocator<CompositeKey>>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex,
+                                             std::pmr::polymorphic_allocator<CompositeKey>>;
+extern template class BasicDataBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex,
+                                             std::pmr::polymorphic_allocator<CompositeKey>>;
+
+using DataBlockSequence = BasicDataBlockSequence<int>;
+
+namespace pmr
+{
+
+// Sequences whose keys come from a std::pmr::memory_resource, like the std::pmr containers.
+template <typename T, typename Compare = std::less<T>, typename LockPolicy = std::shared_mutex>
+using BasicDataBlockSequence =
+    iterator_mutex::BasicDataBlockSequence<T, Compare, LockPolicy, std::pmr::polymorphic_allocator<T>>;
+
+using DataBlockSequence = BasicDataBlockSequence<int>;
+
+}  // namespace pmr
+
 }  // namespace iterator_mutex
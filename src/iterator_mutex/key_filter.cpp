@@ -0,0 +1,28 @@
+#include "key_filter.hpp"
+
+#include <algorithm>
+
+namespace iterator_mutex
+{
+
+BlockedBloomFilter::BlockedBloomFilter(size_t keys, size_t bits_per_key)
+    : blocks_(std::max<size_t>(1, (keys * bits_per_key + 8 * sizeof(Block) - 1) / (8 * sizeof(Block))))
+{
+}
+
+void BlockedBloomFilter::insert(std::uint64_t hash)
+{
+    Block& block = blocks_[block_index(hash)];
+    const auto masks = bit_masks(hash);
+    for (size_t i = 0; i < kWords; ++i)
+    {
+        block.words[i] |= masks[i];
+    }
+}
+
+size_t BlockedBloomFilter::size_in_bytes() const
+{
+    return blocks_.size() * sizeof(Block);
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace iterator_mutex
+{
+
+// A blocked Bloom filter over 64-bit key hashes, in the split-block form used by Impala and
+// Parquet: the upper half of a hash picks a 256-bit block, half a cache line, and the lower
+// half sets one bit in each of its eight 32-bit words. A probe therefore touches one line and
+// compiles to straight-line code. At 10 bits per key it passes about 1% of absent keys; it
+// never rejects a key that was inserted.
+class BlockedBloomFilter
+{
+public:
+    // Sized for keys hashes at bits_per_key bits each, rounded up to whole blocks. Empty, so
+    // every probe fails, until hashes are inserted.
+    BlockedBloomFilter(size_t keys, size_t bits_per_key);
+
+    void insert(std::uint64_t hash);
+
+    // False only if hash was never inserted. Defined here so it inlines into the lookups that
+    // call it first.
+    bool may_contain(std::uint64_t hash) const
+    {
+        const Block& block = blocks_[block_index(hash)];
+        const auto masks = bit_masks(hash);
+        bool present = true;
+        for (size_t i = 0; i < kWords; ++i)
+        {
+            present &= (block.words[i] & masks[i]) != 0;
+        }
+        return present;
+    }
+
+    size_t size_in_bytes() const;
+
+private:
+    static constexpr size_t kWords = 8;
+
+    struct alignas(kWords * sizeof(std::uint32_t)) Block
+    {
+        std::array<std::uint32_t, kWords> words{};
+    };
+
+    // Fast range reduction of the upper half onto the block count, no division.
+    size_t block_index(std::uint64_t hash) const
+    {
+        return static_cast<size_t>(((hash >> 32) * blocks_.size()) >> 32);
+    }
+
+    // One bit per word, chosen by odd multipliers applied to the lower half of the hash.
+    static std::array<std::uint32_t, kWords> bit_masks(std::uint64_t hash)
+    {
+        constexpr std::array<std::uint32_t, kWords> kSalts{0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        const auto low = static_cast<std::uint32_t>(hash);
+        std::array<std::uint32_t, kWords> masks{};
+        for (size_t i = 0; i < kWords; ++i)
+        {
+            masks[i] = std::uint32_t{1} << ((low * kSalts[i]) >> 27);
+        }
+        return masks;
+    }
+
+    std::vector<Block> blocks_;
+};
+
+}  // namespace iterator_mutex
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+namespace iterator_mutex
+{
+
+// A 16-byte key ordered by high, then low, e.g. a (tenant, id) pair packed into two words.
+// The library ships instantiations of its sequences for it next to the integral keys.
+struct CompositeKey
+{
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+
+    friend auto operator<=>(const CompositeKey&, const CompositeKey&) = default;
+};
+
+}  // namespace iterator_mutex
@@ -0,0 +1,109 @@
+#include "lock_policies.hpp"
+
+#include <thread>
+
+#include "thread_slot.hpp"
+
+namespace iterator_mutex
+{
+
+EpochMutex::ReaderSlot& EpochMutex::reader_slot()
+{
+    return readers_[this_thread_slot() % kReaderSlots];
+}
+
+void EpochMutex::wait_for_readers()
+{
+    for (auto& slot : readers_)
+    {
+        while (slot.active.load(std::memory_order_seq_cst) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool EpochMutex::has_readers() const
+{
+    for (const auto& slot : readers_)
+    {
+        if (slot.active.load(std::memory_order_seq_cst) != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EpochMutex::lock()
+{
+    // Writers queue up on the mutex, then the flag keeps new readers out while the current
+    // ones finish.
+    writer_mutex_.lock();
+    writer_active_.store(true, std::memory_order_seq_cst);
+    wait_for_readers();
+}
+
+bool EpochMutex::try_lock()
+{
+    if (!writer_mutex_.try_lock())
+    {
+        return false;
+    }
+    // Readers may hold the lock for as long as they like, e.g. through a Snapshot, and one of
+    // them may be waiting for a lock this caller holds. So look once, and back off rather
+    // than wait if any reader is in: std::scoped_lock relies on try_lock not blocking.
+    writer_active_.store(true, std::memory_order_seq_cst);
+    if (has_readers())
+    {
+        writer_active_.store(false, std::memory_order_release);
+        writer_mutex_.unlock();
+        return false;
+    }
+    return true;
+}
+
+void EpochMutex::unlock()
+{
+    writer_active_.store(false, std::memory_order_release);
+    writer_mutex_.unlock();
+}
+
+void EpochMutex::lock_shared()
+{
+    ReaderSlot& slot = reader_slot();
+    for (;;)
+    {
+        // Announce first, then check for a writer. Both sides use seq_cst, so either the
+        // writer sees our counter or we see its flag.
+        slot.active.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer_active_.load(std::memory_order_seq_cst))
+        {
+            return;
+        }
+        slot.active.fetch_sub(1, std::memory_order_release);
+        while (writer_active_.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool EpochMutex::try_lock_shared()
+{
+    ReaderSlot& slot = reader_slot();
+    slot.active.fetch_add(1, std::memory_order_seq_cst);
+    if (!writer_active_.load(std::memory_order_seq_cst))
+    {
+        return true;
+    }
+    slot.active.fetch_sub(1, std::memory_order_release);
+    return false;
+}
+
+void EpochMutex::unlock_shared()
+{
+    reader_slot().active.fetch_sub(1, std::memory_order_release);
+}
+
+}  // namespace iterator_mutex
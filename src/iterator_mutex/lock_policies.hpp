@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace iterator_mutex
+{
+
+// Lock policies for BasicDataBlockSequence. Each one meets the standard SharedMutex
+// requirements, so readers go through std::shared_lock and moves through std::scoped_lock
+// whatever the policy. std::shared_mutex can be used directly and is the default.
+
+// Does no locking at all. Only for sequences that are never moved while other threads read
+// them, such as the immutable snapshots published by SnapshotBlockSequence.
+class NullMutex
+{
+public:
+    void lock()
+    {
+    }
+    bool try_lock()
+    {
+        return true;
+    }
+    void unlock()
+    {
+    }
+
+    void lock_shared()
+    {
+    }
+    bool try_lock_shared()
+    {
+        return true;
+    }
+    void unlock_shared()
+    {
+    }
+};
+
+// Gives every caller exclusive access, shared or not. This is the cheapest lock when there
+// is little contention, but readers are serialized.
+class ExclusiveMutex
+{
+public:
+    void lock()
+    {
+        mutex_.lock();
+    }
+    bool try_lock()
+    {
+        return mutex_.try_lock();
+    }
+    void unlock()
+    {
+        mutex_.unlock();
+    }
+
+    void lock_shared()
+    {
+        mutex_.lock();
+    }
+    bool try_lock_shared()
+    {
+        return mutex_.try_lock();
+    }
+    void unlock_shared()
+    {
+        mutex_.unlock();
+    }
+
+private:
+    std::mutex mutex_;
+};
+
+// Reader-writer lock for read-mostly data. Each reader announces itself in a counter on its
+// own cache line, chosen by its thread slot, so readers on different cores never write the
+// same line. A writer raises a flag and then waits for every reader counter to drain.
+// Readers arriving while the flag is up wait for the writer to finish. try_lock raises the
+// flag only to look: it fails if any reader is in, instead of waiting for them.
+//
+// Readers are cheaper than with std::shared_mutex, writers are more expensive, which fits
+// sequences that are read constantly and replaced by a move now and then.
+class EpochMutex
+{
+public:
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    void lock_shared();
+    bool try_lock_shared();
+    void unlock_shared();
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kReaderSlots = 64;
+
+    struct alignas(kCacheLineSize) ReaderSlot
+    {
+        std::atomic<std::uint32_t> active{0};
+    };
+
+    ReaderSlot& reader_slot();
+    // Whether any reader counter is nonzero, looking at each once.
+    bool has_readers() const;
+    void wait_for_readers();
+
+    std::array<ReaderSlot, kReaderSlots> readers_;
+    alignas(kCacheLineSize) std::atomic<bool> writer_active_{false};
+    std::mutex writer_mutex_;
+};
+
+}  // namespace iterator_mutex
@@ -0,0 +1,242 @@
+#include "memory_resources.hpp"
+
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+
+namespace iterator_mutex
+{
+
+namespace
+{
+
+constexpr size_t kTransparentPageSize = size_t{2} << 20;
+
+// The page size goes into bits 26 and up of the flags as its log2, see mmap(2).
+#ifdef MAP_HUGE_SHIFT
+constexpr int kHugeShift = MAP_HUGE_SHIFT;
+#else
+constexpr int kHugeShift = 26;
+#endif
+
+size_t page_size_of(HugePages pages)
+{
+    return pages == HugePages::Explicit1G ? size_t{1} << 30 : kTransparentPageSize;
+}
+
+// Maps length bytes aligned to kTransparentPageSize and asks for transparent huge pages.
+void* map_transparent(size_t length)
+{
+    // Over-map by one huge page and trim, since mmap only guarantees 4KB alignment.
+    const size_t padded = length + kTransparentPageSize;
+    void* raw = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    const auto begin = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (begin + kTransparentPageSize - 1) & ~(std::uintptr_t{kTransparentPageSize} - 1);
+    if (aligned > begin)
+    {
+        ::munmap(raw, aligned - begin);
+    }
+    const std::uintptr_t tail = aligned + length;
+    if (begin + padded > tail)
+    {
+        ::munmap(reinterpret_cast<void*>(tail), begin + padded - tail);
+    }
+    // Advisory: without THP support the memory is still usable on small pages.
+    ::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+    return reinterpret_cast<void*>(aligned);
+}
+
+}  // namespace
+
+HugePageResource::HugePageResource(HugePages pages) : pages_(pages), page_size_(page_size_of(pages))
+{
+}
+
+HugePages HugePageResource::pages() const
+{
+    return pages_;
+}
+
+size_t HugePageResource::mapped_bytes() const
+{
+    return mapped_bytes_.load(std::memory_order_relaxed);
+}
+
+size_t HugePageResource::mapping_page_size(size_t bytes) const
+{
+    // A 1GB page is only worth it when the allocation fills at least half of the last one.
+    const size_t rounded = (bytes + page_size_ - 1) / page_size_ * page_size_;
+    return rounded - bytes <= page_size_ / 2 ? page_size_ : kTransparentPageSize;
+}
+
+size_t HugePageResource::mapping_size(size_t bytes) const
+{
+    const size_t page = mapping_page_size(bytes);
+    return (bytes + page - 1) / page * page;
+}
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (bytes < kTransparentPageSize / 2)
+    {
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    if (alignment > kTransparentPageSize)
+    {
+        throw std::bad_alloc();
+    }
+
+    const size_t length = mapping_size(bytes);
+    void* p = nullptr;
+    if (pages_ != HugePages::Transparent && mapping_page_size(bytes) == page_size_)
+    {
+        const int size_flag = (pages_ == HugePages::Explicit1G ? 30 : 21) << kHugeShift;
+        p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1,
+                   0);
+        if (p == MAP_FAILED)
+        {
+            p = nullptr;
+        }
+    }
+    if (p == nullptr)
+    {
+        p = map_transparent(length);
+    }
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    mapped_bytes_.fetch_add(length, std::memory_order_relaxed);
+    return p;
+}
+
+void HugePageResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    if (bytes < kTransparentPageSize / 2)
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        return;
+    }
+    const size_t length = mapping_size(bytes);
+    ::munmap(p, length);
+    mapped_bytes_.fetch_sub(length, std::memory_order_relaxed);
+}
+
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+RecyclingResource::RecyclingResource(std::pmr::memory_resource* upstream, size_t max_cached_bytes,
+                                     size_t min_block_bytes)
+    : upstream_(upstream), max_cached_bytes_(max_cached_bytes), min_block_bytes_(min_block_bytes)
+{
+}
+
+RecyclingResource::~RecyclingResource()
+{
+    release();
+}
+
+void RecyclingResource::release()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [bytes, entry] : cache_)
+    {
+        upstream_->deallocate(entry.first, entry.second.bytes, entry.second.alignment);
+    }
+    cache_.clear();
+    cached_bytes_ = 0;
+}
+
+size_t RecyclingResource::cached_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_bytes_;
+}
+
+size_t RecyclingResource::reuse_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reuse_count_;
+}
+
+void* RecyclingResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (bytes < min_block_bytes_)
+    {
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Best fit among the blocks at most a quarter larger than asked for, so a small request
+        // does not tie up a much larger buffer.
+        for (auto it = cache_.lower_bound(bytes); it != cache_.end() && it->first <= bytes + bytes / 4; ++it)
+        {
+            if (it->second.second.alignment >= alignment)
+            {
+                // Track the block as live before taking it out of the cache: if that throws,
+                // it is still cached rather than lost.
+                const auto [p, block] = it->second;
+                live_.emplace(p, block);
+                cache_.erase(it);
+                cached_bytes_ -= block.bytes;
+                ++reuse_count_;
+                return p;
+            }
+        }
+    }
+
+    void* p = upstream_->allocate(bytes, alignment);
+    try
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        live_.emplace(p, Block{bytes, alignment});
+    }
+    catch (...)
+    {
+        upstream_->deallocate(p, bytes, alignment);
+        throw;
+    }
+    return p;
+}
+
+void RecyclingResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+    if (bytes < min_block_bytes_)
+    {
+        upstream_->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    Block block{bytes, alignment};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto it = live_.find(p); it != live_.end())
+        {
+            block = it->second;
+            live_.erase(it);
+        }
+        if (cached_bytes_ + block.bytes <= max_cached_bytes_)
+        {
+            cache_.emplace(block.bytes, std::make_pair(p, block));
+            cached_bytes_ += block.bytes;
+            return;
+        }
+    }
+    upstream_->deallocate(p, block.bytes, block.alignment);
+}
+
+bool RecyclingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+}  // namespace iterator_mutex
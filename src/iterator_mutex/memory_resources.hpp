@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <unordered_map>
+
+namespace iterator_mutex
+{
+
+enum class HugePages
+{
+    // Regular anonymous memory aligned to 2MB and marked with MADV_HUGEPAGE, so transparent
+    // huge pages back it whenever the kernel has them. Needs no setup.
+    Transparent,
+    // Pages from the kernel's reserved 2MB or 1GB hugetlb pool. When the pool is empty or not
+    // configured, the mapping falls back to Transparent instead of failing. Explicit1G only
+    // maps allocations that fill at least half of their last 1GB page from the pool; the rest
+    // are mapped as Transparent.
+    Explicit2M,
+    Explicit1G,
+};
+
+// Maps every large allocation straight from the kernel on huge pages, so scanning a large
+// key array takes a fraction of the TLB misses and page faults of 4KB pages. Allocations of
+// less than 1MB, half a 2MB page, go to std::pmr::new_delete_resource(), since each mapping
+// is rounded up to whole huge pages. Thread-safe. Throws std::bad_alloc if the mapping fails.
+class HugePageResource : public std::pmr::memory_resource
+{
+public:
+    explicit HugePageResource(HugePages pages = HugePages::Transparent);
+
+    HugePages pages() const;
+
+    // Bytes currently mapped on huge pages, rounded up to whole pages.
+    size_t mapped_bytes() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    // The page size bytes are mapped on: page_size_, or 2MB where rounding up to page_size_
+    // would waste more than half a page.
+    size_t mapping_page_size(size_t bytes) const;
+
+    // Rounds bytes up to whole pages of mapping_page_size(bytes).
+    size_t mapping_size(size_t bytes) const;
+
+    const HugePages pages_;
+    const size_t page_size_;
+    std::atomic<size_t> mapped_bytes_{0};
+};
+
+// Keeps large freed blocks instead of returning them upstream, and hands them out again to
+// allocations of about the same size. A sequence rebuilt every cycle then reuses the buffer
+// its predecessor freed, already faulted in, rather than going back to malloc or mmap; with
+// a HugePageResource upstream the reused buffer also keeps its huge pages. Thread-safe; the
+// lock is only taken for blocks of at least min_block_bytes, which are rare and large.
+class RecyclingResource : public std::pmr::memory_resource
+{
+public:
+    // Blocks of min_block_bytes or more are recycled, up to max_cached_bytes in total; smaller
+    // ones and anything over the limit go straight upstream. upstream must outlive this.
+    explicit RecyclingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(),
+                               size_t max_cached_bytes = size_t{4} << 30, size_t min_block_bytes = size_t{1} << 20);
+    ~RecyclingResource() override;
+
+    RecyclingResource(const RecyclingResource&) = delete;
+    RecyclingResource& operator=(const RecyclingResource&) = delete;
+
+    // Returns every cached block upstream.
+    void release();
+
+    // Bytes held in freed blocks waiting for reuse.
+    size_t cached_bytes() const;
+
+    // Allocations served from a cached block so far.
+    size_t reuse_count() const;
+
+private:
+    struct Block
+    {
+        size_t bytes = 0;      // As allocated upstream, which may exceed what was asked for.
+        size_t alignment = 0;  // As allocated upstream.
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* const upstream_;
+    const size_t max_cached_bytes_;
+    const size_t min_block_bytes_;
+
+    mutable std::mutex mutex_;
+    // Freed blocks by size, for best-fit reuse.
+    std::multimap<size_t, std::pair<void*, Block>> cache_;
+    // Large blocks handed out, so a reused block is freed with its real size.
+    std::unordered_map<void*, Block> live_;
+    size_t cached_bytes_ = 0;
+    size_t reuse_count_ = 0;
+};
+
+}  // namespace iterator_mutex
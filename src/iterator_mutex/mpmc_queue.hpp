@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace iterator_mutex
+{
+
+// A bounded multi-producer, multi-consumer queue without locks (Vyukov's ring). Every cell
+// carries a sequence number that says whose turn it is: a producer claims the tail position
+// with one compare-and-swap and publishes the value by bumping the cell's number, and a
+// consumer does the same at the head. Producers and consumers only meet on a cell, never on
+// a shared lock, and each position counter sits on its own cache line.
+//
+// T must be default constructible and move assignable; a cell holds a T at all times and a
+// value moves in and out by assignment. Items come out in the order their pushes claimed
+// the tail, which is FIFO for pushes that do not overlap.
+template <typename T>
+class MpmcQueue
+{
+public:
+    // capacity is rounded up to a power of two of at least 2.
+    explicit MpmcQueue(size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), cells_(std::make_unique<Cell[]>(mask_ + 1))
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    // Moves value in and returns true, or returns false and leaves value alone if the queue
+    // is full.
+    bool try_push(T& value)
+    {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &cells_[position & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (lag == 0)
+            {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;  // The cell still holds the item from one lap ago.
+            }
+            else
+            {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest item into out and returns true, or returns false if the queue is empty.
+    bool try_pop(T& out)
+    {
+        size_t position = head_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &cells_[position & mask_];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (lag == 0)
+            {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (lag < 0)
+            {
+                return false;  // No producer has published this cell yet.
+            }
+            else
+            {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        // The cell is free for the producer one lap ahead.
+        cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    const size_t mask_;
+    const std::unique_ptr<Cell[]> cells_;
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+};
+
+}  // namespace iterator_mutex
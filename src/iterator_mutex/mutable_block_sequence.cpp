@@ -0,0 +1,318 @@
+#include "mutable_block_sequence.hpp"
+
+#include <algorithm>
+#include <span>
+#include <utility>
+
+#include "parallel_sort.hpp"
+
+namespace iterator_mutex
+{
+
+template <typename T, typename Compare>
+BasicMutableBlockSequence<T, Compare>::BasicMutableBlockSequence(const std::vector<T>& values,
+                                                                 MutableSequenceOptions options, const Compare& comp)
+    : BasicMutableBlockSequence(std::vector<T>(values), options, comp)
+{
+}
+
+template <typename T, typename Compare>
+BasicMutableBlockSequence<T, Compare>::BasicMutableBlockSequence(std::vector<T>&& values,
+                                                                 MutableSequenceOptions options, const Compare& comp)
+    : comp_(comp), options_(options), empty_delta_(std::make_shared<const Delta>())
+{
+    initialize(std::move(values));
+    if (options_.background_compaction)
+    {
+        compaction_thread_ = std::thread([this]() { compaction_loop(); });
+    }
+}
+
+template <typename T, typename Compare>
+BasicMutableBlockSequence<T, Compare>::~BasicMutableBlockSequence()
+{
+    if (compaction_thread_.joinable())
+    {
+        stopping_.store(true, std::memory_order_release);
+        compaction_wake_.release();
+        compaction_thread_.join();
+    }
+
+    // Like any object, the handle must outlive its readers, so nobody can still see a version.
+    delete current_.load(std::memory_order_relaxed);
+    for (const Version* version : retired_)
+    {
+        delete version;
+    }
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::initialize(std::vector<T>&& values)
+{
+    parallel_sort(values, comp_, options_.base.build_pool);
+    values.erase(std::unique(values.begin(), values.end(),
+                             [this](const T& a, const T& b) { return !comp_(a, b) && !comp_(b, a); }),
+                 values.end());
+
+    const size_t size = values.size();
+    auto base = std::make_shared<const Base>(assume_sorted, std::move(values), options_.base, comp_);
+    current_.store(new Version{std::move(base), nullptr, empty_delta_, size}, std::memory_order_release);
+}
+
+template <typename T, typename Compare>
+auto BasicMutableBlockSequence<T, Compare>::current_version() const -> const Version*
+{
+    // seq_cst pairs with the increment in EpochDomain::ReadGuard, see epoch_domain.hpp.
+    return current_.load(std::memory_order_seq_cst);
+}
+
+template <typename T, typename Compare>
+auto BasicMutableBlockSequence<T, Compare>::delta_lower_bound(const Delta& delta, const T& value) const ->
+    typename Delta::const_iterator
+{
+    return std::lower_bound(delta.begin(), delta.end(), value,
+                            [this](const DeltaEntry& entry, const T& key) { return comp_(entry.key, key); });
+}
+
+template <typename T, typename Compare>
+auto BasicMutableBlockSequence<T, Compare>::find(const Delta& delta, const T& value) const -> const DeltaEntry*
+{
+    const auto it = delta_lower_bound(delta, value);
+    if (it != delta.end() && !comp_(value, it->key))
+    {
+        return &*it;
+    }
+    return nullptr;
+}
+
+template <typename T, typename Compare>
+bool BasicMutableBlockSequence<T, Compare>::present_below_active(const Version& version, const T& value) const
+{
+    if (version.frozen != nullptr)
+    {
+        if (const DeltaEntry* entry = find(*version.frozen, value))
+        {
+            return !entry->erased;
+        }
+    }
+    return version.base->get_value(value).has_value();
+}
+
+template <typename T, typename Compare>
+std::optional<T> BasicMutableBlockSequence<T, Compare>::get_value(const T& value) const
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    const Version* version = current_version();
+
+    // 1. Newest changes first: the active delta, then a delta being compacted.
+    for (const Delta* delta : {version->active.get(), version->frozen.get()})
+    {
+        if (delta == nullptr)
+        {
+            continue;
+        }
+        if (const DeltaEntry* entry = find(*delta, value))
+        {
+            return entry->erased ? std::nullopt : std::optional<T>(entry->key);
+        }
+    }
+
+    // 2. No change recorded, so the base array decides.
+    return version->base->get_value(value);
+}
+
+template <typename T, typename Compare>
+size_t BasicMutableBlockSequence<T, Compare>::get_total_size() const
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    return current_version()->size;
+}
+
+template <typename T, typename Compare>
+size_t BasicMutableBlockSequence<T, Compare>::get_pending_changes() const
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    const Version* version = current_version();
+    return version->active->size() + (version->frozen != nullptr ? version->frozen->size() : 0);
+}
+
+template <typename T, typename Compare>
+bool BasicMutableBlockSequence<T, Compare>::insert(const T& value)
+{
+    return apply(value, true);
+}
+
+template <typename T, typename Compare>
+bool BasicMutableBlockSequence<T, Compare>::erase(const T& value)
+{
+    return apply(value, false);
+}
+
+template <typename T, typename Compare>
+bool BasicMutableBlockSequence<T, Compare>::apply(const T& value, bool present)
+{
+    size_t pending = 0;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        // Only writers replace the version, and they hold write_mutex_.
+        const Version* version = current_.load(std::memory_order_relaxed);
+        const Delta& active = *version->active;
+
+        // 1. Find the current state: an entry in the active delta, or else the layers below.
+        const auto it = delta_lower_bound(active, value);
+        const bool in_active = it != active.end() && !comp_(value, it->key);
+        // An entry only exists where it differs from the layers below.
+        const bool below = in_active ? it->erased : present_below_active(*version, value);
+        const bool visible = in_active ? !it->erased : below;
+        if (visible == present)
+        {
+            return false;
+        }
+
+        // 2. Copy the delta with the change. If the change restores the state below, the entry
+        //    goes away; otherwise there was none and it is added.
+        auto next = std::make_shared<Delta>();
+        next->reserve(active.size() + 1);
+        next->insert(next->end(), active.begin(), it);
+        if (!in_active)
+        {
+            next->push_back(DeltaEntry{value, !present});
+        }
+        next->insert(next->end(), in_active ? it + 1 : it, active.end());
+
+        // 3. Publish.
+        pending = next->size();
+        const size_t size = present ? version->size + 1 : version->size - 1;
+        publish_locked(new Version{version->base, version->frozen, std::move(next), size});
+    }
+
+    if (pending >= options_.compaction_threshold)
+    {
+        request_compaction();
+    }
+    return true;
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::publish_locked(const Version* next)
+{
+    retired_.push_back(current_.exchange(next, std::memory_order_seq_cst));
+    if (retired_.size() >= kRetireBatch)
+    {
+        reclaim_locked();
+    }
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::reclaim_locked()
+{
+    // One grace period covers every version retired so far.
+    epoch_domain_.synchronize();
+    for (const Version* version : retired_)
+    {
+        delete version;
+    }
+    retired_.clear();
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::compact()
+{
+    std::lock_guard<std::mutex> compaction_lock(compaction_mutex_);
+
+    // 1. Freeze the active delta, so writes go to a new one while the merge runs. A delta
+    //    left frozen by a compaction that threw is merged first, on its own.
+    std::shared_ptr<const Base> base;
+    std::shared_ptr<const Delta> frozen;
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        const Version* version = current_.load(std::memory_order_relaxed);
+        base = version->base;
+        frozen = version->frozen;
+        if (frozen == nullptr)
+        {
+            if (version->active->empty())
+            {
+                return;
+            }
+            frozen = version->active;
+            publish_locked(new Version{base, frozen, empty_delta_, version->size});
+        }
+    }
+
+    // 2. Merge the frozen delta into the keys of the base array. Inserted keys are absent from
+    //    the base and erased ones present in it, so tombstones drop exactly one key.
+    const std::span<const T> keys = base->get_keys();
+    std::vector<T> merged;
+    merged.reserve(keys.size() + frozen->size());
+    auto key = keys.begin();
+    for (const DeltaEntry& entry : *frozen)
+    {
+        while (key != keys.end() && comp_(*key, entry.key))
+        {
+            merged.push_back(*key++);
+        }
+        if (entry.erased)
+        {
+            ++key;
+        }
+        else
+        {
+            merged.push_back(entry.key);
+        }
+    }
+    merged.insert(merged.end(), key, keys.end());
+    auto next_base = std::make_shared<const Base>(assume_sorted, std::move(merged), options_.base, comp_);
+
+    // 3. Publish the new base array under the writes made since step 1, and free the old one.
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const Version* version = current_.load(std::memory_order_relaxed);
+    publish_locked(new Version{std::move(next_base), nullptr, version->active, version->size});
+    base.reset();
+    reclaim_locked();
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::request_compaction()
+{
+    if (!options_.background_compaction)
+    {
+        compact();
+        return;
+    }
+    // One wake-up per batch of requests; the flag is cleared once the compaction starts.
+    if (!compaction_requested_.exchange(true, std::memory_order_acq_rel))
+    {
+        compaction_wake_.release();
+    }
+}
+
+template <typename T, typename Compare>
+void BasicMutableBlockSequence<T, Compare>::compaction_loop()
+{
+    for (;;)
+    {
+        compaction_wake_.acquire();
+        if (stopping_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+        compaction_requested_.store(false, std::memory_order_release);
+        try
+        {
+            compact();
+        }
+        catch (...)
+        {
+            // Out of memory for the new base array. The changes stay pending, lookups stay
+            // correct, and the next write past the threshold tries again.
+        }
+    }
+}
+
+template class BasicMutableBlockSequence<int>;
+template class BasicMutableBlockSequence<std::int64_t>;
+template class BasicMutableBlockSequence<std::uint64_t>;
+template class BasicMutableBlockSequence<CompositeKey>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+#include "epoch_domain.hpp"
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+namespace iterator_mutex
+{
+
+struct MutableSequenceOptions
+{
+    // Used for the initial base array and every base array a compaction builds, so a
+    // build_pool set here must outlive the sequence. Base arrays are read by every thread at
+    // once, so a per-thread MRU hint is the default.
+    SequenceOptions base = {MruMode::PerThread};
+    // Pending changes that trigger a compaction.
+    size_t compaction_threshold = 4096;
+    // Compacts on a thread owned by the sequence. Without it, the write that reaches the
+    // threshold compacts before it returns.
+    bool background_compaction = true;
+};
+
+// A sorted set of keys that takes inserts and erases, in the style of an LSM tree. The keys
+// live in an immutable base array; changes go to a small sorted delta of inserted keys and
+// tombstones on top of it. A lookup checks the delta first and the base array after it, so
+// each change costs a copy of the delta instead of a rebuild of the base.
+//
+// Once the delta holds compaction_threshold changes it is frozen, a new empty delta takes
+// the writes that follow, and a compaction merges the frozen delta into a new base array in
+// one linear pass. Lookups keep reading the frozen delta and the old base array until the
+// new base array is published.
+//
+// Readers never lock. As in BasicSnapshotBlockSequence, they load the current version (base
+// array plus deltas) inside an epoch read section, and writers publish a new version with one
+// atomic exchange. Writers are serialized with each other. Retired versions are reclaimed in
+// batches, so a write does not normally wait for readers.
+//
+// The handle is neither copyable nor movable. It is instantiated for the same key types as
+// BasicDataBlockSequence.
+template <typename T, typename Compare = std::less<T>>
+class BasicMutableBlockSequence
+{
+public:
+    // Base arrays are never moved or modified once published, so they need no lock.
+    using Base = BasicDataBlockSequence<T, Compare, NullMutex>;
+
+    // The initial keys are sorted, and equivalent keys after the first are dropped.
+    explicit BasicMutableBlockSequence(const std::vector<T>& values, MutableSequenceOptions options = {},
+                                       const Compare& comp = Compare{});
+    explicit BasicMutableBlockSequence(std::vector<T>&& values, MutableSequenceOptions options = {},
+                                       const Compare& comp = Compare{});
+    ~BasicMutableBlockSequence();
+
+    BasicMutableBlockSequence(const BasicMutableBlockSequence&) = delete;
+    BasicMutableBlockSequence& operator=(const BasicMutableBlockSequence&) = delete;
+
+    std::optional<T> get_value(const T& value) const;
+
+    size_t get_total_size() const;
+
+    // Both return true if the call changed the contents, i.e. if value was absent before an
+    // insert or present before an erase.
+    bool insert(const T& value);
+    bool erase(const T& value);
+
+    // Merges every pending change into a new base array and returns once it is published.
+    // Writes keep going while the merge runs and stay pending for the next compaction.
+    void compact();
+
+    // Changes not yet merged into the base array, in the delta and in a frozen delta that is
+    // being compacted.
+    size_t get_pending_changes() const;
+
+private:
+    // A key that differs from the layers below it: inserted if it is absent there, erased if
+    // it is present. Changes that restore the state below remove the entry instead.
+    struct DeltaEntry
+    {
+        T key;
+        bool erased = false;
+    };
+    using Delta = std::vector<DeltaEntry>;
+
+    // Everything a reader sees. Versions are immutable once published and share their parts.
+    struct Version
+    {
+        std::shared_ptr<const Base> base;
+        std::shared_ptr<const Delta> frozen;  // Being merged into a new base; null if none.
+        std::shared_ptr<const Delta> active;  // Takes the writes; never null.
+        size_t size = 0;
+    };
+
+    // Versions retired between two grace periods.
+    static constexpr size_t kRetireBatch = 64;
+
+    void initialize(std::vector<T>&& values);
+    // Makes value present or absent. Returns true if it was not already.
+    bool apply(const T& value, bool present);
+    // The first entry of delta not ordered before value.
+    typename Delta::const_iterator delta_lower_bound(const Delta& delta, const T& value) const;
+    // The entry for value in delta, or nullptr.
+    const DeltaEntry* find(const Delta& delta, const T& value) const;
+    // True if value is present in the frozen delta and base array of version.
+    bool present_below_active(const Version& version, const T& value) const;
+
+    // Callers must be inside a read section of epoch_domain_.
+    const Version* current_version() const;
+    // Both expect the caller to hold write_mutex_.
+    void publish_locked(const Version* next);
+    void reclaim_locked();
+
+    void request_compaction();
+    void compaction_loop();
+
+    [[no_unique_address]] Compare comp_;
+    const MutableSequenceOptions options_;
+    const std::shared_ptr<const Delta> empty_delta_;
+
+    std::atomic<const Version*> current_{nullptr};
+    mutable EpochDomain epoch_domain_;
+    // Serializes writers and publishes; readers never take it.
+    std::mutex write_mutex_;
+    // Unlinked but maybe still read; guarded by write_mutex_.
+    std::vector<const Version*> retired_;
+
+    // Serializes compactions, so at most one delta is frozen at a time.
+    std::mutex compaction_mutex_;
+    std::atomic<bool> compaction_requested_{false};
+    std::atomic<bool> stopping_{false};
+    // Released once per compaction request and once on shutdown.
+    std::counting_semaphore<> compaction_wake_{0};
+    std::thread compaction_thread_;
+};
+
+extern template class BasicMutableBlockSequence<int>;
+extern template class BasicMutableBlockSequence<std::int64_t>;
+extern template class BasicMutableBlockSequence<std::uint64_t>;
+extern template class BasicMutableBlockSequence<CompositeKey>;
+
+using MutableBlockSequence = BasicMutableBlockSequence<int>;
+
+}  // namespace iterator_mutex
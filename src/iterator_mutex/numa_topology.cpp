@@ -0,0 +1,186 @@
+#include "numa_topology.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace iterator_mutex
+{
+
+namespace
+{
+
+// Calls between two samples of the current CPU. sched_getcpu costs about as much as a
+// lookup in a small sequence, so it is not worth paying every time.
+constexpr unsigned kCpuSampleInterval = 4096;
+
+// Parses a kernel CPU list such as "0-3,8-11". Stops at the first malformed range.
+std::vector<int> parse_cpu_list(const std::string& text)
+{
+    std::vector<int> cpus;
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ','))
+    {
+        int first = 0;
+        int last = 0;
+        char dash = 0;
+        std::stringstream parts(range);
+        if (!(parts >> first))
+        {
+            break;
+        }
+        last = first;
+        if (parts >> dash && (dash != '-' || !(parts >> last)))
+        {
+            break;
+        }
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+}  // namespace
+
+NumaTopology::NumaTopology(const std::string& node_directory)
+{
+    // 1. Collect nodeN directories by kernel id; ids can have gaps.
+    std::vector<std::pair<int, std::filesystem::path>> nodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(node_directory, error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+            std::all_of(name.begin() + 4, name.end(), [](unsigned char c) { return std::isdigit(c) != 0; }))
+        {
+            nodes.emplace_back(std::stoi(name.substr(4)), entry.path());
+        }
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    // 2. Read their CPUs. Nodes with memory but no CPUs have no threads to serve and are skipped.
+    for (const auto& [id, path] : nodes)
+    {
+        std::ifstream in(path / "cpulist");
+        std::string text;
+        std::getline(in, text);
+        auto cpus = parse_cpu_list(text);
+        if (!cpus.empty())
+        {
+            node_cpus_.push_back(std::move(cpus));
+        }
+    }
+
+    if (node_cpus_.empty())
+    {
+        std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t cpu = 0; cpu < cpus.size(); ++cpu)
+        {
+            cpus[cpu] = static_cast<int>(cpu);
+        }
+        node_cpus_.push_back(std::move(cpus));
+    }
+
+    for (size_t node = 0; node < node_cpus_.size(); ++node)
+    {
+        for (int cpu : node_cpus_[node])
+        {
+            if (static_cast<size_t>(cpu) >= cpu_node_.size())
+            {
+                cpu_node_.resize(static_cast<size_t>(cpu) + 1, 0);
+            }
+            cpu_node_[static_cast<size_t>(cpu)] = node;
+        }
+    }
+}
+
+const NumaTopology& NumaTopology::system()
+{
+    static const NumaTopology topology("/sys/devices/system/node");
+    return topology;
+}
+
+size_t NumaTopology::node_count() const
+{
+    return node_cpus_.size();
+}
+
+const std::vector<int>& NumaTopology::cpus_of(size_t node) const
+{
+    return node_cpus_.at(node);
+}
+
+size_t NumaTopology::node_of_cpu(int cpu) const
+{
+    return cpu >= 0 && static_cast<size_t>(cpu) < cpu_node_.size() ? cpu_node_[static_cast<size_t>(cpu)] : 0;
+}
+
+size_t NumaTopology::current_node() const
+{
+    thread_local int cpu = -1;
+    thread_local unsigned calls_left = 0;
+    if (calls_left-- == 0)
+    {
+        cpu = ::sched_getcpu();
+        calls_left = kCpuSampleInterval;
+    }
+    return node_of_cpu(cpu);
+}
+
+void NumaTopology::run_on_each_node(const std::function<void(size_t node)>& fn) const
+{
+    std::vector<std::exception_ptr> errors(node_cpus_.size());
+    std::vector<std::thread> workers;
+    workers.reserve(node_cpus_.size());
+    for (size_t node = 0; node < node_cpus_.size(); ++node)
+    {
+        workers.emplace_back(
+            [&, node]()
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int cpu : node_cpus_[node])
+                {
+                    if (cpu < CPU_SETSIZE)
+                    {
+                        CPU_SET(cpu, &set);
+                    }
+                }
+                // Best effort: without the pin the work is still done, only not placed.
+                ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+                try
+                {
+                    fn(node);
+                }
+                catch (...)
+                {
+                    errors[node] = std::current_exception();
+                }
+            });
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace iterator_mutex
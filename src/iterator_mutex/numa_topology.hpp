@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace iterator_mutex
+{
+
+// The NUMA nodes of the machine and the CPUs on each, read from sysfs. Nodes are numbered
+// densely from 0 in the order of their kernel ids. A machine or container without the node
+// directory is treated as a single node holding every CPU.
+class NumaTopology
+{
+public:
+    // Reads node_directory in the layout of /sys/devices/system/node: one nodeN directory
+    // per node, each with a cpulist such as "0-3,8-11".
+    explicit NumaTopology(const std::string& node_directory);
+
+    // The topology of this machine, read once.
+    static const NumaTopology& system();
+
+    size_t node_count() const;
+
+    const std::vector<int>& cpus_of(size_t node) const;
+
+    // The node of cpu; 0 for a CPU that no node lists.
+    size_t node_of_cpu(int cpu) const;
+
+    // The node of the CPU the caller runs on. The CPU is sampled every few thousand calls
+    // rather than on every call, so a thread that migrates is picked up a little later.
+    size_t current_node() const;
+
+    // Calls fn(node) for every node at once, each on a new thread pinned to the CPUs of that
+    // node, and waits for all of them; the first exception thrown is rethrown here. Memory fn
+    // touches first is allocated on its node under the default first-touch policy. A thread
+    // that cannot be pinned, e.g. in a restricted CPU set, still runs fn, only unplaced.
+    void run_on_each_node(const std::function<void(size_t node)>& fn) const;
+
+private:
+    std::vector<std::vector<int>> node_cpus_;
+    // Indexed by CPU number.
+    std::vector<size_t> cpu_node_;
+};
+
+}  // namespace iterator_mutex
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+namespace detail
+{
+
+// Number of elements taken from a for the first `diagonal` outputs of merging a and b, with
+// ties going to a. Lets several threads write disjoint parts of one merge.
+template <typename T, typename Compare>
+size_t merge_path_split(const T* a, size_t a_size, const T* b, size_t b_size, size_t diagonal, const Compare& comp)
+{
+    size_t low = diagonal > b_size ? diagonal - b_size : 0;
+    size_t high = std::min(diagonal, a_size);
+    while (low < high)
+    {
+        const size_t i = low + (high - low) / 2;
+        const size_t j = diagonal - i;
+        // a[i] is still among the first outputs if it does not order after b[j - 1].
+        if (j > 0 && !comp(b[j - 1], a[i]))
+        {
+            low = i + 1;
+        }
+        else
+        {
+            high = i;
+        }
+    }
+    return low;
+}
+
+}  // namespace detail
+
+// Sorts values by comp, in parallel on pool when there is one and the input is large enough
+// to be worth it. The values are cut into one run per thread and each run is sorted with
+// std::sort; the runs are then merged pairwise, and every merge is split along its merge path
+// so all threads take part in each round, including the last. Needs a second buffer as large
+// as values for the merges, taken from the allocator of values. Not stable.
+template <typename T, typename Allocator, typename Compare>
+void parallel_sort(std::vector<T, Allocator>& values, const Compare& comp, ThreadPool* pool)
+{
+    constexpr size_t kMinRun = size_t{1} << 14;
+    const size_t n = values.size();
+    const size_t threads = pool != nullptr ? pool->size() + 1 : 1;
+    const size_t run_count = std::min(threads, n / kMinRun);
+    if (run_count < 2)
+    {
+        std::sort(values.begin(), values.end(), comp);
+        return;
+    }
+
+    // Run r covers [bounds[r], bounds[r + 1]).
+    std::vector<size_t> bounds(run_count + 1);
+    for (size_t r = 0; r <= run_count; ++r)
+    {
+        bounds[r] = n * r / run_count;
+    }
+    parallel_for(pool, run_count, [&](size_t r)
+                 { std::sort(values.begin() + bounds[r], values.begin() + bounds[r + 1], comp); });
+
+    std::vector<T, Allocator> buffer(n, values.get_allocator());
+    std::vector<T, Allocator>* source = &values;
+    std::vector<T, Allocator>* target = &buffer;
+
+    struct Piece
+    {
+        size_t first;  // Left run of the merge; the right run ends at last.
+        size_t middle;
+        size_t last;
+        size_t out_begin;  // Output range of this piece, relative to first.
+        size_t out_end;
+    };
+
+    while (bounds.size() > 2)
+    {
+        // Merge runs 2k and 2k + 1; an odd run out at the end is merged with nothing, i.e. copied.
+        std::vector<size_t> next_bounds;
+        std::vector<Piece> pieces;
+        for (size_t r = 0; r + 1 < bounds.size(); r += 2)
+        {
+            const size_t first = bounds[r];
+            const size_t middle = bounds[r + 1];
+            const size_t last = r + 2 < bounds.size() ? bounds[r + 2] : middle;
+            next_bounds.push_back(first);
+
+            const size_t size = last - first;
+            const size_t piece_count = std::max<size_t>(1, threads * size / n);
+            for (size_t p = 0; p < piece_count; ++p)
+            {
+                pieces.push_back({first, middle, last, size * p / piece_count, size * (p + 1) / piece_count});
+            }
+        }
+        next_bounds.push_back(n);
+
+        parallel_for(pool, pieces.size(),
+                     [&](size_t p)
+                     {
+                         const Piece& piece = pieces[p];
+                         const T* a = source->data() + piece.first;
+                         const T* b = source->data() + piece.middle;
+                         const size_t a_size = piece.middle - piece.first;
+                         const size_t b_size = piece.last - piece.middle;
+                         const size_t a_begin =
+                             detail::merge_path_split(a, a_size, b, b_size, piece.out_begin, comp);
+                         const size_t a_end = detail::merge_path_split(a, a_size, b, b_size, piece.out_end, comp);
+                         std::merge(a + a_begin, a + a_end, b + (piece.out_begin - a_begin),
+                                    b + (piece.out_end - a_end), target->data() + piece.first + piece.out_begin,
+                                    comp);
+                     });
+
+        std::swap(source, target);
+        bounds = std::move(next_bounds);
+    }
+
+    if (source != &values)
+    {
+        values.swap(buffer);
+    }
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,253 @@
+#include "query_executor.hpp"
+
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "thread_slot.hpp"
+
+namespace iterator_mutex
+{
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicQueryExecutor<T, Compare, LockPolicy>::BasicQueryExecutor(std::vector<Sequence>&& sequences,
+                                                               QueryExecutorOptions options)
+    : sequences_(std::move(sequences)), max_batch_(std::max<size_t>(options.max_batch, 1))
+{
+    const size_t threads = std::max<size_t>(options.threads, 1);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        workers_.push_back(std::make_unique<Worker>(options.queue_capacity));
+    }
+
+    // Every queue exists before the first worker looks for one to steal from.
+    std::vector<int> cpus;
+    if (options.pin_workers)
+    {
+        const NumaTopology& topology = options.topology != nullptr ? *options.topology : NumaTopology::system();
+        for (size_t node = 0; node < topology.node_count(); ++node)
+        {
+            cpus.insert(cpus.end(), topology.cpus_of(node).begin(), topology.cpus_of(node).end());
+        }
+    }
+    for (size_t i = 0; i < threads; ++i)
+    {
+        const int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        workers_[i]->thread = std::thread([this, i, cpu]() { worker_loop(i, cpu); });
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicQueryExecutor<T, Compare, LockPolicy>::~BasicQueryExecutor()
+{
+    // Workers drain every queue before they look at stopping_ again.
+    stopping_.store(true, std::memory_order_seq_cst);
+    for (auto& worker : workers_)
+    {
+        worker->signal.fetch_add(1, std::memory_order_seq_cst);
+        worker->signal.notify_one();
+    }
+    for (auto& worker : workers_)
+    {
+        worker->thread.join();
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicQueryExecutor<T, Compare, LockPolicy>::sequence_count() const
+{
+    return sequences_.size();
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+auto BasicQueryExecutor<T, Compare, LockPolicy>::sequence(size_t index) const -> const Sequence&
+{
+    return sequences_.at(index);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicQueryExecutor<T, Compare, LockPolicy>::worker_count() const
+{
+    return workers_.size();
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+std::future<std::optional<T>> BasicQueryExecutor<T, Compare, LockPolicy>::lookup(size_t index, const T& key)
+{
+    std::promise<std::optional<T>> promise;
+    auto future = promise.get_future();
+    submit({index, key, std::move(promise)});
+    return future;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicQueryExecutor<T, Compare, LockPolicy>::lookup(size_t index, const T& key, Callback on_done)
+{
+    submit({index, key, std::move(on_done)});
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicQueryExecutor<T, Compare, LockPolicy>::submit(Request request)
+{
+    if (request.sequence >= sequences_.size())
+    {
+        throw std::out_of_range("QueryExecutor: no sequence " + std::to_string(request.sequence));
+    }
+
+    // 1. The home queue keeps one thread's requests together, so they batch well; the others
+    //    take the overflow.
+    const size_t count = workers_.size();
+    const size_t home = this_thread_slot() % count;
+    for (;;)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Worker& worker = *workers_[(home + i) % count];
+            if (worker.queue.try_push(request))
+            {
+                // 2. Wake the owner if it sleeps. The fence pairs with the one in worker_loop:
+                //    either the worker sees this request when it looks again, or this sees
+                //    it sleeping.
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (worker.sleeping.load(std::memory_order_relaxed))
+                {
+                    worker.signal.fetch_add(1, std::memory_order_relaxed);
+                    worker.signal.notify_one();
+                }
+                return;
+            }
+        }
+        std::this_thread::yield();  // Every queue is full; let the workers catch up.
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicQueryExecutor<T, Compare, LockPolicy>::take(size_t index, std::vector<Request>& batch)
+{
+    const size_t count = workers_.size();
+    Request request;
+    for (size_t i = 0; i < count && batch.empty(); ++i)
+    {
+        MpmcQueue<Request>& queue = workers_[(index + i) % count]->queue;
+        while (batch.size() < max_batch_ && queue.try_pop(request))
+        {
+            batch.push_back(std::move(request));
+        }
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicQueryExecutor<T, Compare, LockPolicy>::worker_loop(size_t index, int cpu)
+{
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+    }
+
+    Worker& self = *workers_[index];
+    std::vector<Request> batch;
+    batch.reserve(max_batch_);
+    std::vector<size_t> order;
+    std::vector<T> keys;
+    std::vector<std::optional<T>> results;
+
+    int idle_rounds = 0;
+    for (;;)
+    {
+        take(index, batch);
+        if (batch.empty())
+        {
+            if (stopping_.load(std::memory_order_seq_cst))
+            {
+                return;  // Every queue is empty and no one submits any more.
+            }
+            if (++idle_rounds < kSpinRounds)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce the sleep, look once more, and only then wait. A submitter that
+            // pushed before the fence is seen by the look; one after it sees sleeping and
+            // bumps signal, which the wait then does not block on.
+            const std::uint32_t signal = self.signal.load(std::memory_order_relaxed);
+            self.sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            take(index, batch);
+            if (batch.empty() && !stopping_.load(std::memory_order_seq_cst))
+            {
+                self.signal.wait(signal, std::memory_order_relaxed);
+            }
+            self.sleeping.store(false, std::memory_order_relaxed);
+            idle_rounds = 0;
+            continue;
+        }
+        idle_rounds = 0;
+
+        // 1. Group the batch by sequence.
+        order.resize(batch.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::sort(order.begin(), order.end(),
+                  [&](size_t a, size_t b) { return batch[a].sequence < batch[b].sequence; });
+
+        // 2. One batch lookup per sequence, then hand out its results.
+        for (size_t begin = 0; begin < order.size();)
+        {
+            const size_t sequence = batch[order[begin]].sequence;
+            size_t end = begin;
+            keys.clear();
+            while (end < order.size() && batch[order[end]].sequence == sequence)
+            {
+                keys.push_back(batch[order[end]].key);
+                ++end;
+            }
+            results.assign(keys.size(), std::nullopt);
+            sequences_[sequence].get_values(keys, results);
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                auto& reply = batch[order[i]].reply;
+                if (auto* on_done = std::get_if<Callback>(&reply))
+                {
+                    (*on_done)(results[i - begin]);
+                }
+                else if (auto* promise = std::get_if<std::promise<std::optional<T>>>(&reply))
+                {
+                    promise->set_value(results[i - begin]);
+                }
+            }
+            begin = end;
+        }
+        batch.clear();
+    }
+}
+
+template class BasicQueryExecutor<int, std::less<int>, NullMutex>;
+template class BasicQueryExecutor<int, std::less<int>, ExclusiveMutex>;
+template class BasicQueryExecutor<int, std::less<int>, std::shared_mutex>;
+template class BasicQueryExecutor<int, std::less<int>, EpochMutex>;
+
+template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, NullMutex>;
+template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, NullMutex>;
+template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+}  // namespace iterator_mutex
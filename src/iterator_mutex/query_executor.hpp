@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+#include "mpmc_queue.hpp"
+#include "numa_topology.hpp"
+
+namespace iterator_mutex
+{
+
+struct QueryExecutorOptions
+{
+    // Worker threads, each with its own request queue.
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    // Requests each worker's queue holds, rounded up to a power of two. A submitter only
+    // waits when every queue is full.
+    size_t queue_capacity = 1024;
+    // The most requests a worker takes off the queues for one round of batch lookups.
+    size_t max_batch = 64;
+    // Pins worker i to the i-th CPU of the topology in node order, wrapping around. Best
+    // effort: a worker that cannot be pinned still runs, only unplaced.
+    bool pin_workers = true;
+    // The machine to pin to, NumaTopology::system() if null. Must outlive the executor.
+    const NumaTopology* topology = nullptr;
+};
+
+// Runs lookups on a set of sequences it owns, on a pool of worker threads, for callers that
+// would otherwise each wrap get_value in their own pool and queue.
+//
+// A lookup is queued on the submitting thread's home queue, one lock-free MpmcQueue per
+// worker, and its result comes back through a future or a callback. A worker drains up to
+// max_batch requests from its own queue, or steals them from the others when its own is
+// empty. It sorts them by sequence and answers each sequence's share with one get_values
+// call, so the lock, the queueing and the cache misses are paid per batch rather than per
+// key. Idle workers sleep on an atomic and are woken by the next submission to their queue.
+//
+// All members are safe to call from any number of threads. It is instantiated for the same
+// key types and lock policies as BasicDataBlockSequence.
+template <typename T, typename Compare = std::less<T>, typename LockPolicy = std::shared_mutex>
+class BasicQueryExecutor
+{
+public:
+    using value_type = T;
+    using Sequence = BasicDataBlockSequence<T, Compare, LockPolicy>;
+    // Called on a worker thread with the result of one lookup. It must not throw, which
+    // terminates the program, and should be short: the rest of the worker's batch waits.
+    using Callback = std::function<void(std::optional<T>)>;
+
+    explicit BasicQueryExecutor(std::vector<Sequence>&& sequences, QueryExecutorOptions options = {});
+    // Answers every request submitted so far, then stops the workers. Nothing may be
+    // submitted once destruction has begun.
+    ~BasicQueryExecutor();
+
+    BasicQueryExecutor(const BasicQueryExecutor&) = delete;
+    BasicQueryExecutor& operator=(const BasicQueryExecutor&) = delete;
+
+    size_t sequence_count() const;
+    const Sequence& sequence(size_t index) const;
+    size_t worker_count() const;
+
+    // Looks up key in sequence(index) on a worker, as get_value does. Both throw
+    // std::out_of_range for an index past sequence_count(), and wait while every queue is full.
+    std::future<std::optional<T>> lookup(size_t index, const T& key);
+    void lookup(size_t index, const T& key, Callback on_done);
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    // Rounds of looking for work, yielding in between, before a worker goes to sleep.
+    static constexpr int kSpinRounds = 64;
+
+    struct Request
+    {
+        size_t sequence = 0;
+        T key{};
+        std::variant<std::monostate, Callback, std::promise<std::optional<T>>> reply;
+    };
+
+    struct alignas(kCacheLineSize) Worker
+    {
+        explicit Worker(size_t capacity) : queue(capacity)
+        {
+        }
+
+        MpmcQueue<Request> queue;
+        // Submitters bump it to wake the worker while it waits on it.
+        std::atomic<std::uint32_t> signal{0};
+        std::atomic<bool> sleeping{false};
+        std::thread thread;
+    };
+
+    void submit(Request request);
+    // Moves up to max_batch_ requests into batch: from worker index's own queue, or if that
+    // is empty, from the first other queue that is not.
+    void take(size_t index, std::vector<Request>& batch);
+    void worker_loop(size_t index, int cpu);
+
+    std::vector<Sequence> sequences_;
+    const size_t max_batch_;
+    std::atomic<bool> stopping_{false};
+    // Never resized once the workers run.
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+extern template class BasicQueryExecutor<int, std::less<int>, NullMutex>;
+extern template class BasicQueryExecutor<int, std::less<int>, ExclusiveMutex>;
+extern template class BasicQueryExecutor<int, std::less<int>, std::shared_mutex>;
+extern template class BasicQueryExecutor<int, std::less<int>, EpochMutex>;
+
+extern template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, NullMutex>;
+extern template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+extern template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+extern template class BasicQueryExecutor<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+extern template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+extern template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+extern template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+extern template class BasicQueryExecutor<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+extern template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, NullMutex>;
+extern template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+extern template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+extern template class BasicQueryExecutor<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+using QueryExecutor = BasicQueryExecutor<int>;
+
+}  // namespace iterator_mutex
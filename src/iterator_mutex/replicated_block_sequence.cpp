@@ -0,0 +1,169 @@
+#include "replicated_block_sequence.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "parallel_sort.hpp"
+
+namespace iterator_mutex
+{
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicReplicatedBlockSequence<T, Compare, LockPolicy>::BasicReplicatedBlockSequence(const std::vector<T>& values,
+                                                                                  ReplicatedSequenceOptions options,
+                                                                                  const Compare& comp)
+    : BasicReplicatedBlockSequence(std::vector<T>(values), options, comp)
+{
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicReplicatedBlockSequence<T, Compare, LockPolicy>::BasicReplicatedBlockSequence(std::vector<T>&& values,
+                                                                                  ReplicatedSequenceOptions options,
+                                                                                  const Compare& comp)
+    : comp_(comp),
+      replica_options_(options.sequence),
+      replicate_(options.replicate),
+      topology_(options.topology != nullptr ? options.topology : &NumaTopology::system())
+{
+    // The pool only sorts; every replica index is built by its pinned thread.
+    replica_options_.build_pool = nullptr;
+    replicas_ = build(std::move(values), options.sequence.build_pool);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+auto BasicReplicatedBlockSequence<T, Compare, LockPolicy>::operator=(BasicReplicatedBlockSequence&& other)
+    -> BasicReplicatedBlockSequence&
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    if (replicas_.size() != other.replicas_.size())
+    {
+        throw std::invalid_argument("ReplicatedBlockSequence: move between different replica counts");
+    }
+
+    for (size_t node = 0; node < replicas_.size(); ++node)
+    {
+        replicas_[node]->sequence = std::move(other.replicas_[node]->sequence);
+    }
+    return *this;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+auto BasicReplicatedBlockSequence<T, Compare, LockPolicy>::build(std::vector<T>&& values, ThreadPool* pool) const
+    -> std::vector<std::unique_ptr<Replica>>
+{
+    parallel_sort(values, comp_, pool);
+
+    std::vector<std::unique_ptr<Replica>> replicas;
+    if (!replicate_)
+    {
+        replicas.push_back(std::make_unique<Replica>(Replica{
+            Sequence(assume_sorted, std::move(values), replica_options_, comp_)}));
+        return replicas;
+    }
+
+    // Each pinned thread copies the keys itself, so the copy, the index built over it and the
+    // replica object are all first touched on that thread's node.
+    replicas.resize(topology_->node_count());
+    topology_->run_on_each_node(
+        [&](size_t node)
+        {
+            replicas[node] = std::make_unique<Replica>(
+                Replica{Sequence(assume_sorted, std::vector<T>(values), replica_options_, comp_)});
+        });
+    return replicas;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+auto BasicReplicatedBlockSequence<T, Compare, LockPolicy>::local_replica() const -> const Sequence&
+{
+    if (replicas_.size() == 1)
+    {
+        return replicas_.front()->sequence;
+    }
+    return replicas_[topology_->current_node()]->sequence;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+std::optional<T> BasicReplicatedBlockSequence<T, Compare, LockPolicy>::get_value(const T& value) const
+{
+    return local_replica().get_value(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicReplicatedBlockSequence<T, Compare, LockPolicy>::get_values(std::span<const T> keys,
+                                                                        std::span<std::optional<T>> results) const
+{
+    return local_replica().get_values(keys, results);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicReplicatedBlockSequence<T, Compare, LockPolicy>::get_values(std::span<const T> keys,
+                                                                        std::span<std::uint64_t> found) const
+{
+    return local_replica().get_values(keys, found);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicReplicatedBlockSequence<T, Compare, LockPolicy>::get_total_size() const
+{
+    return local_replica().get_total_size();
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicReplicatedBlockSequence<T, Compare, LockPolicy>::get_replica_count() const
+{
+    return replicas_.size();
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+SequenceStats BasicReplicatedBlockSequence<T, Compare, LockPolicy>::stats() const
+{
+    SequenceStats stats;
+    for (const auto& replica : replicas_)
+    {
+        stats.merge(replica->sequence.stats());
+    }
+    return stats;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicReplicatedBlockSequence<T, Compare, LockPolicy>::rebuild(const std::vector<T>& values, ThreadPool* pool)
+{
+    rebuild(std::vector<T>(values), pool);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicReplicatedBlockSequence<T, Compare, LockPolicy>::rebuild(std::vector<T>&& values, ThreadPool* pool)
+{
+    auto fresh = build(std::move(values), pool);
+    // Moving a sequence hands over its buffers, so the pages stay on the node that built them.
+    for (size_t node = 0; node < replicas_.size(); ++node)
+    {
+        replicas_[node]->sequence = std::move(fresh[node]->sequence);
+    }
+}
+
+template class BasicReplicatedBlockSequence<int, std::less<int>, NullMutex>;
+template class BasicReplicatedBlockSequence<int, std::less<int>, ExclusiveMutex>;
+template class BasicReplicatedBlockSequence<int, std::less<int>, std::shared_mutex>;
+template class BasicReplicatedBlockSequence<int, std::less<int>, EpochMutex>;
+
+template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+}  // namespace iterator_mutex
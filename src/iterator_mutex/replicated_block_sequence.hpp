@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+#include "numa_topology.hpp"
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+struct ReplicatedSequenceOptions
+{
+    // Applied to every replica. build_pool sorts the keys once, before they are copied out.
+    SequenceOptions sequence;
+    // One replica per NUMA node if set, a single unplaced replica otherwise.
+    bool replicate = true;
+    // The machine to replicate over, NumaTopology::system() if null. Must outlive the sequence.
+    const NumaTopology* topology = nullptr;
+};
+
+// A read-mostly sorted sequence with a full copy of its keys, layout index, lock and MRU hint
+// on every NUMA node. Each replica is built by a thread pinned to its node, so the kernel's
+// first-touch policy places all of its pages there; the replica object itself is allocated
+// there as well, so a reader's lock and hint traffic stays on its socket too. A lookup goes
+// to the replica of the node the calling thread runs on.
+//
+// No NUMA library is needed: the topology comes from sysfs and placement from CPU affinity.
+// On a single-node machine there is one replica and the only cost is the routing.
+//
+// The handle is not copyable. It is instantiated for the same key types and lock policies as
+// BasicDataBlockSequence.
+template <typename T, typename Compare = std::less<T>, typename LockPolicy = std::shared_mutex>
+class BasicReplicatedBlockSequence
+{
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using Sequence = BasicDataBlockSequence<T, Compare, LockPolicy>;
+
+    explicit BasicReplicatedBlockSequence(const std::vector<T>& values, ReplicatedSequenceOptions options = {},
+                                          const Compare& comp = Compare{});
+    explicit BasicReplicatedBlockSequence(std::vector<T>&& values, ReplicatedSequenceOptions options = {},
+                                          const Compare& comp = Compare{});
+
+    BasicReplicatedBlockSequence(const BasicReplicatedBlockSequence&) = delete;
+    BasicReplicatedBlockSequence& operator=(const BasicReplicatedBlockSequence&) = delete;
+    // Moves every replica into the replica for the same node, each under its own lock, so the
+    // pages stay where they are. Leaves other empty. Throws std::invalid_argument if the two
+    // sequences do not have the same number of replicas.
+    BasicReplicatedBlockSequence& operator=(BasicReplicatedBlockSequence&& other);
+
+    std::optional<T> get_value(const T& value) const;
+
+    // As BasicDataBlockSequence::get_values, on the replica of the calling thread's node.
+    size_t get_values(std::span<const T> keys, std::span<std::optional<T>> results) const;
+    size_t get_values(std::span<const T> keys, std::span<std::uint64_t> found) const;
+
+    size_t get_total_size() const;
+
+    size_t get_replica_count() const;
+
+    // The stats of every replica, merged.
+    SequenceStats stats() const;
+
+    // The replica lookups from the calling thread go to.
+    const Sequence& local_replica() const;
+
+    // Replaces the keys of every replica. The new replicas are built on their nodes first and
+    // then swapped in one by one, so a reader only waits for the swap of its own replica.
+    void rebuild(const std::vector<T>& values, ThreadPool* pool = nullptr);
+    void rebuild(std::vector<T>&& values, ThreadPool* pool = nullptr);
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct alignas(kCacheLineSize) Replica
+    {
+        Sequence sequence;
+    };
+
+    // Sorts values and builds one replica per node from them.
+    std::vector<std::unique_ptr<Replica>> build(std::vector<T>&& values, ThreadPool* pool) const;
+
+    [[no_unique_address]] Compare comp_;
+    SequenceOptions replica_options_;
+    const bool replicate_;
+    const NumaTopology* topology_;
+    // Indexed by node, or a single entry without replication. Never resized after construction.
+    std::vector<std::unique_ptr<Replica>> replicas_;
+};
+
+extern template class BasicReplicatedBlockSequence<int, std::less<int>, NullMutex>;
+extern template class BasicReplicatedBlockSequence<int, std::less<int>, ExclusiveMutex>;
+extern template class BasicReplicatedBlockSequence<int, std::less<int>, std::shared_mutex>;
+extern template class BasicReplicatedBlockSequence<int, std::less<int>, EpochMutex>;
+
+extern template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+extern template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+extern template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+extern template class BasicReplicatedBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+extern template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+extern template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+extern template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+extern template class BasicReplicatedBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+extern template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+extern template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+extern template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+extern template class BasicReplicatedBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+using ReplicatedBlockSequence = BasicReplicatedBlockSequence<int>;
+
+}  // namespace iterator_mutex
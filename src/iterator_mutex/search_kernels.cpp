@@ -0,0 +1,520 @@
+#include "search_kernels.hpp"
+
+#include <atomic>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ITERATOR_MUTEX_X86_KERNELS 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define ITERATOR_MUTEX_NEON_KERNELS 1
+#include <arm_neon.h>
+#endif
+
+namespace iterator_mutex
+{
+
+namespace
+{
+
+template <typename T>
+using CountLessFn = size_t (*)(const T*, size_t, T);
+
+template <typename T>
+using IntersectFn = size_t (*)(const T*, size_t, const T*, size_t, T*);
+
+// One count_less and one intersect_sorted implementation per supported key type, all for the
+// same instruction set.
+struct KernelTable
+{
+    CountLessFn<std::int32_t> i32;
+    CountLessFn<std::uint32_t> u32;
+    CountLessFn<std::int64_t> i64;
+    CountLessFn<std::uint64_t> u64;
+    IntersectFn<std::int32_t> intersect_i32;
+    IntersectFn<std::uint32_t> intersect_u32;
+    IntersectFn<std::int64_t> intersect_i64;
+    IntersectFn<std::uint64_t> intersect_u64;
+};
+
+template <typename T>
+size_t count_less_scalar(const T* keys, size_t count, T value)
+{
+    size_t less = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        less += keys[i] < value;
+    }
+    return less;
+}
+
+template <typename T>
+size_t intersect_sorted_scalar(const T* a, size_t a_count, const T* b, size_t b_count, T* out)
+{
+    // Branch-free merge: a key of a is stored before we know it matches, and kept by counting
+    // it. b only moves on once a has passed its key, so equal keys of a all find it.
+    size_t i = 0;
+    size_t j = 0;
+    size_t found = 0;
+    while (i < a_count && j < b_count)
+    {
+        const T x = a[i];
+        const T y = b[j];
+        if (out != nullptr)
+        {
+            out[found] = x;
+        }
+        found += x == y;
+        i += x <= y;
+        j += y < x;
+    }
+    return found;
+}
+
+// Finishes an intersection the vector loop stopped in: the lanes of a's current block that
+// matched an earlier block of b are in matched, and every key of b before j orders before the
+// lanes that did not. Those continue from j in the scalar merge, and so does the rest of a.
+template <typename T>
+size_t intersect_tail(const T* a, size_t a_count, const T* b, size_t b_count, T* out, size_t found,
+                      unsigned matched)
+{
+    size_t i = 0;
+    size_t j = 0;
+    for (; matched != 0 && i < a_count; ++i, matched >>= 1)
+    {
+        bool match = (matched & 1u) != 0;
+        if (!match)
+        {
+            while (j < b_count && b[j] < a[i])
+            {
+                ++j;
+            }
+            match = j < b_count && b[j] == a[i];
+        }
+        if (match)
+        {
+            if (out != nullptr)
+            {
+                out[found] = a[i];
+            }
+            ++found;
+        }
+    }
+    return found + intersect_sorted_scalar(a + i, a_count - i, b + j, b_count - j,
+                                           out != nullptr ? out + found : nullptr);
+}
+
+// Appends the lanes of block set in matched to out and returns how many there were.
+template <typename T>
+size_t emit_matches(const T* block, unsigned matched, T* out)
+{
+    if (out == nullptr)
+    {
+        return static_cast<size_t>(std::popcount(matched));
+    }
+    size_t found = 0;
+    for (; matched != 0; matched &= matched - 1)
+    {
+        out[found++] = block[std::countr_zero(matched)];
+    }
+    return found;
+}
+
+constexpr KernelTable kScalarKernels{count_less_scalar<std::int32_t>,       count_less_scalar<std::uint32_t>,
+                                     count_less_scalar<std::int64_t>,       count_less_scalar<std::uint64_t>,
+                                     intersect_sorted_scalar<std::int32_t>, intersect_sorted_scalar<std::uint32_t>,
+                                     intersect_sorted_scalar<std::int64_t>, intersect_sorted_scalar<std::uint64_t>};
+
+#if defined(ITERATOR_MUTEX_X86_KERNELS)
+
+// AVX2 only has signed compares. Flipping the sign bit of both sides maps unsigned order
+// onto signed order.
+template <typename T>
+__attribute__((target("avx2,popcnt"))) __m256i less_mask_avx2(__m256i keys, __m256i needle)
+{
+    if constexpr (sizeof(T) == 4)
+    {
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+            keys = _mm256_xor_si256(keys, sign);
+            needle = _mm256_xor_si256(needle, sign);
+        }
+        return _mm256_cmpgt_epi32(needle, keys);
+    }
+    else
+    {
+        if constexpr (std::is_unsigned_v<T>)
+        {
+            const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+            keys = _mm256_xor_si256(keys, sign);
+            needle = _mm256_xor_si256(needle, sign);
+        }
+        return _mm256_cmpgt_epi64(needle, keys);
+    }
+}
+
+template <typename T>
+__attribute__((target("avx2,popcnt"))) size_t count_less_avx2(const T* keys, size_t count, T value)
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    const __m256i needle = sizeof(T) == 4 ? _mm256_set1_epi32(static_cast<int>(value))
+                                          : _mm256_set1_epi64x(static_cast<long long>(value));
+    size_t less = 0;
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        const __m256i is_less = less_mask_avx2<T>(block, needle);
+        // Every lane's sign bit is set where the key is less. Collect them per 4 or 8 bytes.
+        const int bits = sizeof(T) == 4 ? _mm256_movemask_ps(_mm256_castsi256_ps(is_less))
+                                        : _mm256_movemask_pd(_mm256_castsi256_pd(is_less));
+        less += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+    }
+    for (; i < count; ++i)
+    {
+        less += keys[i] < value;
+    }
+    return less;
+}
+
+// Bit i of the result is set if lane i is enabled and holds a key less than needle.
+template <typename T>
+__attribute__((target("avx512f"))) unsigned less_mask_avx512(unsigned lanes, __m512i keys, __m512i needle)
+{
+    if constexpr (std::is_same_v<T, std::int32_t>)
+    {
+        return _mm512_mask_cmplt_epi32_mask(static_cast<__mmask16>(lanes), keys, needle);
+    }
+    else if constexpr (std::is_same_v<T, std::uint32_t>)
+    {
+        return _mm512_mask_cmplt_epu32_mask(static_cast<__mmask16>(lanes), keys, needle);
+    }
+    else if constexpr (std::is_same_v<T, std::int64_t>)
+    {
+        return _mm512_mask_cmplt_epi64_mask(static_cast<__mmask8>(lanes), keys, needle);
+    }
+    else
+    {
+        return _mm512_mask_cmplt_epu64_mask(static_cast<__mmask8>(lanes), keys, needle);
+    }
+}
+
+template <typename T>
+__attribute__((target("avx512f,popcnt"))) size_t count_less_avx512(const T* keys, size_t count, T value)
+{
+    constexpr size_t kLanes = 64 / sizeof(T);
+    constexpr unsigned kAllLanes = (1u << kLanes) - 1;
+    const __m512i needle = sizeof(T) == 4 ? _mm512_set1_epi32(static_cast<int>(value))
+                                          : _mm512_set1_epi64(static_cast<long long>(value));
+    size_t less = 0;
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        const __m512i block = _mm512_loadu_si512(keys + i);
+        less += static_cast<size_t>(__builtin_popcount(less_mask_avx512<T>(kAllLanes, block, needle)));
+    }
+    if (i < count)
+    {
+        // Masked-off lanes are neither loaded nor counted, so the tail needs no scalar loop.
+        const unsigned tail = (1u << (count - i)) - 1;
+        const __m512i block = sizeof(T) == 4 ? _mm512_maskz_loadu_epi32(static_cast<__mmask16>(tail), keys + i)
+                                             : _mm512_maskz_loadu_epi64(static_cast<__mmask8>(tail), keys + i);
+        less += static_cast<size_t>(__builtin_popcount(less_mask_avx512<T>(tail, block, needle)));
+    }
+    return less;
+}
+
+// Equality does not care about sign, so the signed and unsigned keys of a width share the
+// compares; only the block order is decided on T.
+template <typename T>
+__attribute__((target("avx2,popcnt"))) size_t intersect_sorted_avx2(const T* a, size_t a_count, const T* b,
+                                                                   size_t b_count, T* out)
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    size_t i = 0;
+    size_t j = 0;
+    size_t found = 0;
+    // Lanes of the block at a + i that matched a block of b so far.
+    unsigned matched = 0;
+    while (i + kLanes <= a_count && j + kLanes <= b_count)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i equal = _mm256_setzero_si256();
+        for (size_t k = 0; k < kLanes; ++k)
+        {
+            if constexpr (sizeof(T) == 4)
+            {
+                const __m256i needle = _mm256_set1_epi32(static_cast<int>(b[j + k]));
+                equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(block, needle));
+            }
+            else
+            {
+                const __m256i needle = _mm256_set1_epi64x(static_cast<long long>(b[j + k]));
+                equal = _mm256_or_si256(equal, _mm256_cmpeq_epi64(block, needle));
+            }
+        }
+        matched |= static_cast<unsigned>(sizeof(T) == 4 ? _mm256_movemask_ps(_mm256_castsi256_ps(equal))
+                                                        : _mm256_movemask_pd(_mm256_castsi256_pd(equal)));
+        // On a tie only a moves on, since more keys of a may equal b's last one.
+        if (a[i + kLanes - 1] <= b[j + kLanes - 1])
+        {
+            found += emit_matches(a + i, matched, out != nullptr ? out + found : nullptr);
+            matched = 0;
+            i += kLanes;
+        }
+        else
+        {
+            j += kLanes;
+        }
+    }
+    return intersect_tail(a + i, a_count - i, b + j, b_count - j, out, found, matched);
+}
+
+template <typename T>
+__attribute__((target("avx512f,popcnt"))) size_t intersect_sorted_avx512(const T* a, size_t a_count, const T* b,
+                                                                        size_t b_count, T* out)
+{
+    constexpr size_t kLanes = 64 / sizeof(T);
+    size_t i = 0;
+    size_t j = 0;
+    size_t found = 0;
+    unsigned matched = 0;
+    while (i + kLanes <= a_count && j + kLanes <= b_count)
+    {
+        const __m512i block = _mm512_loadu_si512(a + i);
+        for (size_t k = 0; k < kLanes; ++k)
+        {
+            if constexpr (sizeof(T) == 4)
+            {
+                matched |= _mm512_cmpeq_epi32_mask(block, _mm512_set1_epi32(static_cast<int>(b[j + k])));
+            }
+            else
+            {
+                matched |= _mm512_cmpeq_epi64_mask(block, _mm512_set1_epi64(static_cast<long long>(b[j + k])));
+            }
+        }
+        if (a[i + kLanes - 1] <= b[j + kLanes - 1])
+        {
+            found += emit_matches(a + i, matched, out != nullptr ? out + found : nullptr);
+            matched = 0;
+            i += kLanes;
+        }
+        else
+        {
+            j += kLanes;
+        }
+    }
+    return intersect_tail(a + i, a_count - i, b + j, b_count - j, out, found, matched);
+}
+
+constexpr KernelTable kAvx2Kernels{count_less_avx2<std::int32_t>,       count_less_avx2<std::uint32_t>,
+                                   count_less_avx2<std::int64_t>,       count_less_avx2<std::uint64_t>,
+                                   intersect_sorted_avx2<std::int32_t>, intersect_sorted_avx2<std::uint32_t>,
+                                   intersect_sorted_avx2<std::int64_t>, intersect_sorted_avx2<std::uint64_t>};
+constexpr KernelTable kAvx512Kernels{count_less_avx512<std::int32_t>,       count_less_avx512<std::uint32_t>,
+                                     count_less_avx512<std::int64_t>,       count_less_avx512<std::uint64_t>,
+                                     intersect_sorted_avx512<std::int32_t>, intersect_sorted_avx512<std::uint32_t>,
+                                     intersect_sorted_avx512<std::int64_t>, intersect_sorted_avx512<std::uint64_t>};
+
+#endif
+
+#if defined(ITERATOR_MUTEX_NEON_KERNELS)
+
+template <typename T>
+size_t count_less_neon(const T* keys, size_t count, T value)
+{
+    size_t less = 0;
+    size_t i = 0;
+    // A true comparison lane is all ones, i.e. -1, so subtracting it counts one.
+    if constexpr (std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t>)
+    {
+        uint32x4_t less_lanes = vdupq_n_u32(0);
+        for (; i + 4 <= count; i += 4)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                less_lanes = vsubq_u32(less_lanes, vcltq_s32(vld1q_s32(keys + i), vdupq_n_s32(value)));
+            }
+            else
+            {
+                less_lanes = vsubq_u32(less_lanes, vcltq_u32(vld1q_u32(keys + i), vdupq_n_u32(value)));
+            }
+        }
+        less = vaddvq_u32(less_lanes);
+    }
+    else
+    {
+        uint64x2_t less_lanes = vdupq_n_u64(0);
+        for (; i + 2 <= count; i += 2)
+        {
+            if constexpr (std::is_signed_v<T>)
+            {
+                less_lanes = vsubq_u64(less_lanes, vcltq_s64(vld1q_s64(keys + i), vdupq_n_s64(value)));
+            }
+            else
+            {
+                less_lanes = vsubq_u64(less_lanes, vcltq_u64(vld1q_u64(keys + i), vdupq_n_u64(value)));
+            }
+        }
+        less = vaddvq_u64(less_lanes);
+    }
+    for (; i < count; ++i)
+    {
+        less += keys[i] < value;
+    }
+    return less;
+}
+
+// Intersection takes the scalar merge: with 2 or 4 lanes the all-against-all block compare
+// does not pay for its extra compares.
+constexpr KernelTable kNeonKernels{count_less_neon<std::int32_t>,       count_less_neon<std::uint32_t>,
+                                   count_less_neon<std::int64_t>,       count_less_neon<std::uint64_t>,
+                                   intersect_sorted_scalar<std::int32_t>, intersect_sorted_scalar<std::uint32_t>,
+                                   intersect_sorted_scalar<std::int64_t>, intersect_sorted_scalar<std::uint64_t>};
+
+#endif
+
+const KernelTable* kernels_for(SearchKernel kernel)
+{
+    switch (kernel)
+    {
+#if defined(ITERATOR_MUTEX_X86_KERNELS)
+        case SearchKernel::Avx2:
+            return &kAvx2Kernels;
+        case SearchKernel::Avx512:
+            return &kAvx512Kernels;
+#endif
+#if defined(ITERATOR_MUTEX_NEON_KERNELS)
+        case SearchKernel::Neon:
+            return &kNeonKernels;
+#endif
+        default:
+            return &kScalarKernels;
+    }
+}
+
+SearchKernel detect_search_kernel()
+{
+#if defined(ITERATOR_MUTEX_X86_KERNELS)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt"))
+    {
+        return SearchKernel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+    {
+        return SearchKernel::Avx2;
+    }
+#elif defined(ITERATOR_MUTEX_NEON_KERNELS)
+    return SearchKernel::Neon;
+#endif
+    return SearchKernel::Scalar;
+}
+
+struct KernelState
+{
+    const SearchKernel detected = detect_search_kernel();
+    std::atomic<SearchKernel> active{detected};
+    std::atomic<const KernelTable*> kernels{kernels_for(detected)};
+};
+
+KernelState& kernel_state()
+{
+    static KernelState state;
+    return state;
+}
+
+const KernelTable& active_kernels()
+{
+    return *kernel_state().kernels.load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+bool is_search_kernel_supported(SearchKernel kernel)
+{
+    switch (kernel)
+    {
+        case SearchKernel::Scalar:
+            return true;
+#if defined(ITERATOR_MUTEX_X86_KERNELS)
+        case SearchKernel::Avx2:
+            return detected_search_kernel() == SearchKernel::Avx2 || detected_search_kernel() == SearchKernel::Avx512;
+        case SearchKernel::Avx512:
+            return detected_search_kernel() == SearchKernel::Avx512;
+#endif
+#if defined(ITERATOR_MUTEX_NEON_KERNELS)
+        case SearchKernel::Neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+SearchKernel detected_search_kernel()
+{
+    return kernel_state().detected;
+}
+
+SearchKernel active_search_kernel()
+{
+    return kernel_state().active.load(std::memory_order_relaxed);
+}
+
+void use_search_kernel(SearchKernel kernel)
+{
+    if (!is_search_kernel_supported(kernel))
+    {
+        kernel = SearchKernel::Scalar;
+    }
+    kernel_state().active.store(kernel, std::memory_order_relaxed);
+    kernel_state().kernels.store(kernels_for(kernel), std::memory_order_relaxed);
+}
+
+size_t count_less(const std::int32_t* keys, size_t count, std::int32_t value)
+{
+    return active_kernels().i32(keys, count, value);
+}
+
+size_t count_less(const std::uint32_t* keys, size_t count, std::uint32_t value)
+{
+    return active_kernels().u32(keys, count, value);
+}
+
+size_t count_less(const std::int64_t* keys, size_t count, std::int64_t value)
+{
+    return active_kernels().i64(keys, count, value);
+}
+
+size_t count_less(const std::uint64_t* keys, size_t count, std::uint64_t value)
+{
+    return active_kernels().u64(keys, count, value);
+}
+
+size_t intersect_sorted(const std::int32_t* a, size_t a_count, const std::int32_t* b, size_t b_count,
+                        std::int32_t* out)
+{
+    return active_kernels().intersect_i32(a, a_count, b, b_count, out);
+}
+
+size_t intersect_sorted(const std::uint32_t* a, size_t a_count, const std::uint32_t* b, size_t b_count,
+                        std::uint32_t* out)
+{
+    return active_kernels().intersect_u32(a, a_count, b, b_count, out);
+}
+
+size_t intersect_sorted(const std::int64_t* a, size_t a_count, const std::int64_t* b, size_t b_count,
+                        std::int64_t* out)
+{
+    return active_kernels().intersect_i64(a, a_count, b, b_count, out);
+}
+
+size_t intersect_sorted(const std::uint64_t* a, size_t a_count, const std::uint64_t* b, size_t b_count,
+                        std::uint64_t* out)
+{
+    return active_kernels().intersect_u64(a, a_count, b, b_count, out);
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+namespace iterator_mutex
+{
+
+// Instruction sets the search kernels can run on. The best supported one is picked at
+// startup; Scalar works everywhere and is the reference for the others.
+enum class SearchKernel
+{
+    Scalar,
+    Avx2,
+    Avx512,
+    Neon,
+};
+
+bool is_search_kernel_supported(SearchKernel kernel);
+
+// The kernel picked for this CPU at startup.
+SearchKernel detected_search_kernel();
+
+SearchKernel active_search_kernel();
+
+// Switches every search in the process to kernel, or to Scalar if it is not supported. Meant
+// for tests and benchmarks that compare kernels; lookups running at the same time may use
+// either one.
+void use_search_kernel(SearchKernel kernel);
+
+// Number of keys in keys[0, count) that are less than value. For sorted keys this is the
+// lower_bound offset, which is how the leaf and node scans use it. These run on the active
+// kernel; every other key type goes through the generic overload below.
+size_t count_less(const std::int32_t* keys, size_t count, std::int32_t value);
+size_t count_less(const std::uint32_t* keys, size_t count, std::uint32_t value);
+size_t count_less(const std::int64_t* keys, size_t count, std::int64_t value);
+size_t count_less(const std::uint64_t* keys, size_t count, std::uint64_t value);
+
+// Number of keys in a[0, a_count) that are equal to some key in b[0, b_count), both sorted
+// ascending; a key of a that occurs several times counts every time. If out is not null the
+// keys counted are written to it in order, and it must have room for a_count keys: the
+// kernels store speculatively ahead of the count. The vector kernels compare a block of a
+// with a block of b all against all, and advance whichever block ends first.
+size_t intersect_sorted(const std::int32_t* a, size_t a_count, const std::int32_t* b, size_t b_count,
+                        std::int32_t* out);
+size_t intersect_sorted(const std::uint32_t* a, size_t a_count, const std::uint32_t* b, size_t b_count,
+                        std::uint32_t* out);
+size_t intersect_sorted(const std::int64_t* a, size_t a_count, const std::int64_t* b, size_t b_count,
+                        std::int64_t* out);
+size_t intersect_sorted(const std::uint64_t* a, size_t a_count, const std::uint64_t* b, size_t b_count,
+                        std::uint64_t* out);
+
+// True for the key and comparator combinations the vector kernels above implement.
+template <typename T, typename Compare>
+inline constexpr bool has_simd_kernel_v =
+    (std::is_same_v<T, std::int32_t> || std::is_same_v<T, std::uint32_t> || std::is_same_v<T, std::int64_t> ||
+     std::is_same_v<T, std::uint64_t>) &&
+    (std::is_same_v<Compare, std::less<T>> || std::is_same_v<Compare, std::less<>>);
+
+template <typename T, typename Compare>
+size_t count_less(const T* keys, size_t count, const T& value, const Compare& comp)
+{
+    if constexpr (has_simd_kernel_v<T, Compare>)
+    {
+        return count_less(keys, count, value);
+    }
+    else
+    {
+        size_t less = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            less += comp(keys[i], value) ? 1 : 0;
+        }
+        return less;
+    }
+}
+
+template <typename T, typename Compare>
+size_t intersect_sorted(const T* a, size_t a_count, const T* b, size_t b_count, T* out, const Compare& comp)
+{
+    if constexpr (has_simd_kernel_v<T, Compare>)
+    {
+        return intersect_sorted(a, a_count, b, b_count, out);
+    }
+    else
+    {
+        // A merge that only moves past b's key once a has moved past it, so equal keys of a
+        // all find it.
+        size_t i = 0;
+        size_t j = 0;
+        size_t found = 0;
+        while (i < a_count && j < b_count)
+        {
+            if (comp(a[i], b[j]))
+            {
+                ++i;
+            }
+            else if (comp(b[j], a[i]))
+            {
+                ++j;
+            }
+            else
+            {
+                if (out != nullptr)
+                {
+                    out[found] = a[i];
+                }
+                ++found;
+                ++i;
+            }
+        }
+        return found;
+    }
+}
+
+// lower_bound over sorted data[0, n). The range is halved without branches (the compiler
+// emits conditional moves), so the search does not pay for mispredictions. Keys with a
+// vector kernel stop at a 16-key window and finish with one count_less; others halve all
+// the way down, since a linear scan costs them one full comparison per key.
+template <typename T, typename Compare = std::less<T>>
+size_t search_lower_bound(const T* data, size_t n, const T& value, const Compare& comp = Compare{})
+{
+    constexpr size_t kFinalWindow = has_simd_kernel_v<T, Compare> ? 16 : 1;
+
+    // Invariant: the answer lies in [base, base + len].
+    const T* base = data;
+    size_t len = n;
+    while (len > kFinalWindow)
+    {
+        const size_t half = len / 2;
+        base = comp(base[half - 1], value) ? base + half : base;
+        len -= half;
+    }
+    return static_cast<size_t>(base - data) + count_less(base, len, value, comp);
+}
+
+}  // namespace iterator_mutex
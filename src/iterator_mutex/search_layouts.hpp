@@ -0,0 +1,882 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "search_kernels.hpp"
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+// How a sequence finds the position of a value in its sorted blocks. Every layout keeps the
+// sorted blocks themselves, so batch walks and sizes behave the same; the non-default ones
+// add a small index of fence keys: the last key of every 16-key leaf of blocks (one cache
+// line for 4-byte keys).
+enum class Layout
+{
+    // Branch-free binary search over the sorted blocks. No extra memory, but roughly one
+    // cache miss per level once the blocks outgrow the cache.
+    Sorted,
+    // Fence keys in Eytzinger (BFS) order, padded to a perfect tree, searched without
+    // branches while prefetching four levels ahead, then one leaf scan. 1/16 to 1/8 extra memory.
+    Eytzinger,
+    // Fence keys in a static B+tree of 16-key nodes, one cache line per level, then one
+    // leaf scan. About 1/15 extra memory.
+    BTree,
+    // A piecewise-linear model of where each key sits, as in a PGM-index: it predicts the
+    // position to within an error bound epsilon, which leaves one search of 2 * epsilon + 1
+    // keys. Small levels of the same kind of model over the segments' first keys find the
+    // segment. The memory follows the keys: near-uniform ones need few segments, and each
+    // doubling of epsilon roughly quarters them. Arithmetic keys ordered by std::less only;
+    // other keys get Sorted.
+    Learned,
+};
+
+// The error bound of a Learned layout unless SequenceOptions says otherwise.
+inline constexpr size_t kDefaultLearnedEpsilon = 32;
+
+// One piece of a Learned layout's model. Keys from the segment's first key up to the next
+// segment's are predicted at position + slope * (key - first key), and never past the next
+// segment's position, which is exact.
+struct LearnedSegment
+{
+    double slope = 0.0;
+    std::uint64_t position = 0;
+};
+
+// Allocates on cache line boundaries, so a 16-int node never straddles two lines.
+template <typename T>
+class CacheAlignedAllocator
+{
+public:
+    using value_type = T;
+    static constexpr std::align_val_t kAlignment{64};
+
+    CacheAlignedAllocator() = default;
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), kAlignment));
+    }
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, kAlignment);
+    }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const noexcept
+    {
+        return true;
+    }
+};
+
+// The arrays of a BlockIndex and what is needed to search them, e.g. to write them to a file
+// and search them there later, see sequence_file.hpp.
+template <typename T>
+struct BlockIndexImage
+{
+    Layout layout = Layout::Sorted;
+    size_t leaf_count = 0;
+    unsigned eytzinger_height = 0;
+    size_t btree_top_count = 0;
+    size_t learned_epsilon = 0;
+    // Eytzinger: the tree, including the unused slot 0. BTree: the levels, leaf fences first.
+    // Learned: the first key of every segment, one section per level, bottom level first.
+    std::vector<std::span<const T>> sections;
+    // Learned: the segments of all levels, bottom level first, as many as sections has keys.
+    std::span<const LearnedSegment> learned_segments;
+};
+
+// The search structure a sequence keeps next to its sorted blocks. It only stores fence
+// keys; the blocks are the leaves and are passed back in on every search, so the index
+// stays valid when the blocks vector is moved. blocks must be sorted by comp.
+template <typename T, typename Compare = std::less<T>>
+class BlockIndex
+{
+public:
+    static constexpr size_t kLeafSize = 16;
+    // How many searches lower_bounds interleaves by default, and at most. Sixteen outstanding
+    // misses is about what one core's line fill buffers hold.
+    static constexpr size_t kDefaultInFlight = 16;
+    static constexpr size_t kMaxInFlight = 32;
+
+    BlockIndex() = default;
+
+    // Searches arrays that someone else owns, e.g. a mapped file. They must outlive the index.
+    // image must come from image() of an index over the same blocks and comparator.
+    static BlockIndex view(const BlockIndexImage<T>& image, const Compare& comp = Compare{})
+    {
+        BlockIndex index;
+        index.layout_ = image.layout;
+        index.leaf_count_ = image.leaf_count;
+        index.comp_ = comp;
+        index.eytzinger_height_ = image.eytzinger_height;
+        index.btree_top_count_ = image.btree_top_count;
+        if (image.layout == Layout::Eytzinger && !image.sections.empty())
+        {
+            index.eytzinger_ = image.sections.front();
+        }
+        else if (image.layout == Layout::BTree)
+        {
+            index.btree_levels_ = image.sections;
+        }
+        else if (image.layout == Layout::Learned)
+        {
+            index.learned_epsilon_ = image.learned_epsilon;
+            index.learned_firsts_ = image.sections;
+            size_t offset = 0;
+            for (const auto& firsts : image.sections)
+            {
+                index.learned_models_.push_back(image.learned_segments.subspan(offset, firsts.size()));
+                offset += firsts.size();
+            }
+        }
+        return index;
+    }
+
+    // True if image has the shape image() gives for an index over block_count blocks. Cheap:
+    // it only looks at the layout, the array sizes and the model, not at the keys.
+    static bool is_consistent(const BlockIndexImage<T>& image, size_t block_count)
+    {
+        const size_t leaf_count = (block_count + kLeafSize - 1) / kLeafSize;
+        if (image.leaf_count != leaf_count)
+        {
+            return false;
+        }
+        switch (image.layout)
+        {
+            case Layout::Sorted:
+                return image.sections.empty();
+            case Layout::Eytzinger:
+                if (leaf_count == 0)
+                {
+                    return image.sections.empty();
+                }
+                return image.sections.size() == 1 &&
+                       image.eytzinger_height == static_cast<unsigned>(std::bit_width(leaf_count)) &&
+                       image.sections[0].size() == (size_t{1} << image.eytzinger_height);
+            case Layout::BTree:
+            {
+                if (leaf_count == 0)
+                {
+                    return image.sections.empty();
+                }
+                size_t count = leaf_count;
+                for (size_t level = 0; level < image.sections.size(); ++level)
+                {
+                    if (image.sections[level].size() != (count + kLeafSize - 1) / kLeafSize * kLeafSize)
+                    {
+                        return false;
+                    }
+                    if (level + 1 == image.sections.size())
+                    {
+                        return count <= kLeafSize && image.btree_top_count == count;
+                    }
+                    count = (count + kLeafSize - 1) / kLeafSize;
+                }
+                return false;
+            }
+            case Layout::Learned:
+                return is_consistent_model(image, block_count);
+        }
+        return false;
+    }
+
+    // The searched arrays only ever point into the index's own storage or into memory it
+    // does not own, so moves keep them valid but a copy could not.
+    BlockIndex(const BlockIndex&) = delete;
+    BlockIndex& operator=(const BlockIndex&) = delete;
+    BlockIndex(BlockIndex&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+    BlockIndex& operator=(BlockIndex&& other) noexcept
+    {
+        layout_ = std::exchange(other.layout_, Layout::Sorted);
+        leaf_count_ = std::exchange(other.leaf_count_, 0);
+        comp_ = other.comp_;
+        eytzinger_storage_ = std::move(other.eytzinger_storage_);
+        eytzinger_ = std::exchange(other.eytzinger_, {});
+        eytzinger_height_ = std::exchange(other.eytzinger_height_, 0);
+        btree_storage_ = std::move(other.btree_storage_);
+        btree_levels_ = std::exchange(other.btree_levels_, {});
+        btree_top_count_ = std::exchange(other.btree_top_count_, 0);
+        learned_epsilon_ = std::exchange(other.learned_epsilon_, 0);
+        learned_first_storage_ = std::move(other.learned_first_storage_);
+        learned_segment_storage_ = std::move(other.learned_segment_storage_);
+        learned_firsts_ = std::exchange(other.learned_firsts_, {});
+        learned_models_ = std::exchange(other.learned_models_, {});
+        return *this;
+    }
+    // Fills the fence keys on pool's threads when one is given; the Learned model is fitted in
+    // one pass on the calling thread. learned_epsilon is the error bound of a Learned layout,
+    // at least 1.
+    BlockIndex(Layout layout, std::span<const T> blocks, const Compare& comp = Compare{}, ThreadPool* pool = nullptr,
+               size_t learned_epsilon = kDefaultLearnedEpsilon)
+        : layout_(layout), leaf_count_((blocks.size() + kLeafSize - 1) / kLeafSize), comp_(comp)
+    {
+        if (layout_ == Layout::Learned && !kLearnable)
+        {
+            layout_ = Layout::Sorted;
+        }
+        if (leaf_count_ == 0)
+        {
+            return;  // Nothing to index; the searches below check leaf_count_ first.
+        }
+
+        // Padding repeats the largest key. Like any real key it never orders after a fence on
+        // its right, so the searches need no sentinel value for T.
+        const T& pad = blocks.back();
+        if (layout_ == Layout::Eytzinger)
+        {
+            // Pad to a perfect tree so the rank of a node follows from its index alone.
+            eytzinger_height_ = static_cast<unsigned>(std::bit_width(leaf_count_));
+            const size_t nodes = (size_t{1} << eytzinger_height_) - 1;
+            eytzinger_storage_.assign(nodes + 1, pad);
+            for_each_chunk(pool, nodes,
+                           [&](size_t begin, size_t end)
+                           {
+                               for (size_t k = begin + 1; k <= end; ++k)
+                               {
+                                   const size_t rank = eytzinger_rank(k, eytzinger_height_);
+                                   if (rank < leaf_count_)
+                                   {
+                                       eytzinger_storage_[k] = fence_key(blocks, rank);
+                                   }
+                               }
+                           });
+        }
+        else if (layout_ == Layout::BTree)
+        {
+            AlignedKeys level(leaf_count_, pad);
+            for_each_chunk(pool, leaf_count_,
+                           [&](size_t begin, size_t end)
+                           {
+                               for (size_t leaf = begin; leaf < end; ++leaf)
+                               {
+                                   level[leaf] = fence_key(blocks, leaf);
+                               }
+                           });
+
+            // Each level above holds the last key of every node below, until one node is left.
+            // That is 1/16 of the keys below, so the upper levels are built inline.
+            for (;;)
+            {
+                const size_t count = level.size();
+                level.resize((count + kLeafSize - 1) / kLeafSize * kLeafSize, pad);
+                btree_storage_.push_back(level);
+                if (count <= kLeafSize)
+                {
+                    btree_top_count_ = count;
+                    break;
+                }
+
+                AlignedKeys parent;
+                for (size_t node = 0; node * kLeafSize < count; ++node)
+                {
+                    parent.push_back(level[std::min(node * kLeafSize + kLeafSize - 1, count - 1)]);
+                }
+                level = std::move(parent);
+            }
+        }
+
+        else if (layout_ == Layout::Learned)
+        {
+            build_model(blocks, std::max<size_t>(learned_epsilon, 1));
+        }
+
+        eytzinger_ = eytzinger_storage_;
+        btree_levels_.assign(btree_storage_.begin(), btree_storage_.end());
+    }
+
+    Layout layout() const
+    {
+        return layout_;
+    }
+
+    BlockIndexImage<T> image() const
+    {
+        BlockIndexImage<T> result{layout_, leaf_count_, eytzinger_height_, btree_top_count_, 0, {}, {}};
+        if (layout_ == Layout::Eytzinger && leaf_count_ > 0)
+        {
+            result.sections.push_back(eytzinger_);
+        }
+        else if (layout_ == Layout::BTree)
+        {
+            result.sections = btree_levels_;
+        }
+        else if (layout_ == Layout::Learned)
+        {
+            result.learned_epsilon = learned_epsilon_;
+            result.sections = learned_firsts_;
+            // The levels lie one after another in one array, also in a view of image().
+            if (!learned_models_.empty())
+            {
+                result.learned_segments = {learned_models_.front().data(), learned_models_.back().data() +
+                                                                               learned_models_.back().size()};
+            }
+        }
+        return result;
+    }
+
+    // Position of the first block not less than value, or blocks.size() if there is none.
+    // blocks must be the ones the index was built from.
+    size_t lower_bound(std::span<const T> blocks, const T& value) const
+    {
+        switch (layout_)
+        {
+            case Layout::Eytzinger:
+                return eytzinger_lower_bound(blocks, value);
+            case Layout::BTree:
+                return btree_lower_bound(blocks, value);
+            case Layout::Learned:
+                return learned_lower_bound(blocks, value);
+            case Layout::Sorted:
+                break;
+        }
+        return search_lower_bound(blocks.data(), blocks.size(), value, comp_);
+    }
+
+    // Calls on_result(i, lower_bound(blocks, keys[i])) for every i in order, running in_flight
+    // searches side by side. Every layout takes the same number of steps for every key, so
+    // the searches advance in lockstep: each step of one search prefetches the line its next
+    // step reads, and the other searches' steps run while it arrives. On a large sequence the
+    // cache misses of a group then overlap instead of following one another. in_flight is
+    // clamped to [1, kMaxInFlight]; 1 searches one key after the other.
+    template <typename OnResult>
+    void lower_bounds(std::span<const T> blocks, std::span<const T> keys, OnResult&& on_result,
+                      size_t in_flight = kDefaultInFlight) const
+    {
+        in_flight = std::clamp<size_t>(in_flight, 1, kMaxInFlight);
+        for (size_t first = 0; first < keys.size(); first += in_flight)
+        {
+            const auto group = keys.subspan(first, std::min(in_flight, keys.size() - first));
+            std::array<size_t, kMaxInFlight> positions;
+            if (leaf_count_ == 0)
+            {
+                positions.fill(0);
+            }
+            else
+            {
+                switch (layout_)
+                {
+                    case Layout::Sorted:
+                        sorted_lower_bounds(blocks, group, positions);
+                        break;
+                    case Layout::Eytzinger:
+                        eytzinger_lower_bounds(blocks, group, positions);
+                        break;
+                    case Layout::BTree:
+                        btree_lower_bounds(blocks, group, positions);
+                        break;
+                    case Layout::Learned:
+                        learned_lower_bounds(blocks, group, positions);
+                        break;
+                }
+            }
+            for (size_t j = 0; j < group.size(); ++j)
+            {
+                on_result(first + j, positions[j]);
+            }
+        }
+    }
+
+private:
+    using Positions = std::array<size_t, kMaxInFlight>;
+
+    using AlignedKeys = std::vector<T, CacheAlignedAllocator<T>>;
+
+    // The model needs a distance between keys that grows with their order.
+    static constexpr bool kLearnable = std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<T>>;
+    // The error bound of the levels above the bottom one. They are small, so a tight bound
+    // costs little memory and keeps each of their searches inside one or two cache lines.
+    static constexpr size_t kLearnedInnerEpsilon = 4;
+    // Keys that no line fits well, e.g. exponentially spaced ones, shrink each level only by
+    // half. Past this many levels the top one is searched outright, however large it is; every
+    // level is one section of a sequence file, which holds up to 16.
+    static constexpr size_t kLearnedMaxLevels = 8;
+
+    // Calls fn(begin, end) for consecutive chunks of [0, count), in parallel on pool if there is
+    // one. Chunks are large enough that sharing cache lines at their edges does not matter.
+    template <typename Fn>
+    static void for_each_chunk(ThreadPool* pool, size_t count, Fn&& fn)
+    {
+        constexpr size_t kChunk = size_t{1} << 16;
+        parallel_for(pool, (count + kChunk - 1) / kChunk,
+                     [&](size_t chunk) { fn(chunk * kChunk, std::min(count, (chunk + 1) * kChunk)); });
+    }
+
+    // The fence of a leaf is its last key, so the leaf holding lower_bound(value) is the first
+    // leaf whose fence is not less than value.
+    static const T& fence_key(std::span<const T> blocks, size_t leaf)
+    {
+        return blocks[std::min(leaf * kLeafSize + kLeafSize - 1, blocks.size() - 1)];
+    }
+
+    // In-order rank of Eytzinger node k in a perfect tree of the given height.
+    static size_t eytzinger_rank(size_t k, unsigned height)
+    {
+        const unsigned depth = static_cast<unsigned>(std::bit_width(k)) - 1;
+        const size_t first_at_depth = size_t{1} << depth;
+        return ((2 * (k - first_at_depth) + 1) << (height - 1 - depth)) - 1;
+    }
+
+    size_t leaf_lower_bound(std::span<const T> blocks, size_t leaf, const T& value) const
+    {
+        const size_t base = leaf * kLeafSize;
+        return base + count_less(blocks.data() + base, std::min(kLeafSize, blocks.size() - base), value, comp_);
+    }
+
+    size_t eytzinger_lower_bound(std::span<const T> blocks, const T& value) const
+    {
+        if (leaf_count_ == 0)
+        {
+            return 0;
+        }
+
+        const T* tree = eytzinger_.data();
+        const size_t nodes = eytzinger_.size() - 1;
+
+        // Every path is exactly eytzinger_height_ steps long. Node 16k is four levels below k and,
+        // for 4-byte keys, starts a cache line, so it is fetched by the time the search gets there.
+        size_t k = 1;
+        while (k <= nodes)
+        {
+            __builtin_prefetch(tree + 16 * k);
+            k = 2 * k + (comp_(tree[k], value) ? 1 : 0);
+        }
+        // Undo the trailing right turns plus the final left one to land on the answer.
+        k >>= std::countr_one(k) + 1;
+        if (k == 0)
+        {
+            return blocks.size();
+        }
+
+        const size_t leaf = eytzinger_rank(k, eytzinger_height_);
+        if (leaf >= leaf_count_)
+        {
+            return blocks.size();
+        }
+        return leaf_lower_bound(blocks, leaf, value);
+    }
+
+    size_t btree_lower_bound(std::span<const T> blocks, const T& value) const
+    {
+        if (leaf_count_ == 0)
+        {
+            return 0;
+        }
+
+        size_t top = btree_levels_.size() - 1;
+        size_t position = count_less(btree_levels_[top].data(), kLeafSize, value, comp_);
+        if (position >= btree_top_count_)
+        {
+            return blocks.size();
+        }
+
+        // Below the top the parent key guarantees that the node holds a key not less than value,
+        // so the position never runs into padding.
+        while (top-- > 0)
+        {
+            const T* node = btree_levels_[top].data() + position * kLeafSize;
+            position = position * kLeafSize + count_less(node, kLeafSize, value, comp_);
+        }
+        return leaf_lower_bound(blocks, position, value);
+    }
+
+    // How far key lies past first, as a double. Integer keys subtract in unsigned arithmetic,
+    // so even the full range of a 64-bit type does not overflow.
+    static double key_distance(const T& first, const T& key)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            using Unsigned = std::make_unsigned_t<T>;
+            const Unsigned distance = static_cast<Unsigned>(static_cast<Unsigned>(key) - static_cast<Unsigned>(first));
+            return static_cast<double>(distance);
+        }
+        else
+        {
+            return static_cast<double>(key) - static_cast<double>(first);
+        }
+    }
+
+    // Fits segments to keys with a shrinking cone: a segment starts exactly at its first key
+    // and keeps the range of slopes that predict every key after it to within epsilon. The
+    // first key that no slope in the range fits starts the next segment. Equal keys count
+    // once, at the first of them, since that is where lower_bound finds them.
+    static void fit_segments(std::span<const T> keys, size_t epsilon, AlignedKeys& firsts,
+                             std::vector<LearnedSegment>& segments)
+    {
+        const double bound = static_cast<double>(epsilon);
+        size_t start = 0;
+        double low = 0.0;
+        double high = std::numeric_limits<double>::infinity();
+        auto close = [&]
+        {
+            firsts.push_back(keys[start]);
+            segments.push_back({high == std::numeric_limits<double>::infinity() ? low : (low + high) / 2, start});
+        };
+        for (size_t i = 1; i < keys.size(); ++i)
+        {
+            if (!(keys[i - 1] < keys[i]))
+            {
+                continue;
+            }
+            const double dx = key_distance(keys[start], keys[i]);
+            const double dy = static_cast<double>(i - start);
+            const double new_low = std::max(low, (dy - bound) / dx);
+            const double new_high = std::min(high, (dy + bound) / dx);
+            if (new_low > new_high)
+            {
+                close();
+                start = i;
+                low = 0.0;
+                high = std::numeric_limits<double>::infinity();
+                continue;
+            }
+            low = new_low;
+            high = new_high;
+        }
+        close();
+    }
+
+    void build_model(std::span<const T> blocks, size_t epsilon)
+    {
+        if constexpr (kLearnable)
+        {
+            // 1. The bottom level predicts positions in the blocks.
+            learned_epsilon_ = epsilon;
+            learned_first_storage_.emplace_back();
+            std::vector<size_t> sizes;
+            fit_segments(blocks, epsilon, learned_first_storage_.back(), learned_segment_storage_);
+            sizes.push_back(learned_segment_storage_.size());
+
+            // 2. Each level above predicts positions in the first keys of the one below, until
+            //    a level is small enough to be searched outright.
+            while (learned_first_storage_.back().size() > kLeafSize &&
+                   learned_first_storage_.size() < kLearnedMaxLevels)
+            {
+                AlignedKeys firsts;
+                const size_t before = learned_segment_storage_.size();
+                fit_segments(learned_first_storage_.back(), kLearnedInnerEpsilon, firsts, learned_segment_storage_);
+                learned_first_storage_.push_back(std::move(firsts));
+                sizes.push_back(learned_segment_storage_.size() - before);
+            }
+
+            // 3. Point the searched spans at the finished storage.
+            size_t offset = 0;
+            for (size_t level = 0; level < learned_first_storage_.size(); ++level)
+            {
+                learned_firsts_.push_back(learned_first_storage_[level]);
+                learned_models_.push_back(std::span<const LearnedSegment>(learned_segment_storage_).subspan(
+                    offset, sizes[level]));
+                offset += sizes[level];
+            }
+        }
+    }
+
+    static bool is_consistent_model(const BlockIndexImage<T>& image, size_t block_count)
+    {
+        if (!kLearnable || block_count == 0)
+        {
+            return kLearnable && image.sections.empty() && image.learned_segments.empty();
+        }
+        if (image.sections.empty() || image.learned_epsilon == 0)
+        {
+            return false;
+        }
+        // Every level is no larger than the one below, and its segments start at distinct,
+        // rising positions in it, the first at 0.
+        size_t below = block_count;
+        size_t offset = 0;
+        for (const auto& firsts : image.sections)
+        {
+            if (firsts.empty() || firsts.size() > below || image.learned_segments.size() - offset < firsts.size())
+            {
+                return false;
+            }
+            for (size_t s = 0; s < firsts.size(); ++s)
+            {
+                const std::uint64_t position = image.learned_segments[offset + s].position;
+                if (position >= below || (s == 0 ? position != 0
+                                                 : position <= image.learned_segments[offset + s - 1].position))
+                {
+                    return false;
+                }
+            }
+            offset += firsts.size();
+            below = firsts.size();
+        }
+        return offset == image.learned_segments.size() &&
+               (below <= kLeafSize || image.sections.size() == kLearnedMaxLevels);
+    }
+
+    // Where segment s of a level predicts lower_bound(value) among the count keys below it.
+    size_t predict(std::span<const LearnedSegment> model, std::span<const T> firsts, size_t s, size_t count,
+                   const T& value) const
+    {
+        const LearnedSegment& segment = model[s];
+        const size_t next = s + 1 < model.size() ? static_cast<size_t>(model[s + 1].position) : count;
+        if (!comp_(firsts[s], value))
+        {
+            return static_cast<size_t>(segment.position);
+        }
+        const double predicted =
+            static_cast<double>(segment.position) + segment.slope * key_distance(firsts[s], value);
+        return predicted < static_cast<double>(next) ? static_cast<size_t>(predicted) : next;
+    }
+
+    // lower_bound(value) in keys, searching the 2 * epsilon + 1 keys around predicted first.
+    size_t window_lower_bound(std::span<const T> keys, size_t predicted, size_t epsilon, const T& value) const
+    {
+        predicted = std::min(predicted, keys.size());
+        const size_t low = predicted > epsilon ? predicted - epsilon : 0;
+        const size_t high = std::min(keys.size(), predicted + epsilon + 1);
+        const size_t position = low + search_lower_bound(keys.data() + low, high - low, value, comp_);
+
+        // The bound holds for the keys the model was fitted to. A value just past a run of
+        // equal keys, or a prediction that rounding moved, can still land outside the window,
+        // so an answer at its edge is checked against the key beyond and the rest searched.
+        if (position == low && low > 0 && !comp_(keys[low - 1], value))
+        {
+            return search_lower_bound(keys.data(), low, value, comp_);
+        }
+        if (position == high && high < keys.size() && comp_(keys[high], value))
+        {
+            return high + 1 + search_lower_bound(keys.data() + high + 1, keys.size() - high - 1, value, comp_);
+        }
+        return position;
+    }
+
+    // The segment whose keys include value: the last one that starts at or before it, or
+    // the first one if value comes before every key.
+    size_t segment_of(std::span<const T> firsts, size_t lower_bound, const T& value) const
+    {
+        if (lower_bound < firsts.size() && !comp_(value, firsts[lower_bound]))
+        {
+            return lower_bound;
+        }
+        return lower_bound == 0 ? 0 : lower_bound - 1;
+    }
+
+    size_t learned_lower_bound(std::span<const T> blocks, const T& value) const
+    {
+        if constexpr (kLearnable)
+        {
+            if (learned_firsts_.empty())
+            {
+                return 0;
+            }
+
+            // The top level is searched outright, and every level below is found from the
+            // segment above it.
+            size_t level = learned_firsts_.size() - 1;
+            const auto top = learned_firsts_[level];
+            size_t s = segment_of(top, search_lower_bound(top.data(), top.size(), value, comp_), value);
+            for (; level > 0; --level)
+            {
+                const auto below = learned_firsts_[level - 1];
+                const size_t predicted =
+                    predict(learned_models_[level], learned_firsts_[level], s, below.size(), value);
+                s = segment_of(below, window_lower_bound(below, predicted, kLearnedInnerEpsilon, value), value);
+            }
+            const size_t predicted = predict(learned_models_[0], learned_firsts_[0], s, blocks.size(), value);
+            return window_lower_bound(blocks, predicted, learned_epsilon_, value);
+        }
+        else
+        {
+            return search_lower_bound(blocks.data(), blocks.size(), value, comp_);
+        }
+    }
+
+    // The lockstep searches behind lower_bounds, one per layout. Each fills positions[j] for
+    // keys[j] and expects a non-empty index.
+    void sorted_lower_bounds(std::span<const T> blocks, std::span<const T> keys, Positions& positions) const
+    {
+        // The same halving as search_lower_bound. The range length depends only on the
+        // number of blocks, so it is shared by the whole group.
+        constexpr size_t kFinalWindow = has_simd_kernel_v<T, Compare> ? 16 : 1;
+        std::array<const T*, kMaxInFlight> base;
+        base.fill(blocks.data());
+        size_t len = blocks.size();
+        while (len > kFinalWindow)
+        {
+            const size_t half = len / 2;
+            const size_t next_half = std::max<size_t>((len - half) / 2, 1);
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                base[j] = comp_(base[j][half - 1], keys[j]) ? base[j] + half : base[j];
+                __builtin_prefetch(base[j] + next_half - 1);
+            }
+            len -= half;
+        }
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            positions[j] = static_cast<size_t>(base[j] - blocks.data()) + count_less(base[j], len, keys[j], comp_);
+        }
+    }
+
+    void eytzinger_lower_bounds(std::span<const T> blocks, std::span<const T> keys, Positions& positions) const
+    {
+        // 1. Walk the tree; every path is eytzinger_height_ steps long.
+        const T* tree = eytzinger_.data();
+        Positions k;
+        k.fill(1);
+        for (unsigned step = 0; step < eytzinger_height_; ++step)
+        {
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                k[j] = 2 * k[j] + (comp_(tree[k[j]], keys[j]) ? 1 : 0);
+                __builtin_prefetch(tree + 16 * k[j]);
+            }
+        }
+
+        // 2. Turn the final nodes into leaves and fetch the leaves for the last step.
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            const size_t node = k[j] >> (std::countr_one(k[j]) + 1);
+            k[j] = node == 0 ? leaf_count_ : eytzinger_rank(node, eytzinger_height_);
+            if (k[j] < leaf_count_)
+            {
+                __builtin_prefetch(blocks.data() + k[j] * kLeafSize);
+            }
+        }
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            positions[j] = k[j] < leaf_count_ ? leaf_lower_bound(blocks, k[j], keys[j]) : blocks.size();
+        }
+    }
+
+    void btree_lower_bounds(std::span<const T> blocks, std::span<const T> keys, Positions& positions) const
+    {
+        // 1. The top node, which every search shares. A key past its last fence is past every block.
+        const size_t top = btree_levels_.size() - 1;
+        std::array<bool, kMaxInFlight> past_end{};
+        Positions position;
+        auto fetch_child = [&](size_t level, size_t p)
+        {
+            __builtin_prefetch(level > 0 ? btree_levels_[level - 1].data() + p * kLeafSize
+                                         : blocks.data() + p * kLeafSize);
+        };
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            position[j] = count_less(btree_levels_[top].data(), kLeafSize, keys[j], comp_);
+            past_end[j] = position[j] >= btree_top_count_;
+            if (!past_end[j])
+            {
+                fetch_child(top, position[j]);
+            }
+        }
+
+        // 2. One node per level and search, each fetched by the level above.
+        for (size_t level = top; level-- > 0;)
+        {
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                if (!past_end[j])
+                {
+                    const T* node = btree_levels_[level].data() + position[j] * kLeafSize;
+                    position[j] = position[j] * kLeafSize + count_less(node, kLeafSize, keys[j], comp_);
+                    fetch_child(level, position[j]);
+                }
+            }
+        }
+        for (size_t j = 0; j < keys.size(); ++j)
+        {
+            positions[j] = past_end[j] ? blocks.size() : leaf_lower_bound(blocks, position[j], keys[j]);
+        }
+    }
+
+    void learned_lower_bounds(std::span<const T> blocks, std::span<const T> keys, Positions& positions) const
+    {
+        if constexpr (kLearnable)
+        {
+            // 1. The top level, searched outright, gives every search its first segment.
+            size_t level = learned_firsts_.size() - 1;
+            const auto top = learned_firsts_[level];
+            Positions segment;
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                segment[j] = segment_of(top, search_lower_bound(top.data(), top.size(), keys[j], comp_), keys[j]);
+            }
+
+            // 2. On every level, predict and fetch the window below for the whole group, then
+            //    search the windows, then fetch the segments they lead to.
+            Positions predicted;
+            for (; level > 0; --level)
+            {
+                const auto below = learned_firsts_[level - 1];
+                for (size_t j = 0; j < keys.size(); ++j)
+                {
+                    predicted[j] = predict(learned_models_[level], learned_firsts_[level], segment[j], below.size(),
+                                           keys[j]);
+                    __builtin_prefetch(below.data() + std::min(predicted[j], below.size() - 1));
+                }
+                for (size_t j = 0; j < keys.size(); ++j)
+                {
+                    segment[j] = segment_of(
+                        below, window_lower_bound(below, predicted[j], kLearnedInnerEpsilon, keys[j]), keys[j]);
+                    __builtin_prefetch(learned_models_[level - 1].data() + segment[j]);
+                }
+            }
+
+            // 3. The same for the blocks.
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                predicted[j] = predict(learned_models_[0], learned_firsts_[0], segment[j], blocks.size(), keys[j]);
+                __builtin_prefetch(blocks.data() + std::min(predicted[j], blocks.size() - 1));
+            }
+            for (size_t j = 0; j < keys.size(); ++j)
+            {
+                positions[j] = window_lower_bound(blocks, predicted[j], learned_epsilon_, keys[j]);
+            }
+        }
+        else
+        {
+            sorted_lower_bounds(blocks, keys, positions);
+        }
+    }
+
+    Layout layout_ = Layout::Sorted;
+    size_t leaf_count_ = 0;
+    [[no_unique_address]] Compare comp_{};
+
+    // 1-based, so the children of node k are 2k and 2k + 1. Padding nodes hold the largest key.
+    // The searches read eytzinger_, which points into eytzinger_storage_ or external memory.
+    AlignedKeys eytzinger_storage_;
+    std::span<const T> eytzinger_;
+    unsigned eytzinger_height_ = 0;
+
+    // btree_levels_[0] holds one key per leaf, every level above one key per node below.
+    // Each level is padded with the largest key to a whole number of nodes. Like eytzinger_,
+    // the levels point into btree_storage_ or external memory.
+    std::vector<AlignedKeys> btree_storage_;
+    std::vector<std::span<const T>> btree_levels_;
+    size_t btree_top_count_ = 0;
+
+    // learned_firsts_[level] holds the first key of every segment of that level and
+    // learned_models_[level] the segments, bottom level first. As above, the spans point into
+    // the storage or external memory.
+    size_t learned_epsilon_ = 0;
+    std::vector<AlignedKeys> learned_first_storage_;
+    std::vector<LearnedSegment> learned_segment_storage_;
+    std::vector<std::span<const T>> learned_firsts_;
+    std::vector<std::span<const LearnedSegment>> learned_models_;
+};
+
+}  // namespace iterator_mutex
@@ -0,0 +1,205 @@
+#include "sequence_file.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "search_layouts.hpp"
+
+namespace iterator_mutex
+{
+
+namespace
+{
+
+static_assert(std::is_trivially_copyable_v<SequenceFileHeader>);
+
+std::uint64_t align_up(std::uint64_t offset)
+{
+    return (offset + kSequenceFileAlignment - 1) / kSequenceFileAlignment * kSequenceFileAlignment;
+}
+
+[[noreturn]] void throw_errno(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+[[noreturn]] void throw_bad_file(const std::string& what)
+{
+    throw std::runtime_error("sequence file: " + what);
+}
+
+// Checks that count entries of entry_size bytes at offset lie inside the file and are aligned.
+void check_section(const SequenceFileSection& section, std::uint64_t entry_size, std::uint64_t file_size,
+                   const char* name)
+{
+    if (section.offset % kSequenceFileAlignment != 0)
+    {
+        throw_bad_file(std::string(name) + " is not aligned");
+    }
+    if (section.offset > file_size || section.count > (file_size - section.offset) / entry_size)
+    {
+        throw_bad_file(std::string(name) + " extends past the end of the file");
+    }
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw_errno("open " + path);
+    }
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0)
+    {
+        const int error = errno;
+        ::close(fd);
+        errno = error;
+        throw_errno("stat " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+
+    if (size_ > 0)
+    {
+        void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            const int error = errno;
+            ::close(fd);
+            errno = error;
+            throw_errno("mmap " + path);
+        }
+        data_ = static_cast<const std::byte*>(mapping);
+    }
+    // The mapping keeps the file alive on its own.
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+std::span<const std::byte> MappedFile::bytes() const
+{
+    return {data_, size_};
+}
+
+void write_sequence_file(const std::string& path, SequenceFileHeader header, std::span<const std::byte> keys,
+                         const std::vector<std::span<const std::byte>>& index_sections,
+                         std::span<const std::byte> learned_segments)
+{
+    if (index_sections.size() > SequenceFileHeader::kMaxIndexSections)
+    {
+        throw std::invalid_argument("write_sequence_file: too many index sections");
+    }
+
+    // Lay the arrays out one after another, each on an alignment boundary.
+    std::uint64_t offset = align_up(sizeof(SequenceFileHeader));
+    header.keys.offset = offset;
+    offset = align_up(offset + keys.size());
+    header.index_section_count = static_cast<std::uint32_t>(index_sections.size());
+    for (size_t i = 0; i < index_sections.size(); ++i)
+    {
+        header.index_sections[i].offset = offset;
+        offset = align_up(offset + index_sections[i].size());
+    }
+    header.learned_segments.offset = offset;
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw_errno("create " + temporary);
+        }
+
+        std::uint64_t written = 0;
+        auto write_at = [&](std::uint64_t at, std::span<const std::byte> bytes)
+        {
+            static constexpr std::array<char, kSequenceFileAlignment> kZeros{};
+            out.write(kZeros.data(), static_cast<std::streamsize>(at - written));
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            written = at + bytes.size();
+        };
+        write_at(0, std::as_bytes(std::span(&header, 1)));
+        write_at(header.keys.offset, keys);
+        for (size_t i = 0; i < index_sections.size(); ++i)
+        {
+            write_at(header.index_sections[i].offset, index_sections[i]);
+        }
+        write_at(header.learned_segments.offset, learned_segments);
+
+        out.flush();
+        if (!out)
+        {
+            throw_errno("write " + temporary);
+        }
+    }
+
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        const int error = errno;
+        std::remove(temporary.c_str());
+        errno = error;
+        throw_errno("rename " + temporary);
+    }
+}
+
+const SequenceFileHeader& read_sequence_file_header(const MappedFile& file, std::uint32_t key_size,
+                                                    std::uint32_t key_type)
+{
+    const auto bytes = file.bytes();
+    if (bytes.size() < sizeof(SequenceFileHeader))
+    {
+        throw_bad_file("too small for a header");
+    }
+    // mmap returns page-aligned memory, so the header can be read in place.
+    const auto& header = *reinterpret_cast<const SequenceFileHeader*>(bytes.data());
+
+    if (header.magic != SequenceFileHeader::kMagic)
+    {
+        throw_bad_file("not a sequence file");
+    }
+    if (header.byte_order != SequenceFileHeader::kByteOrder)
+    {
+        throw_bad_file("written on a machine with a different byte order");
+    }
+    if (header.version != SequenceFileHeader::kVersion)
+    {
+        throw_bad_file("unsupported version " + std::to_string(header.version));
+    }
+    if (header.key_size != key_size || header.key_type != key_type)
+    {
+        throw_bad_file("holds a different key type");
+    }
+    if (header.index_section_count > SequenceFileHeader::kMaxIndexSections)
+    {
+        throw_bad_file("too many index sections");
+    }
+
+    check_section(header.keys, key_size, bytes.size(), "keys");
+    for (std::uint32_t i = 0; i < header.index_section_count; ++i)
+    {
+        check_section(header.index_sections[i], key_size, bytes.size(), "index section");
+    }
+    check_section(header.learned_segments, sizeof(LearnedSegment), bytes.size(), "learned segments");
+    return header;
+}
+
+}  // namespace iterator_mutex
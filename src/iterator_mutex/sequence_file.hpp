@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "key_types.hpp"
+
+namespace iterator_mutex
+{
+
+// The file a sequence is saved to and mapped back from. All integers are in the byte order
+// of the machine that wrote the file, and byte_order tells a reader if that is not its own.
+//
+//   offset 0          SequenceFileHeader
+//   keys.offset       keys.count sorted keys
+//   sections[i]       index arrays, as in BlockIndexImage::sections
+//   learned_segments  the Learned layout's model, as in BlockIndexImage::learned_segments
+//
+// Every array starts on a kSequenceFileAlignment boundary, so a mapping of the file can be
+// searched in place with the same cache line layout as an index built in memory.
+struct SequenceFileSection
+{
+    std::uint64_t offset = 0;  // In bytes from the start of the file.
+    std::uint64_t count = 0;   // In keys, or in LearnedSegments for learned_segments.
+};
+
+struct SequenceFileHeader
+{
+    static constexpr std::array<char, 8> kMagic = {'I', 'M', 'S', 'E', 'Q', 'F', 'I', 'L'};
+    // Bump whenever the layout of the file or of an index changes.
+    static constexpr std::uint32_t kVersion = 2;
+    static constexpr std::uint32_t kByteOrder = 0x01020304;
+    static constexpr size_t kMaxIndexSections = 16;
+
+    std::array<char, 8> magic = kMagic;
+    std::uint32_t version = kVersion;
+    std::uint32_t byte_order = kByteOrder;
+    std::uint32_t key_size = 0;
+    std::uint32_t key_type = 0;  // See kSequenceFileKeyType; 0 for key types without a tag.
+    std::uint32_t layout = 0;
+    std::uint32_t eytzinger_height = 0;
+    std::uint64_t leaf_count = 0;
+    std::uint64_t btree_top_count = 0;
+    SequenceFileSection keys;
+    std::uint32_t index_section_count = 0;
+    std::uint32_t reserved = 0;
+    std::array<SequenceFileSection, kMaxIndexSections> index_sections{};
+    SequenceFileSection learned_segments;
+    std::uint64_t learned_epsilon = 0;
+};
+
+inline constexpr size_t kSequenceFileAlignment = 64;
+
+// Tags the key types the library instantiates, so a file is not opened as the wrong type of
+// the same size.
+template <typename T>
+inline constexpr std::uint32_t kSequenceFileKeyType = 0;
+template <>
+inline constexpr std::uint32_t kSequenceFileKeyType<std::int32_t> = 1;
+template <>
+inline constexpr std::uint32_t kSequenceFileKeyType<std::int64_t> = 2;
+template <>
+inline constexpr std::uint32_t kSequenceFileKeyType<std::uint64_t> = 3;
+template <>
+inline constexpr std::uint32_t kSequenceFileKeyType<CompositeKey> = 4;
+
+// A whole file mapped read-only and shared, so every process that maps the same file shares
+// its page cache pages. Throws std::system_error if the file cannot be opened or mapped.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const std::byte> bytes() const;
+
+private:
+    const std::byte* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Writes header and the arrays it describes to path. The offsets in header are filled in
+// here; keys, index_sections and learned_segments hold the bytes of header.keys,
+// header.index_sections and header.learned_segments.
+// The file is written next to path and renamed over it, so readers never map a partial
+// file. Throws std::system_error on I/O errors.
+void write_sequence_file(const std::string& path, SequenceFileHeader header, std::span<const std::byte> keys,
+                         const std::vector<std::span<const std::byte>>& index_sections,
+                         std::span<const std::byte> learned_segments = {});
+
+// Checks that file holds a sequence of key_size-byte keys of the given type and that every
+// array the header describes lies inside the file and is aligned. Returns the header, which
+// lives in the mapping. Throws std::runtime_error otherwise.
+const SequenceFileHeader& read_sequence_file_header(const MappedFile& file, std::uint32_t key_size,
+                                                    std::uint32_t key_type);
+
+}  // namespace iterator_mutex
@@ -0,0 +1,206 @@
+#include "sequence_stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#include "thread_slot.hpp"
+
+namespace iterator_mutex
+{
+
+size_t LatencyHistogram::bucket_of(std::uint64_t value)
+{
+    if (value < kSubBuckets)
+    {
+        return static_cast<size_t>(value);
+    }
+    const size_t exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+    if (exponent > kMaxExponent)
+    {
+        return kBucketCount - 1;
+    }
+    // The sub-bucket is given by the kSubBucketBits bits below the leading one.
+    const size_t sub_bucket = static_cast<size_t>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::bucket_lower_bound(size_t bucket)
+{
+    if (bucket < kSubBuckets)
+    {
+        return bucket;
+    }
+    const size_t exponent = bucket / kSubBuckets - 1 + kSubBucketBits;
+    const std::uint64_t sub_bucket = bucket % kSubBuckets;
+    return (kSubBuckets + sub_bucket) << (exponent - kSubBucketBits);
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(size_t bucket)
+{
+    if (bucket + 1 >= kBucketCount)
+    {
+        return UINT64_MAX;
+    }
+    return bucket_lower_bound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value, std::uint64_t count)
+{
+    add_bucket(bucket_of(value), count, value * count);
+}
+
+void LatencyHistogram::add_bucket(size_t bucket, std::uint64_t count, std::uint64_t sum)
+{
+    buckets_[bucket] += count;
+    count_ += count;
+    sum_ += sum;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket)
+    {
+        buckets_[bucket] += other.buckets_[bucket];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+    return count_;
+}
+
+std::uint64_t LatencyHistogram::sum() const
+{
+    return sum_;
+}
+
+double LatencyHistogram::mean() const
+{
+    return count_ == 0 ? 0.0 : static_cast<double>(sum_) / static_cast<double>(count_);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const
+{
+    if (count_ == 0)
+    {
+        return 0;
+    }
+    // The rank of the q-quantile, counting from 1, so q = 0 is the smallest value.
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count_))));
+    std::uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket)
+    {
+        seen += buckets_[bucket];
+        if (seen >= rank)
+        {
+            return bucket_upper_bound(bucket);
+        }
+    }
+    return bucket_upper_bound(kBucketCount - 1);
+}
+
+std::uint64_t LatencyHistogram::bucket_count(size_t bucket) const
+{
+    return buckets_.at(bucket);
+}
+
+void SequenceStats::merge(const SequenceStats& other)
+{
+    lookups += other.lookups;
+    lookup_hits += other.lookup_hits;
+    position_queries += other.position_queries;
+    range_queries += other.range_queries;
+    batch_lookups += other.batch_lookups;
+    batch_keys += other.batch_keys;
+    batch_hits += other.batch_hits;
+    hints.exact_hits += other.hints.exact_hits;
+    hints.hot_key_hits += other.hints.hot_key_hits;
+    hints.near_hits += other.hints.near_hits;
+    hints.misses += other.hints.misses;
+    contended_locks += other.contended_locks;
+    moves += other.moves;
+    filter_rejections += other.filter_rejections;
+    shared_lock_wait.merge(other.shared_lock_wait);
+    exclusive_lock_wait.merge(other.exclusive_lock_wait);
+    move_hold.merge(other.move_hold);
+    finger_steps.merge(other.finger_steps);
+}
+
+BasicStatsRecorder<true>::BasicStatsRecorder() : shards_(std::make_unique<Shard[]>(kShards))
+{
+}
+
+auto BasicStatsRecorder<true>::shard() const -> Shard&
+{
+    return shards_[this_thread_slot() % kShards];
+}
+
+void BasicStatsRecorder<true>::add(StatCounter counter, std::uint64_t n) const
+{
+    shard().counters[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void BasicStatsRecorder<true>::record(StatHistogram histogram, std::uint64_t value) const
+{
+    Shard& s = shard();
+    const auto h = static_cast<size_t>(histogram);
+    s.buckets[h][LatencyHistogram::bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    s.sums[h].fetch_add(value, std::memory_order_relaxed);
+}
+
+SequenceStats BasicStatsRecorder<true>::snapshot() const
+{
+    // 1. Sum the shards. Updates racing with this are either in or out; each value is exact
+    //    on its own, but the values are not a consistent cut across counters.
+    std::array<std::uint64_t, kCounters> counters{};
+    std::array<LatencyHistogram, kHistograms> histograms{};
+    for (size_t i = 0; i < kShards; ++i)
+    {
+        const Shard& s = shards_[i];
+        for (size_t c = 0; c < kCounters; ++c)
+        {
+            counters[c] += s.counters[c].load(std::memory_order_relaxed);
+        }
+        for (size_t h = 0; h < kHistograms; ++h)
+        {
+            for (size_t bucket = 0; bucket < LatencyHistogram::kBucketCount; ++bucket)
+            {
+                if (const std::uint64_t count = s.buckets[h][bucket].load(std::memory_order_relaxed))
+                {
+                    histograms[h].add_bucket(bucket, count, 0);
+                }
+            }
+            histograms[h].add_bucket(0, 0, s.sums[h].load(std::memory_order_relaxed));
+        }
+    }
+
+    // 2. Lay them out by name.
+    auto counter = [&](StatCounter c) { return counters[static_cast<size_t>(c)]; };
+    auto histogram = [&](StatHistogram h) { return histograms[static_cast<size_t>(h)]; };
+    SequenceStats stats;
+    stats.lookups = counter(StatCounter::Lookups);
+    stats.lookup_hits = counter(StatCounter::LookupHits);
+    stats.position_queries = counter(StatCounter::PositionQueries);
+    stats.range_queries = counter(StatCounter::RangeQueries);
+    stats.batch_lookups = counter(StatCounter::BatchLookups);
+    stats.batch_keys = counter(StatCounter::BatchKeys);
+    stats.batch_hits = counter(StatCounter::BatchHits);
+    stats.hints.exact_hits = counter(StatCounter::ExactHits);
+    stats.hints.hot_key_hits = counter(StatCounter::HotKeyHits);
+    stats.hints.near_hits = counter(StatCounter::NearHits);
+    stats.hints.misses = counter(StatCounter::Misses);
+    stats.contended_locks = counter(StatCounter::ContendedLocks);
+    stats.moves = counter(StatCounter::Moves);
+    stats.filter_rejections = counter(StatCounter::FilterRejections);
+    stats.shared_lock_wait = histogram(StatHistogram::SharedLockWait);
+    stats.exclusive_lock_wait = histogram(StatHistogram::ExclusiveLockWait);
+    stats.move_hold = histogram(StatHistogram::MoveHold);
+    stats.finger_steps = histogram(StatHistogram::FingerSteps);
+    return stats;
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace iterator_mutex
+{
+
+// Whether sequences collect SequenceStats. Set by configuring with -DITERATOR_MUTEX_STATS=ON,
+// which defines ITERATOR_MUTEX_STATS for the library and everything that links it. Without
+// it the recorder is an empty member and every call to it compiles to nothing.
+#if defined(ITERATOR_MUTEX_STATS)
+inline constexpr bool kStatsEnabled = true;
+#else
+inline constexpr bool kStatsEnabled = false;
+#endif
+
+// How lookups that use the MRU hint were answered, see SequenceOptions::hint_stats.
+struct HintStats
+{
+    std::uint64_t exact_hits = 0;    // By the key at the hint: a repeat of the same key.
+    std::uint64_t hot_key_hits = 0;  // By the hot-key cache, see SequenceOptions::hot_keys.
+    std::uint64_t near_hits = 0;     // By the finger search, within reach of its start.
+    std::uint64_t misses = 0;        // By a search of the layout from the top.
+};
+
+// A log-linear histogram in the style of HdrHistogram: values below 8 have a bucket each, and
+// every power of two above is split into 8 buckets, so a bucket is at most 12.5% wide. Values
+// from 2^40 on, over 18 minutes in nanoseconds, share the last bucket.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+    static constexpr size_t kMaxExponent = 40;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    static size_t bucket_of(std::uint64_t value);
+    // The smallest and largest value that fall into bucket.
+    static std::uint64_t bucket_lower_bound(size_t bucket);
+    static std::uint64_t bucket_upper_bound(size_t bucket);
+
+    void record(std::uint64_t value, std::uint64_t count = 1);
+    // Adds count values known only by their bucket, whose sum is sum.
+    void add_bucket(size_t bucket, std::uint64_t count, std::uint64_t sum);
+    void merge(const LatencyHistogram& other);
+
+    std::uint64_t count() const;
+    std::uint64_t sum() const;
+    // 0 if empty.
+    double mean() const;
+    // The upper bound of the bucket holding the q-quantile, q in [0, 1]; 0 if empty.
+    std::uint64_t percentile(double q) const;
+    std::uint64_t bucket_count(size_t bucket) const;
+
+private:
+    std::array<std::uint64_t, kBucketCount> buckets_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+};
+
+// What a sequence did over its lifetime, summed over all threads. Built by
+// DataBlockSequence::stats() and its counterparts in the wrappers.
+struct SequenceStats
+{
+    std::uint64_t lookups = 0;           // get_value calls.
+    std::uint64_t lookup_hits = 0;       // Of those, the ones that found their key.
+    std::uint64_t position_queries = 0;  // find_index and lower_bound calls.
+    std::uint64_t range_queries = 0;     // count_range, get_range and for_each_in_range calls.
+    std::uint64_t batch_lookups = 0;     // get_values calls.
+    std::uint64_t batch_keys = 0;        // Keys passed to them.
+    std::uint64_t batch_hits = 0;        // Of those, the ones found.
+    // How the single-key queries were answered, as with SequenceOptions::hint_stats.
+    HintStats hints;
+    std::uint64_t contended_locks = 0;  // Shared acquisitions that could not take the lock at once.
+    std::uint64_t moves = 0;            // Move constructions and assignments into this sequence.
+    // get_value and find_index calls the key filter answered without taking the lock, see
+    // SequenceOptions::filter_bits_per_key.
+    std::uint64_t filter_rejections = 0;
+
+    // Nanoseconds readers waited for the lock, for the contended acquisitions only; an
+    // uncontended one costs no clock reads.
+    LatencyHistogram shared_lock_wait;
+    // Nanoseconds a move waited for both locks.
+    LatencyHistogram exclusive_lock_wait;
+    // Nanoseconds a move held the locks, which is how long it blocked readers.
+    LatencyHistogram move_hold;
+    // Galloping steps per finger search, a measure of how far lookups land from their hint.
+    LatencyHistogram finger_steps;
+
+    void merge(const SequenceStats& other);
+};
+
+enum class StatCounter : size_t
+{
+    Lookups,
+    LookupHits,
+    PositionQueries,
+    RangeQueries,
+    BatchLookups,
+    BatchKeys,
+    BatchHits,
+    // In the order of the HintStats fields.
+    ExactHits,
+    HotKeyHits,
+    NearHits,
+    Misses,
+    ContendedLocks,
+    Moves,
+    FilterRejections,
+    Count,
+};
+
+enum class StatHistogram : size_t
+{
+    SharedLockWait,
+    ExclusiveLockWait,
+    MoveHold,
+    FingerSteps,
+    Count,
+};
+
+// Collects the stats of one sequence. Counters and histograms are sharded by thread slot,
+// each shard on cache lines of its own, and updated with relaxed atomics, so threads
+// recording at the same time rarely touch the same line.
+template <bool Enabled>
+class BasicStatsRecorder;
+
+template <>
+class BasicStatsRecorder<true>
+{
+public:
+    BasicStatsRecorder();
+
+    BasicStatsRecorder(const BasicStatsRecorder&) = delete;
+    BasicStatsRecorder& operator=(const BasicStatsRecorder&) = delete;
+
+    void add(StatCounter counter, std::uint64_t n = 1) const;
+    void record(StatHistogram histogram, std::uint64_t value) const;
+
+    SequenceStats snapshot() const;
+
+private:
+    static constexpr size_t kShards = 8;
+    static constexpr size_t kCounters = static_cast<size_t>(StatCounter::Count);
+    static constexpr size_t kHistograms = static_cast<size_t>(StatHistogram::Count);
+
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<std::uint64_t>, kCounters> counters{};
+        std::array<std::array<std::atomic<std::uint64_t>, LatencyHistogram::kBucketCount>, kHistograms> buckets{};
+        std::array<std::atomic<std::uint64_t>, kHistograms> sums{};
+    };
+
+    Shard& shard() const;
+
+    std::unique_ptr<Shard[]> shards_;
+};
+
+// Compiled out: no state, and nothing to call.
+template <>
+class BasicStatsRecorder<false>
+{
+public:
+    void add(StatCounter, std::uint64_t = 1) const
+    {
+    }
+    void record(StatHistogram, std::uint64_t) const
+    {
+    }
+
+    SequenceStats snapshot() const
+    {
+        return {};
+    }
+};
+
+using StatsRecorder = BasicStatsRecorder<kStatsEnabled>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "search_kernels.hpp"
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+namespace detail
+{
+
+// Past this ratio of sizes an intersection gallops through the larger range from each key of
+// the smaller one, in O(small * log(large / small)), instead of merging the two.
+inline constexpr size_t kGallopRatio = 32;
+
+// Keys an input part of a parallel set operation has to hold at least, summed over every
+// range, before the work is worth splitting.
+inline constexpr size_t kSetOperationMinPart = size_t{1} << 16;
+
+// The first position in [first, n) whose key does not satisfy pred, for a pred that holds on
+// a prefix of data. Gallops from first, so it costs O(log d) for an answer d positions away.
+template <typename T, typename Pred>
+size_t gallop(const T* data, size_t first, size_t n, Pred pred)
+{
+    // Invariant: pred holds before lo, and fails at hi unless hi is n.
+    size_t lo = first;
+    size_t hi = first;
+    for (size_t step = 1; hi < n && pred(data[hi]); step *= 2)
+    {
+        lo = hi + 1;
+        hi = std::min(lo + step, n);
+    }
+    while (lo < hi)
+    {
+        const size_t middle = lo + (hi - lo) / 2;
+        if (pred(data[middle]))
+        {
+            lo = middle + 1;
+        }
+        else
+        {
+            hi = middle;
+        }
+    }
+    return lo;
+}
+
+// The keys of a that are equivalent to some key of b, both sorted by comp, counted and, if
+// out is not null, written to it in order. out needs room for a.size() keys.
+template <typename T, typename Compare>
+size_t intersect_ranges(std::span<const T> a, std::span<const T> b, T* out, const Compare& comp)
+{
+    size_t found = 0;
+    if (a.size() * kGallopRatio < b.size())
+    {
+        // 1. a is small: look each of its keys up in b, from where the previous one was.
+        size_t j = 0;
+        for (const T& key : a)
+        {
+            j = gallop(b.data(), j, b.size(), [&](const T& x) { return comp(x, key); });
+            if (j < b.size() && !comp(key, b[j]))
+            {
+                if (out != nullptr)
+                {
+                    out[found] = key;
+                }
+                ++found;
+            }
+        }
+    }
+    else if (b.size() * kGallopRatio < a.size())
+    {
+        // 2. b is small: find the run of a equivalent to each of its keys. b's repeats of a
+        //    key find the run already consumed.
+        size_t i = 0;
+        for (const T& key : b)
+        {
+            i = gallop(a.data(), i, a.size(), [&](const T& x) { return comp(x, key); });
+            const size_t run_end = gallop(a.data(), i, a.size(), [&](const T& x) { return !comp(key, x); });
+            if (out != nullptr)
+            {
+                std::copy(a.begin() + i, a.begin() + run_end, out + found);
+            }
+            found += run_end - i;
+            i = run_end;
+        }
+    }
+    else
+    {
+        // 3. Comparable sizes: one merge over both, vectorized where a kernel exists.
+        found = intersect_sorted(a.data(), a.size(), b.data(), b.size(), out, comp);
+    }
+    return found;
+}
+
+// Every key of the ranges, as many times as the range holding it most often has it, written
+// to out in order, and the number written. out needs room for all keys of all ranges.
+//
+// That union is associative, so more than two ranges are merged as a balanced tree of
+// std::set_union: each half into a scratch buffer, then the two halves into out. The log k
+// streaming passes beat one pass that pays a heap operation on every key.
+template <typename T, typename Compare>
+size_t union_ranges(std::span<const std::span<const T>> ranges, T* out, const Compare& comp)
+{
+    if (ranges.empty())
+    {
+        return 0;
+    }
+    if (ranges.size() == 1)
+    {
+        return static_cast<size_t>(std::copy(ranges[0].begin(), ranges[0].end(), out) - out);
+    }
+    if (ranges.size() == 2)
+    {
+        return static_cast<size_t>(std::set_union(ranges[0].begin(), ranges[0].end(), ranges[1].begin(),
+                                                  ranges[1].end(), out, comp) -
+                                   out);
+    }
+
+    std::vector<T> halves[2];
+    const size_t middle = ranges.size() / 2;
+    const std::span<const std::span<const T>> parts[] = {ranges.first(middle), ranges.subspan(middle)};
+    for (size_t h = 0; h < 2; ++h)
+    {
+        size_t size = 0;
+        for (const auto& range : parts[h])
+        {
+            size += range.size();
+        }
+        halves[h].resize(size);
+        halves[h].resize(union_ranges(parts[h], halves[h].data(), comp));
+    }
+    return static_cast<size_t>(
+        std::set_union(halves[0].begin(), halves[0].end(), halves[1].begin(), halves[1].end(), out, comp) - out);
+}
+
+// Runs op(parts, out_offset) on parts of the ranges that hold the same keys: part p of range
+// k is [bounds[p][k], bounds[p + 1][k]), and out_offset is the sum of the sizes of the parts
+// before it in the first output_ranges ranges. Part boundaries are the keys of ranges[pivot]
+// at evenly spaced positions, each found in every range with lower_bound, so equivalent keys
+// always fall in one part. The parts run on pool; with fewer than kSetOperationMinPart keys
+// per part there is one. op returns what it wrote at out_offset, and the parts' output is
+// then moved together, if out is not null. Returns the number of keys written or counted.
+template <typename T, typename Compare, typename Op>
+size_t partitioned(std::span<const std::span<const T>> ranges, size_t output_ranges, size_t pivot, T* out,
+                   const Compare& comp, ThreadPool* pool, Op&& op)
+{
+    size_t total = 0;
+    for (const auto& range : ranges)
+    {
+        total += range.size();
+    }
+    const size_t threads = pool != nullptr ? pool->size() + 1 : 1;
+    const size_t part_count = std::max<size_t>(1, std::min(threads, total / kSetOperationMinPart));
+
+    // 1. Cut every range at the same keys.
+    const std::span<const T> cuts = ranges[pivot];
+    std::vector<std::vector<size_t>> bounds(part_count + 1, std::vector<size_t>(ranges.size()));
+    for (size_t k = 0; k < ranges.size(); ++k)
+    {
+        bounds[part_count][k] = ranges[k].size();
+    }
+    for (size_t p = 1; p < part_count; ++p)
+    {
+        const T& cut = cuts[cuts.size() * p / part_count];
+        for (size_t k = 0; k < ranges.size(); ++k)
+        {
+            bounds[p][k] = search_lower_bound(ranges[k].data(), ranges[k].size(), cut, comp);
+        }
+    }
+
+    // 2. Run the parts, each writing where its input would start in a concatenation.
+    std::vector<size_t> offsets(part_count);
+    std::vector<size_t> written(part_count);
+    for (size_t p = 0; p < part_count; ++p)
+    {
+        for (size_t k = 0; k < output_ranges; ++k)
+        {
+            offsets[p] += bounds[p][k];
+        }
+    }
+    parallel_for(pool, part_count,
+                 [&](size_t p)
+                 {
+                     std::vector<std::span<const T>> parts(ranges.size());
+                     for (size_t k = 0; k < ranges.size(); ++k)
+                     {
+                         parts[k] = ranges[k].subspan(bounds[p][k], bounds[p + 1][k] - bounds[p][k]);
+                     }
+                     written[p] = op(std::span<const std::span<const T>>(parts), offsets[p]);
+                 });
+
+    // 3. Close the gaps. Every part moves towards the front, so a forward copy is safe.
+    size_t count = 0;
+    for (size_t p = 0; p < part_count; ++p)
+    {
+        if (out != nullptr && count != offsets[p])
+        {
+            std::copy(out + offsets[p], out + offsets[p] + written[p], out + count);
+        }
+        count += written[p];
+    }
+    return count;
+}
+
+}  // namespace detail
+
+}  // namespace iterator_mutex
@@ -0,0 +1,240 @@
+#include "sharded_block_sequence.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "parallel_sort.hpp"
+
+namespace iterator_mutex
+{
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicShardedBlockSequence<T, Compare, LockPolicy>::BasicShardedBlockSequence(const std::vector<T>& values,
+                                                                            ShardedSequenceOptions options,
+                                                                            const Compare& comp)
+    : BasicShardedBlockSequence(std::vector<T>(values), options, comp)
+{
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+BasicShardedBlockSequence<T, Compare, LockPolicy>::BasicShardedBlockSequence(std::vector<T>&& values,
+                                                                            ShardedSequenceOptions options,
+                                                                            const Compare& comp)
+    : comp_(comp), shard_options_(options.sequence)
+{
+    ThreadPool* pool = shard_options_.build_pool;
+    // The pool splits the work across shards, so every shard is built single-threaded.
+    shard_options_.build_pool = nullptr;
+
+    // 1. Sort, and take every shard's first key as a fence. A fence that would not be greater
+    //    than the one before it, e.g. inside a run of equal keys, is skipped.
+    parallel_sort(values, comp_, pool);
+    const size_t shard_count = std::max<size_t>(1, options.shard_count);
+    for (size_t i = 1; i < shard_count && !values.empty(); ++i)
+    {
+        const T& candidate = values[i * values.size() / shard_count];
+        if (comp_(fences_.empty() ? values.front() : fences_.back(), candidate))
+        {
+            fences_.push_back(candidate);
+        }
+    }
+
+    // 2. Build the shards side by side.
+    auto runs = split(std::move(values));
+    std::vector<std::optional<Sequence>> built(runs.size());
+    parallel_for(pool, runs.size(),
+                 [&](size_t i) { built[i].emplace(assume_sorted, std::move(runs[i]), shard_options_, comp_); });
+
+    shards_.reserve(built.size());
+    for (auto& sequence : built)
+    {
+        shards_.push_back(Shard{std::move(*sequence)});
+    }
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::shard_index(const T& value) const
+{
+    return static_cast<size_t>(std::upper_bound(fences_.begin(), fences_.end(), value, comp_) - fences_.begin());
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+std::vector<std::vector<T>> BasicShardedBlockSequence<T, Compare, LockPolicy>::split(
+    std::vector<T>&& sorted_keys) const
+{
+    std::vector<std::vector<T>> runs;
+    if (fences_.empty())
+    {
+        runs.push_back(std::move(sorted_keys));
+        return runs;
+    }
+
+    runs.reserve(fences_.size() + 1);
+    auto first = sorted_keys.cbegin();
+    for (const T& fence : fences_)
+    {
+        const auto last = std::lower_bound(first, sorted_keys.cend(), fence, comp_);
+        runs.emplace_back(first, last);
+        first = last;
+    }
+    runs.emplace_back(first, sorted_keys.cend());
+    return runs;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+std::optional<T> BasicShardedBlockSequence<T, Compare, LockPolicy>::get_value(const T& value) const
+{
+    return shards_[shard_index(value)].sequence.get_value(value);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::get_values(std::span<const T> keys,
+                                                                     std::span<std::optional<T>> results) const
+{
+    if (results.size() < keys.size())
+    {
+        throw std::invalid_argument("get_values: results is smaller than keys");
+    }
+
+    std::fill_n(results.begin(), keys.size(), std::nullopt);
+    return lookup_batch(keys, [&](size_t i) { results[i] = keys[i]; });
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::get_values(std::span<const T> keys,
+                                                                     std::span<std::uint64_t> found) const
+{
+    const size_t words = (keys.size() + 63) / 64;
+    if (found.size() < words)
+    {
+        throw std::invalid_argument("get_values: found bitmap is smaller than keys");
+    }
+
+    std::fill_n(found.begin(), words, 0);
+    return lookup_batch(keys, [&](size_t i) { found[i / 64] |= std::uint64_t{1} << (i % 64); });
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+template <typename OnFound>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::lookup_batch(std::span<const T> keys,
+                                                                       OnFound&& on_found) const
+{
+    // 1. Count the keys of every shard, then group them with a stable counting sort, so a
+    //    sorted batch stays sorted within each shard and keeps the shard's merge walk.
+    std::vector<size_t> starts(shards_.size() + 1, 0);
+    std::vector<std::uint32_t> shard_of(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        shard_of[i] = static_cast<std::uint32_t>(shard_index(keys[i]));
+        ++starts[shard_of[i] + 1];
+    }
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        starts[s + 1] += starts[s];
+    }
+
+    std::vector<size_t> order(keys.size());
+    std::vector<size_t> next(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        order[next[shard_of[i]]++] = i;
+    }
+    std::vector<T> grouped;
+    grouped.reserve(keys.size());
+    for (size_t i : order)
+    {
+        grouped.push_back(keys[i]);
+    }
+
+    // 2. One batch per shard, mapped back to the caller's positions.
+    size_t hits = 0;
+    std::vector<std::uint64_t> bits((keys.size() + 63) / 64);
+    for (size_t s = 0; s < shards_.size(); ++s)
+    {
+        const size_t count = starts[s + 1] - starts[s];
+        if (count == 0)
+        {
+            continue;
+        }
+        const auto shard_bits = std::span(bits).first((count + 63) / 64);
+        hits += shards_[s].sequence.get_values(std::span<const T>(grouped).subspan(starts[s], count), shard_bits);
+        for (size_t w = 0; w < shard_bits.size(); ++w)
+        {
+            for (std::uint64_t word = shard_bits[w]; word != 0; word &= word - 1)
+            {
+                on_found(order[starts[s] + w * 64 + static_cast<size_t>(std::countr_zero(word))]);
+            }
+        }
+    }
+    return hits;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::get_total_size() const
+{
+    size_t size = 0;
+    for (const Shard& shard : shards_)
+    {
+        size += shard.sequence.get_total_size();
+    }
+    return size;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+size_t BasicShardedBlockSequence<T, Compare, LockPolicy>::get_shard_count() const
+{
+    return shards_.size();
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+SequenceStats BasicShardedBlockSequence<T, Compare, LockPolicy>::stats() const
+{
+    SequenceStats stats;
+    for (const Shard& shard : shards_)
+    {
+        stats.merge(shard.sequence.stats());
+    }
+    return stats;
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicShardedBlockSequence<T, Compare, LockPolicy>::rebuild(const std::vector<T>& values, ThreadPool* pool)
+{
+    rebuild(std::vector<T>(values), pool);
+}
+
+template <typename T, typename Compare, typename LockPolicy>
+void BasicShardedBlockSequence<T, Compare, LockPolicy>::rebuild(std::vector<T>&& values, ThreadPool* pool)
+{
+    parallel_sort(values, comp_, pool);
+    auto runs = split(std::move(values));
+
+    // Build each shard before taking its lock; the move assignment holds it only for the swap.
+    parallel_for(pool, runs.size(),
+                 [&](size_t i)
+                 { shards_[i].sequence = Sequence(assume_sorted, std::move(runs[i]), shard_options_, comp_); });
+}
+
+template class BasicShardedBlockSequence<int, std::less<int>, NullMutex>;
+template class BasicShardedBlockSequence<int, std::less<int>, ExclusiveMutex>;
+template class BasicShardedBlockSequence<int, std::less<int>, std::shared_mutex>;
+template class BasicShardedBlockSequence<int, std::less<int>, EpochMutex>;
+
+template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+struct ShardedSequenceOptions
+{
+    // Partitions to split the keys into. Fewer are used if there are fewer distinct keys.
+    size_t shard_count = 16;
+    // Applied to every shard. build_pool sorts the keys and builds the shards side by side.
+    SequenceOptions sequence;
+};
+
+// A sorted sequence split into range partitions, each a BasicDataBlockSequence with its own
+// lock and MRU hint. A lookup picks its shard from a small array of fences, the first key of
+// every shard but the first, and searches only that shard. Readers of different shards
+// never touch the same lock or hint, and every shard starts on its own cache line, so
+// lookups scale with the shard count instead of contending on one lock word.
+//
+// The shards hold roughly equal numbers of keys when built. rebuild() replaces the keys
+// one shard at a time under the existing fences, so a reader only waits for the rebuild of
+// its own shard. The fences never change after construction; build a new sequence to
+// rebalance.
+//
+// The handle is neither copyable nor movable. It is instantiated for the same key types
+// and lock policies as BasicDataBlockSequence.
+template <typename T, typename Compare = std::less<T>, typename LockPolicy = std::shared_mutex>
+class BasicShardedBlockSequence
+{
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using Sequence = BasicDataBlockSequence<T, Compare, LockPolicy>;
+
+    explicit BasicShardedBlockSequence(const std::vector<T>& values, ShardedSequenceOptions options = {},
+                                       const Compare& comp = Compare{});
+    explicit BasicShardedBlockSequence(std::vector<T>&& values, ShardedSequenceOptions options = {},
+                                       const Compare& comp = Compare{});
+
+    BasicShardedBlockSequence(const BasicShardedBlockSequence&) = delete;
+    BasicShardedBlockSequence& operator=(const BasicShardedBlockSequence&) = delete;
+
+    std::optional<T> get_value(const T& value) const;
+
+    // As BasicDataBlockSequence::get_values. The keys are grouped by shard first, so every
+    // shard is locked once per batch and sees its keys in their original order.
+    size_t get_values(std::span<const T> keys, std::span<std::optional<T>> results) const;
+    size_t get_values(std::span<const T> keys, std::span<std::uint64_t> found) const;
+
+    size_t get_total_size() const;
+
+    size_t get_shard_count() const;
+
+    // The stats of every shard, merged.
+    SequenceStats stats() const;
+
+    // Replaces the contents. Each shard is rebuilt and swapped in on its own, on pool if
+    // given, so a lookup sees either the old or the new keys of its shard; a lookup racing the
+    // rebuild may see old contents in one shard and new contents in another.
+    void rebuild(const std::vector<T>& values, ThreadPool* pool = nullptr);
+    void rebuild(std::vector<T>&& values, ThreadPool* pool = nullptr);
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        Sequence sequence;
+    };
+
+    // The shard that holds value if it is present.
+    size_t shard_index(const T& value) const;
+    // Splits sorted keys into one run per shard under fences_.
+    std::vector<std::vector<T>> split(std::vector<T>&& sorted_keys) const;
+    // Calls on_found(i) for every present keys[i].
+    template <typename OnFound>
+    size_t lookup_batch(std::span<const T> keys, OnFound&& on_found) const;
+
+    [[no_unique_address]] Compare comp_;
+    SequenceOptions shard_options_;
+    // Strictly increasing; shard i + 1 holds the keys not ordered before fences_[i].
+    std::vector<T> fences_;
+    std::vector<Shard> shards_;
+};
+
+extern template class BasicShardedBlockSequence<int, std::less<int>, NullMutex>;
+extern template class BasicShardedBlockSequence<int, std::less<int>, ExclusiveMutex>;
+extern template class BasicShardedBlockSequence<int, std::less<int>, std::shared_mutex>;
+extern template class BasicShardedBlockSequence<int, std::less<int>, EpochMutex>;
+
+extern template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, NullMutex>;
+extern template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, ExclusiveMutex>;
+extern template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, std::shared_mutex>;
+extern template class BasicShardedBlockSequence<std::int64_t, std::less<std::int64_t>, EpochMutex>;
+
+extern template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, NullMutex>;
+extern template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, ExclusiveMutex>;
+extern template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, std::shared_mutex>;
+extern template class BasicShardedBlockSequence<std::uint64_t, std::less<std::uint64_t>, EpochMutex>;
+
+extern template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, NullMutex>;
+extern template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, ExclusiveMutex>;
+extern template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, std::shared_mutex>;
+extern template class BasicShardedBlockSequence<CompositeKey, std::less<CompositeKey>, EpochMutex>;
+
+using ShardedBlockSequence = BasicShardedBlockSequence<int>;
+
+}  // namespace iterator_mutex
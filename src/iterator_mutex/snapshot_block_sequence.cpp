@@ -0,0 +1,80 @@
+#include "snapshot_block_sequence.hpp"
+
+namespace iterator_mutex
+{
+
+template <typename T, typename Compare>
+BasicSnapshotBlockSequence<T, Compare>::BasicSnapshotBlockSequence(const std::vector<T>& values,
+                                                                   SequenceOptions options)
+    : current_(new Node{std::make_shared<const Snapshot>(values, options)})
+{
+}
+
+template <typename T, typename Compare>
+BasicSnapshotBlockSequence<T, Compare>::~BasicSnapshotBlockSequence()
+{
+    // Like any object, the handle must outlive its readers, so nobody can still see the node.
+    delete current_.load(std::memory_order_relaxed);
+}
+
+template <typename T, typename Compare>
+auto BasicSnapshotBlockSequence<T, Compare>::current_node() const -> const Node*
+{
+    // seq_cst pairs with the increment in EpochDomain::ReadGuard, see epoch_domain.hpp.
+    return current_.load(std::memory_order_seq_cst);
+}
+
+template <typename T, typename Compare>
+std::optional<T> BasicSnapshotBlockSequence<T, Compare>::get_value(const T& value) const
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    return current_node()->snapshot->get_value(value);
+}
+
+template <typename T, typename Compare>
+size_t BasicSnapshotBlockSequence<T, Compare>::get_total_size() const
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    return current_node()->snapshot->get_total_size();
+}
+
+template <typename T, typename Compare>
+auto BasicSnapshotBlockSequence<T, Compare>::acquire() const -> std::shared_ptr<const Snapshot>
+{
+    EpochDomain::ReadGuard guard(epoch_domain_);
+    return current_node()->snapshot;
+}
+
+template <typename T, typename Compare>
+void BasicSnapshotBlockSequence<T, Compare>::publish(Snapshot&& next)
+{
+    auto* node = new Node{std::make_shared<const Snapshot>(std::move(next))};
+
+    std::lock_guard<std::mutex> lock(publish_mutex_);
+    const Node* old = current_.exchange(node, std::memory_order_seq_cst);
+
+    // Wait out every reader that might have loaded the old node. Its snapshot is freed
+    // here unless someone pinned it with acquire().
+    epoch_domain_.synchronize();
+    delete old;
+}
+
+template <typename T, typename Compare>
+void BasicSnapshotBlockSequence<T, Compare>::publish(const std::vector<T>& values, SequenceOptions options)
+{
+    // Build (and sort) before taking the publish lock.
+    publish(Snapshot(values, options));
+}
+
+template <typename T, typename Compare>
+void BasicSnapshotBlockSequence<T, Compare>::publish(std::vector<T>&& values, SequenceOptions options)
+{
+    publish(Snapshot(std::move(values), options));
+}
+
+template class BasicSnapshotBlockSequence<int>;
+template class BasicSnapshotBlockSequence<std::int64_t>;
+template class BasicSnapshotBlockSequence<std::uint64_t>;
+template class BasicSnapshotBlockSequence<CompositeKey>;
+
+}  // namespace iterator_mutex
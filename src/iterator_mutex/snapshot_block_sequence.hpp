@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "epoch_domain.hpp"
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+namespace iterator_mutex
+{
+
+// A handle to sorted blocks held in an immutable, reference-counted snapshot. Readers never
+// lock: they load the current snapshot inside an epoch read section, so they are wait-free
+// even while a new snapshot is being published. Publishing swaps a single atomic pointer,
+// and the old snapshot is freed after a grace period once no reader can still see it.
+//
+// The handle itself is neither copyable nor movable; share it by reference. It is
+// instantiated for the same key types as BasicDataBlockSequence.
+template <typename T, typename Compare = std::less<T>>
+class BasicSnapshotBlockSequence
+{
+public:
+    // Published snapshots are never moved or modified, so they need no lock.
+    using Snapshot = BasicDataBlockSequence<T, Compare, NullMutex>;
+
+    // Snapshots are read by every thread at once, so a per-thread MRU hint is the default.
+    explicit BasicSnapshotBlockSequence(const std::vector<T>& values,
+                                        SequenceOptions options = {MruMode::PerThread});
+    ~BasicSnapshotBlockSequence();
+
+    BasicSnapshotBlockSequence(const BasicSnapshotBlockSequence&) = delete;
+    BasicSnapshotBlockSequence& operator=(const BasicSnapshotBlockSequence&) = delete;
+
+    std::optional<T> get_value(const T& value) const;
+
+    size_t get_total_size() const;
+
+    // Pins the current snapshot, e.g. for several lookups that must see the same contents.
+    // A pinned snapshot outlives any number of later publishes.
+    std::shared_ptr<const Snapshot> acquire() const;
+
+    // Replaces the contents. Readers already inside a lookup finish on the old snapshot.
+    // Blocks the caller until no reader can still reach the old snapshot; readers never wait.
+    void publish(Snapshot&& next);
+    void publish(const std::vector<T>& values, SequenceOptions options = {MruMode::PerThread});
+    void publish(std::vector<T>&& values, SequenceOptions options = {MruMode::PerThread});
+
+private:
+    struct Node
+    {
+        std::shared_ptr<const Snapshot> snapshot;
+    };
+
+    // Callers must be inside a read section of epoch_domain_.
+    const Node* current_node() const;
+
+    std::atomic<const Node*> current_;
+    mutable EpochDomain epoch_domain_;
+    std::mutex publish_mutex_;
+};
+
+extern template class BasicSnapshotBlockSequence<int>;
+extern template class BasicSnapshotBlockSequence<std::int64_t>;
+extern template class BasicSnapshotBlockSequence<std::uint64_t>;
+extern template class BasicSnapshotBlockSequence<CompositeKey>;
+
+using SnapshotBlockSequence = BasicSnapshotBlockSequence<int>;
+
+}  // namespace iterator_mutex
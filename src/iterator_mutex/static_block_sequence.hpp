@@ -0,0 +1,142 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+
+namespace iterator_mutex
+{
+
+// A sorted table of N keys fixed at compile time, for the small lookup tables that do not
+// need a heap buffer, a sort at startup or a lock. The constructor sorts in a constant
+// expression, so a constexpr or constinit instance is built by the compiler and lands in
+// read-only data; nothing runs at startup (or ever writes to it), and every thread may read
+// it without synchronization.
+//
+// Lookups take the same branch-free halving as search_lower_bound, but with N known the
+// sequence of halves is too, so the search is unrolled into exactly bit_width(N - 1) steps
+// with no loop and no length updates. Everything is constexpr, so lookups in constant
+// expressions are answered at compile time.
+//
+// It has get_value, get_total_size and the position queries of BasicDataBlockSequence, so
+// templated code can take either. Meant for up to a few hundred keys: the compile-time sort
+// counts against the compiler's constexpr step limit, and past a few cache lines the
+// layouts of BasicDataBlockSequence do better.
+template <typename T, size_t N, typename Compare = std::less<T>>
+class BasicStaticBlockSequence
+{
+public:
+    using value_type = T;
+    using key_compare = Compare;
+
+    // Sorts values by comp.
+    constexpr explicit BasicStaticBlockSequence(const std::array<T, N>& values, const Compare& comp = Compare{})
+        : keys_(values), comp_(comp)
+    {
+        std::sort(keys_.begin(), keys_.end(), comp_);
+    }
+
+    constexpr std::optional<T> get_value(const T& value) const
+    {
+        const size_t position = lower_bound(value);
+        if (position < N && !comp_(value, keys_[position]))
+        {
+            return keys_[position];
+        }
+        return std::nullopt;
+    }
+
+    // The position of the first key equivalent to value, or std::nullopt if there is none.
+    constexpr std::optional<size_t> find_index(const T& value) const
+    {
+        const size_t position = lower_bound(value);
+        if (position < N && !comp_(value, keys_[position]))
+        {
+            return position;
+        }
+        return std::nullopt;
+    }
+
+    // The number of keys ordered before value.
+    constexpr size_t lower_bound(const T& value) const
+    {
+        if constexpr (N == 0)
+        {
+            return 0;
+        }
+        else
+        {
+            return search(value, std::make_index_sequence<kSteps.size()>());
+        }
+    }
+
+    // The number of keys in [lo, hi); 0 unless lo orders before hi.
+    constexpr size_t count_range(const T& lo, const T& hi) const
+    {
+        return comp_(lo, hi) ? lower_bound(hi) - lower_bound(lo) : 0;
+    }
+
+    static constexpr size_t get_total_size()
+    {
+        return N;
+    }
+
+    constexpr std::span<const T, N> get_keys() const
+    {
+        return keys_;
+    }
+
+private:
+    static constexpr size_t kStepCount = []
+    {
+        size_t count = 0;
+        for (size_t len = N; len > 1; len -= len / 2)
+        {
+            ++count;
+        }
+        return count;
+    }();
+
+    // The halves search_lower_bound steps by for a range of N keys.
+    static constexpr std::array<size_t, kStepCount> kSteps = []
+    {
+        std::array<size_t, kStepCount> steps{};
+        size_t len = N;
+        for (size_t& step : steps)
+        {
+            step = len / 2;
+            len -= step;
+        }
+        return steps;
+    }();
+
+    template <size_t... I>
+    constexpr size_t search(const T& value, std::index_sequence<I...>) const
+    {
+        // Invariant: the answer lies in [base, base + remaining], and one key remains at the end.
+        size_t base = 0;
+        ((base = comp_(keys_[base + kSteps[I] - 1], value) ? base + kSteps[I] : base), ...);
+        return base + (comp_(keys_[base], value) ? 1 : 0);
+    }
+
+    std::array<T, N> keys_;
+    [[no_unique_address]] Compare comp_;
+};
+
+// Builds a table from a braced list, e.g. make_static_sequence<int>({5, 1, 3}), with N
+// worked out from the list.
+template <typename T, typename Compare = std::less<T>, size_t N>
+constexpr BasicStaticBlockSequence<T, N, Compare> make_static_sequence(const T (&values)[N],
+                                                                       const Compare& comp = Compare{})
+{
+    return BasicStaticBlockSequence<T, N, Compare>(std::to_array(values), comp);
+}
+
+template <size_t N>
+using StaticBlockSequence = BasicStaticBlockSequence<int, N>;
+
+}  // namespace iterator_mutex
@@ -0,0 +1,87 @@
+#include "thread_pool.hpp"
+
+namespace iterator_mutex
+{
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+    {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    // Workers drain the queue first and stop once a wake-up finds it empty.
+    wake_.release(static_cast<std::ptrdiff_t>(workers_.size()));
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return workers_.size();
+}
+
+void ThreadPool::ParallelFor::run()
+{
+    for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next.fetch_add(1, std::memory_order_relaxed))
+    {
+        // After a failure the remaining indices are only counted, so the caller stops sooner.
+        if (!failed.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (finished.fetch_add(1, std::memory_order_acq_rel) + 1 == count)
+        {
+            finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    wake_.release();
+}
+
+void ThreadPool::worker_loop()
+{
+    for (;;)
+    {
+        wake_.acquire();
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty())
+            {
+                return;  // Only shutdown wakes a worker without a task.
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace iterator_mutex
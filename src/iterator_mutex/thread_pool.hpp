@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace iterator_mutex
+{
+
+// A fixed set of worker threads for splitting bulk work such as sorting and index builds.
+// parallel_for is the only way in: the calling thread works along with the pool and returns
+// once everything is done, so a pool can be shared by any number of callers, and a task that
+// calls parallel_for itself never deadlocks waiting for a worker.
+class ThreadPool
+{
+public:
+    // threads is the number of workers; the caller of parallel_for always adds one more.
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+
+    // Calls fn(i) once for every i in [0, count), spread over the workers and the calling
+    // thread. If any call throws, the remaining indices may be skipped and the first exception
+    // is rethrown here once no call is running any more.
+    template <typename Fn>
+    void parallel_for(size_t count, Fn&& fn);
+
+private:
+    // Shared by the caller and the tasks it queued. Tasks may start after the caller has
+    // returned and then find nothing left to claim, hence the shared ownership.
+    struct ParallelFor
+    {
+        std::function<void(size_t)> fn;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::atomic<bool> failed{false};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        // Claims and runs indices until none are left.
+        void run();
+    };
+
+    void submit(std::function<void()> task);
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::deque<std::function<void()>> tasks_;
+    // Released once per queued task, and once per worker on shutdown.
+    std::counting_semaphore<> wake_{0};
+};
+
+template <typename Fn>
+void ThreadPool::parallel_for(size_t count, Fn&& fn)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto job = std::make_shared<ParallelFor>();
+    job->fn = std::forward<Fn>(fn);
+    job->count = count;
+
+    // One task per worker that can be useful; each claims indices until they run out.
+    const size_t helpers = std::min(workers_.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        submit([job]() { job->run(); });
+    }
+    job->run();
+
+    // Every index is claimed; wait for the ones still running on the workers.
+    for (size_t finished = job->finished.load(std::memory_order_acquire); finished < count;
+         finished = job->finished.load(std::memory_order_acquire))
+    {
+        job->finished.wait(finished, std::memory_order_acquire);
+    }
+    if (job->error)
+    {
+        std::rethrow_exception(job->error);
+    }
+}
+
+// Runs fn(i) for every i in [0, count) on pool, or inline on the calling thread without one.
+template <typename Fn>
+void parallel_for(ThreadPool* pool, size_t count, Fn&& fn)
+{
+    if (pool != nullptr && count > 1)
+    {
+        pool->parallel_for(count, std::forward<Fn>(fn));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        fn(i);
+    }
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,19 @@
+#include "thread_slot.hpp"
+
+#include <atomic>
+
+namespace iterator_mutex
+{
+
+namespace detail
+{
+
+size_t next_thread_slot()
+{
+    static std::atomic<size_t> next_slot{0};
+    return next_slot.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace detail
+
+}  // namespace iterator_mutex
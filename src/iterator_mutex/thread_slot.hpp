@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+namespace iterator_mutex
+{
+
+namespace detail
+{
+size_t next_thread_slot();
+}  // namespace detail
+
+// Returns a small integer that stays fixed for the lifetime of the calling thread. Slots are
+// handed out in order, so they spread evenly over per-thread arrays indexed modulo their size.
+inline size_t this_thread_slot()
+{
+    thread_local const size_t slot = detail::next_thread_slot();
+    return slot;
+}
+
+}  // namespace iterator_mutex
@@ -0,0 +1,56 @@
+#include "trace_points.hpp"
+
+namespace iterator_mutex
+{
+
+namespace detail
+{
+
+std::atomic<TraceHandler> g_trace_handler{nullptr};
+
+}  // namespace detail
+
+void set_trace_handler(TraceHandler handler)
+{
+    if constexpr (kTracingEnabled)
+    {
+        detail::g_trace_handler.store(handler, std::memory_order_release);
+    }
+}
+
+TraceHandler get_trace_handler()
+{
+    return detail::g_trace_handler.load(std::memory_order_acquire);
+}
+
+const char* trace_event_name(TraceEvent event)
+{
+    switch (event)
+    {
+    case TraceEvent::SharedLockAcquire:
+        return "shared_lock_acquire";
+    case TraceEvent::SharedLockRelease:
+        return "shared_lock_release";
+    case TraceEvent::MoveBegin:
+        return "move_begin";
+    case TraceEvent::MoveLocked:
+        return "move_locked";
+    case TraceEvent::MoveEnd:
+        return "move_end";
+    case TraceEvent::HintHit:
+        return "hint_hit";
+    case TraceEvent::HintMiss:
+        return "hint_miss";
+    case TraceEvent::BuildBegin:
+        return "build_begin";
+    case TraceEvent::SortEnd:
+        return "sort_end";
+    case TraceEvent::BuildEnd:
+        return "build_end";
+    case TraceEvent::Count:
+        break;
+    }
+    return "unknown";
+}
+
+}  // namespace iterator_mutex
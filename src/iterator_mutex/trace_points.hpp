@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#if defined(ITERATOR_MUTEX_TRACING) && defined(ITERATOR_MUTEX_HAVE_SDT)
+#include <sys/sdt.h>
+#endif
+
+namespace iterator_mutex
+{
+
+// Whether sequences emit trace events. Set by configuring with -DITERATOR_MUTEX_TRACING=ON,
+// which defines ITERATOR_MUTEX_TRACING for the library and everything that links it. Without
+// it trace() is empty and every call to it, arguments included, compiles to nothing.
+#if defined(ITERATOR_MUTEX_TRACING)
+inline constexpr bool kTracingEnabled = true;
+#else
+inline constexpr bool kTracingEnabled = false;
+#endif
+
+// What a sequence is doing. Every event names the sequence by its address and carries one
+// number, described with each event; it is 0 where none is given.
+enum class TraceEvent : std::uint32_t
+{
+    // A reader holds the lock. The nanoseconds it waited, 0 if it took the lock at once.
+    SharedLockAcquire,
+    // A reader has released the lock.
+    SharedLockRelease,
+    // A move construction, move assignment or swap into the sequence is about to take the
+    // locks.
+    MoveBegin,
+    // The move holds the locks, which blocks readers. The nanoseconds it waited for them.
+    MoveLocked,
+    // The move has released the locks. The nanoseconds it held them.
+    MoveEnd,
+    // A single-key query was answered by a hint. How, as the index of the field in HintStats:
+    // 0 the exact hint, 1 the hot-key cache, 2 the finger search.
+    HintHit,
+    // A single-key query had to search the layout from the top.
+    HintMiss,
+    // A constructor starts. The number of keys.
+    BuildBegin,
+    // A constructor that sorts has sorted the keys. The number of keys.
+    SortEnd,
+    // A constructor is done, layout index and key filter included. The number of keys.
+    BuildEnd,
+    Count,
+};
+
+// Called for every event, on the thread the event happens on and possibly inside the lock,
+// so it must be short and must not throw or call back into the sequence.
+using TraceHandler = void (*)(TraceEvent event, const void* sequence, std::uint64_t arg);
+
+// Installs handler for all sequences, or removes it for nullptr. A handler may still be
+// called for a short while after it has been replaced. Has no effect without tracing.
+void set_trace_handler(TraceHandler handler);
+TraceHandler get_trace_handler();
+
+// The name of event, as USDT probes and trace output use it: "shared_lock_acquire" and so on.
+const char* trace_event_name(TraceEvent event);
+
+namespace detail
+{
+
+extern std::atomic<TraceHandler> g_trace_handler;
+
+#if defined(ITERATOR_MUTEX_TRACING) && defined(ITERATOR_MUTEX_HAVE_SDT)
+// One USDT probe per event in the iterator_mutex provider, named as trace_event_name gives,
+// for perf probe and bpftrace: usdt:<binary>:iterator_mutex:move_locked, for instance. A
+// probe nothing is attached to costs a nop. Each case is its own probe site; trace() is
+// inlined with a constant event, so only that one is kept.
+inline void fire_probe(TraceEvent event, const void* sequence, std::uint64_t arg)
+{
+    switch (event)
+    {
+    case TraceEvent::SharedLockAcquire:
+        DTRACE_PROBE2(iterator_mutex, shared_lock_acquire, sequence, arg);
+        break;
+    case TraceEvent::SharedLockRelease:
+        DTRACE_PROBE2(iterator_mutex, shared_lock_release, sequence, arg);
+        break;
+    case TraceEvent::MoveBegin:
+        DTRACE_PROBE2(iterator_mutex, move_begin, sequence, arg);
+        break;
+    case TraceEvent::MoveLocked:
+        DTRACE_PROBE2(iterator_mutex, move_locked, sequence, arg);
+        break;
+    case TraceEvent::MoveEnd:
+        DTRACE_PROBE2(iterator_mutex, move_end, sequence, arg);
+        break;
+    case TraceEvent::HintHit:
+        DTRACE_PROBE2(iterator_mutex, hint_hit, sequence, arg);
+        break;
+    case TraceEvent::HintMiss:
+        DTRACE_PROBE2(iterator_mutex, hint_miss, sequence, arg);
+        break;
+    case TraceEvent::BuildBegin:
+        DTRACE_PROBE2(iterator_mutex, build_begin, sequence, arg);
+        break;
+    case TraceEvent::SortEnd:
+        DTRACE_PROBE2(iterator_mutex, sort_end, sequence, arg);
+        break;
+    case TraceEvent::BuildEnd:
+        DTRACE_PROBE2(iterator_mutex, build_end, sequence, arg);
+        break;
+    case TraceEvent::Count:
+        break;
+    }
+}
+#endif
+
+}  // namespace detail
+
+// Emits event: to its USDT probe where <sys/sdt.h> was found, and to the trace handler if one
+// is installed. Compiled out without tracing.
+inline void trace([[maybe_unused]] TraceEvent event, [[maybe_unused]] const void* sequence,
+                  [[maybe_unused]] std::uint64_t arg = 0)
+{
+    if constexpr (kTracingEnabled)
+    {
+#if defined(ITERATOR_MUTEX_TRACING) && defined(ITERATOR_MUTEX_HAVE_SDT)
+        detail::fire_probe(event, sequence, arg);
+#endif
+        if (const TraceHandler handler = detail::g_trace_handler.load(std::memory_order_acquire))
+        {
+            handler(event, sequence, arg);
+        }
+    }
+}
+
+// A shared lock that emits SharedLockRelease for sequence when it lets go of the lock, by
+// destruction or by being assigned to. Sequences only hold their shared locks in one of
+// these when tracing is enabled.
+template <typename Lock>
+class TracedLock
+{
+public:
+    TracedLock(Lock&& lock, const void* sequence) : lock_(std::move(lock)), sequence_(sequence)
+    {
+    }
+
+    // A moved-from Lock owns nothing, so only the lock moved to emits the release.
+    TracedLock(TracedLock&& other) noexcept = default;
+    TracedLock& operator=(TracedLock&& other) noexcept
+    {
+        release();
+        lock_ = std::move(other.lock_);
+        sequence_ = other.sequence_;
+        return *this;
+    }
+
+    ~TracedLock()
+    {
+        release();
+    }
+
+    bool owns_lock() const noexcept
+    {
+        return lock_.owns_lock();
+    }
+
+private:
+    void release() noexcept
+    {
+        if (lock_.owns_lock())
+        {
+            lock_.unlock();
+            trace(TraceEvent::SharedLockRelease, sequence_);
+        }
+    }
+
+    Lock lock_;
+    const void* sequence_;
+};
+
+}  // namespace iterator_mutex
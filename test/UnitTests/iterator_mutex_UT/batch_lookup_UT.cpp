@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// --- Test Fixture for Batch Lookups ---
+class BatchLookupTest : public ::testing::Test
+{
+protected:
+    // Sorted order will be: {10, 20, 20, 30, 40, 50}
+    iterator_mutex::DataBlockSequence seq_{{50, 20, 10, 40, 30, 20}};
+};
+
+/**
+ * @brief Tests the merge-walk path with sorted keys, including repeats and out-of-range keys.
+ */
+TEST_F(BatchLookupTest, SortedKeysMatchSingleLookups)
+{
+    const std::vector<int> keys = {0, 10, 15, 20, 20, 35, 50, 60, 70};
+    std::vector<std::optional<int>> results(keys.size());
+
+    EXPECT_EQ(seq_.get_values(keys, results), 4);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(results[i], seq_.get_value(keys[i])) << "key " << keys[i];
+    }
+}
+
+/**
+ * @brief Tests the independent-search path with unsorted keys.
+ */
+TEST_F(BatchLookupTest, UnsortedKeysMatchSingleLookups)
+{
+    const std::vector<int> keys = {50, 5, 30, 10, 45, 20};
+    std::vector<std::optional<int>> results(keys.size(), 99);
+
+    EXPECT_EQ(seq_.get_values(keys, results), 4);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(results[i], seq_.get_value(keys[i])) << "key " << keys[i];
+    }
+}
+
+/**
+ * @brief Tests the bitmap overload over more than one 64-bit word.
+ */
+TEST(BatchLookupBitmapTest, SetsBitsForPresentKeys)
+{
+    std::vector<int> values;
+    for (int v = 0; v < 200; v += 2)
+    {
+        values.push_back(v);
+    }
+    iterator_mutex::DataBlockSequence seq(values);
+
+    std::vector<int> keys(130);
+    for (int i = 0; i < 130; ++i)
+    {
+        keys[i] = i;
+    }
+    std::vector<std::uint64_t> found(3, ~std::uint64_t{0});
+
+    EXPECT_EQ(seq.get_values(keys, found), 65);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const bool bit = (found[i / 64] >> (i % 64)) & 1;
+        EXPECT_EQ(bit, keys[i] % 2 == 0) << "key " << keys[i];
+    }
+    EXPECT_EQ(found[2] >> 2, 0u);
+}
+
+/**
+ * @brief Tests batch lookups on an empty sequence and with an empty batch.
+ */
+TEST(BatchLookupEmptyTest, HandlesEmptyInputs)
+{
+    iterator_mutex::DataBlockSequence empty_seq({});
+    const std::vector<int> keys = {1, 2, 3};
+    std::vector<std::optional<int>> results(keys.size(), 7);
+
+    EXPECT_EQ(empty_seq.get_values(keys, results), 0);
+    for (const auto& r : results)
+    {
+        EXPECT_FALSE(r.has_value());
+    }
+
+    std::vector<std::uint64_t> found;
+    EXPECT_EQ(empty_seq.get_values(std::span<const int>{}, found), 0);
+}
+
+/**
+ * @brief Tests that undersized outputs are rejected instead of overrun.
+ */
+TEST_F(BatchLookupTest, RejectsUndersizedOutput)
+{
+    const std::vector<int> keys = {10, 20, 30};
+    std::vector<std::optional<int>> results(2);
+    EXPECT_THROW(seq_.get_values(keys, results), std::invalid_argument);
+
+    std::vector<std::uint64_t> found;
+    EXPECT_THROW(seq_.get_values(keys, found), std::invalid_argument);
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "compressed_block_sequence.hpp"
+#include "iterator_mutex_move_operations.hpp"
+#include "thread_pool.hpp"
+
+// --- Typed over the Key Types the Library Instantiates ---
+template <typename T>
+class CompressedBlockSequenceTest : public ::testing::Test
+{
+};
+
+using CompressedKeyTypes = ::testing::Types<int, std::int64_t, std::uint64_t>;
+TYPED_TEST_SUITE(CompressedBlockSequenceTest, CompressedKeyTypes);
+
+/**
+ * @brief Tests that every lookup matches an uncompressed sequence built from the same keys.
+ *
+ * Mixes dense runs, duplicates and large gaps so blocks get widths from 0 up to the full key
+ * width, and includes both ends of the key range.
+ */
+TYPED_TEST(CompressedBlockSequenceTest, LookupsMatchUncompressedSequence)
+{
+    using Limits = std::numeric_limits<TypeParam>;
+    std::mt19937_64 rng(17);
+    std::vector<TypeParam> values;
+    for (TypeParam i = 0; i < 1000; ++i)
+    {
+        values.push_back(i);  // Dense.
+    }
+    values.insert(values.end(), 300, TypeParam{5000});  // Width 0 blocks.
+    for (int i = 0; i < 2000; ++i)
+    {
+        values.push_back(static_cast<TypeParam>(rng()));  // Sparse, anywhere in the range.
+    }
+    values.push_back(Limits::min());
+    values.push_back(Limits::max());
+
+    const iterator_mutex::BasicDataBlockSequence<TypeParam> expected(values);
+    const iterator_mutex::BasicCompressedBlockSequence<TypeParam> compressed(values);
+    EXPECT_EQ(compressed.get_total_size(), values.size());
+
+    std::vector<TypeParam> probes = values;
+    for (TypeParam value : values)
+    {
+        probes.push_back(static_cast<TypeParam>(value + 1));
+        probes.push_back(static_cast<TypeParam>(value - 1));
+    }
+    for (TypeParam probe : probes)
+    {
+        EXPECT_EQ(compressed.get_value(probe), expected.get_value(probe)) << "probe " << probe;
+    }
+}
+
+/**
+ * @brief Tests that dense keys take a fraction of their uncompressed size.
+ */
+TEST(CompressedBlockSequenceMemoryTest, DenseKeysCompress)
+{
+    std::vector<int> values(1 << 20);
+    std::iota(values.begin(), values.end(), 0);
+    const iterator_mutex::CompressedBlockSequence compressed(iterator_mutex::assume_sorted, values);
+
+    // 7 bits per key plus the heads and block descriptors, against 32 bits uncompressed.
+    EXPECT_LT(compressed.get_memory_usage(), values.size() * sizeof(int) / 3);
+    EXPECT_EQ(compressed.get_value(123456), 123456);
+    EXPECT_FALSE(compressed.get_value(1 << 20).has_value());
+}
+
+/**
+ * @brief Tests the empty sequence, moves and a build on a pool.
+ */
+TEST(CompressedBlockSequenceBuildTest, EmptyMoveAndPoolBuild)
+{
+    const iterator_mutex::CompressedBlockSequence empty(std::vector<int>{});
+    EXPECT_EQ(empty.get_total_size(), 0);
+    EXPECT_FALSE(empty.get_value(0).has_value());
+
+    iterator_mutex::ThreadPool pool(3);
+    std::vector<int> values(100000);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>((values.size() - i) * 3);
+    }
+    iterator_mutex::CompressedBlockSequence built(std::move(values), {&pool});
+    EXPECT_EQ(built.get_value(300), 300);
+    EXPECT_FALSE(built.get_value(301).has_value());
+
+    iterator_mutex::CompressedBlockSequence moved(std::move(built));
+    EXPECT_EQ(moved.get_value(300000), 300000);
+    EXPECT_EQ(built.get_total_size(), 0);
+    EXPECT_FALSE(built.get_value(300).has_value());
+
+    built = std::move(moved);
+    EXPECT_EQ(built.get_value(3), 3);
+}
+
+#ifndef NDEBUG
+/**
+ * @brief Tests that debug builds reject unsorted keys passed with assume_sorted.
+ */
+TEST(CompressedBlockSequenceBuildTest, AssumeSortedChecksOrderInDebugBuilds)
+{
+    const std::vector<int> unsorted = {3, 1, 2};
+    EXPECT_THROW(iterator_mutex::CompressedBlockSequence(iterator_mutex::assume_sorted, unsorted),
+                 std::invalid_argument);
+}
+#endif
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// --- Parameterized over HintSearch, MRU Mode and Layout ---
+class HintSearchTest : public ::testing::TestWithParam<
+                           std::tuple<iterator_mutex::HintSearch, iterator_mutex::MruMode, iterator_mutex::Layout>>
+{
+protected:
+    void SetUp() override
+    {
+        // Every third number in [0, 30000), with a run of duplicates in the middle.
+        for (int v = 0; v < 30000; v += 3)
+        {
+            values_.push_back(v);
+        }
+        values_.insert(values_.end(), 20, 15000);
+        std::sort(values_.begin(), values_.end());
+
+        iterator_mutex::SequenceOptions options;
+        options.hint_search = std::get<0>(GetParam());
+        options.mru_mode = std::get<1>(GetParam());
+        options.layout = std::get<2>(GetParam());
+        options.hint_stats = true;
+        seq_.emplace(values_, options);
+    }
+
+    std::optional<int> expected_value(int value) const
+    {
+        return std::binary_search(values_.begin(), values_.end(), value) ? std::optional<int>(value) : std::nullopt;
+    }
+
+    size_t expected_lower_bound(int value) const
+    {
+        return static_cast<size_t>(std::lower_bound(values_.begin(), values_.end(), value) - values_.begin());
+    }
+
+    std::vector<int> values_;
+    std::optional<iterator_mutex::DataBlockSequence> seq_;
+};
+
+/**
+ * @brief Tests that local walks in both directions, repeats and far jumps all find what std::lower_bound finds.
+ */
+TEST_P(HintSearchTest, LookupsMatchStdLowerBound)
+{
+    std::vector<int> probes;
+    for (int v = -2; v < 30002; v += 1)
+    {
+        probes.push_back(v);  // Forward walk, hits and misses.
+    }
+    for (int v = 30002; v > -2; v -= 7)
+    {
+        probes.push_back(v);  // Backward walk.
+    }
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> dist(-10, 30010);
+    for (int i = 0; i < 2000; ++i)
+    {
+        const int v = dist(rng);
+        probes.push_back(v);  // Far jumps, each followed by a repeat and a near key.
+        probes.push_back(v);
+        probes.push_back(v + 2);
+    }
+
+    for (int value : probes)
+    {
+        ASSERT_EQ(seq_->get_value(value), expected_value(value)) << "value " << value;
+        ASSERT_EQ(seq_->lower_bound(value), expected_lower_bound(value)) << "value " << value;
+    }
+
+    const auto stats = seq_->get_hint_stats();
+    EXPECT_EQ(stats.exact_hits + stats.near_hits + stats.misses, 2 * probes.size());
+    if (std::get<0>(GetParam()) == iterator_mutex::HintSearch::Exact)
+    {
+        EXPECT_EQ(stats.near_hits, 0);
+    }
+    else
+    {
+        EXPECT_GT(stats.near_hits, stats.misses);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllModes, HintSearchTest,
+                         ::testing::Combine(::testing::Values(iterator_mutex::HintSearch::Exact,
+                                                              iterator_mutex::HintSearch::Finger,
+                                                              iterator_mutex::HintSearch::Interpolation),
+                                            ::testing::Values(iterator_mutex::MruMode::Shared,
+                                                              iterator_mutex::MruMode::PerThread),
+                                            ::testing::Values(iterator_mutex::Layout::Sorted,
+                                                              iterator_mutex::Layout::Eytzinger)));
+
+// --- Hint Statistics ---
+
+/**
+ * @brief Tests how a forward walk is counted with and without the finger search.
+ */
+TEST(HintStatsTest, CountsExactNearAndMisses)
+{
+    std::vector<int> values(10000);
+    for (int i = 0; i < 10000; ++i)
+    {
+        values[static_cast<size_t>(i)] = 2 * i;
+    }
+
+    for (auto search : {iterator_mutex::HintSearch::Exact, iterator_mutex::HintSearch::Finger})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.hint_search = search;
+        options.hint_stats = true;
+        const iterator_mutex::DataBlockSequence seq(values, options);
+
+        for (int v = 0; v < 200; v += 2)
+        {
+            ASSERT_EQ(seq.get_value(v), v);
+            ASSERT_EQ(seq.get_value(v), v);
+        }
+        // The fresh hint points at 0, so both lookups of 0 hit it; every later key is first
+        // searched for and then repeated.
+        const auto stats = seq.get_hint_stats();
+        EXPECT_EQ(stats.exact_hits, 101);
+        if (search == iterator_mutex::HintSearch::Exact)
+        {
+            EXPECT_EQ(stats.near_hits, 0);
+            EXPECT_EQ(stats.misses, 99);
+        }
+        else
+        {
+            EXPECT_EQ(stats.near_hits, 99);
+            EXPECT_EQ(stats.misses, 0);
+        }
+
+        // Far beyond the reach of the finger.
+        EXPECT_EQ(seq.get_value(19000), 19000);
+        EXPECT_EQ(seq.get_hint_stats().misses, stats.misses + 1);
+    }
+}
+
+/**
+ * @brief Tests that nothing is counted unless asked for, and that interpolation handles composite keys.
+ */
+TEST(HintStatsTest, DisabledAndCompositeKeys)
+{
+    iterator_mutex::SequenceOptions options;
+    options.hint_search = iterator_mutex::HintSearch::Interpolation;
+    const iterator_mutex::DataBlockSequence seq({1, 2, 3, 5, 8}, options);
+    EXPECT_EQ(seq.get_value(5), 5);
+    EXPECT_EQ(seq.get_value(4), std::nullopt);
+    EXPECT_EQ(seq.get_hint_search(), iterator_mutex::HintSearch::Interpolation);
+    EXPECT_EQ(seq.get_hint_stats().misses + seq.get_hint_stats().near_hits, 0);
+
+    using iterator_mutex::CompositeKey;
+    options.hint_stats = true;
+    const iterator_mutex::BasicDataBlockSequence<CompositeKey> composite(
+        std::vector<CompositeKey>{{1, 1}, {1, 2}, {2, 0}, {3, 7}}, options);
+    EXPECT_EQ(composite.get_value(CompositeKey{1, 2}), (CompositeKey{1, 2}));
+    EXPECT_EQ(composite.get_value(CompositeKey{3, 7}), (CompositeKey{3, 7}));
+    EXPECT_EQ(composite.get_value(CompositeKey{2, 1}), std::nullopt);
+    // Interpolation has no estimate for composite keys, so each search starts from the hint.
+    EXPECT_EQ(composite.get_hint_stats().near_hits, 3);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "test_keys.hpp"
+
+using test_keys::even_numbers;
+
+namespace
+{
+
+iterator_mutex::SequenceOptions hot_key_options(size_t hot_keys, iterator_mutex::MruMode mru_mode)
+{
+    iterator_mutex::SequenceOptions options;
+    options.mru_mode = mru_mode;
+    options.hot_keys = hot_keys;
+    options.hint_stats = true;
+    return options;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that a few hot keys mixed with cold ones are answered by the cache, under both MRU modes.
+ */
+TEST(HotKeyCacheTest, HotKeysStayCachedAmongColdOnes)
+{
+    for (auto mru_mode : {iterator_mutex::MruMode::Shared, iterator_mutex::MruMode::PerThread})
+    {
+        const iterator_mutex::DataBlockSequence seq(even_numbers(100000), hot_key_options(256, mru_mode));
+
+        std::mt19937 rng(11);
+        std::uniform_int_distribution<int> hot(0, 63);
+        std::uniform_int_distribution<int> cold(0, 199999);
+        size_t hot_lookups = 0;
+        for (int i = 0; i < 20000; ++i)
+        {
+            // Four hot lookups for every cold one, which may be a miss.
+            const int key = i % 5 == 4 ? cold(rng) : 1000 * hot(rng);
+            hot_lookups += i % 5 != 4;
+            ASSERT_EQ(seq.get_value(key), key % 2 == 0 ? std::optional<int>(key) : std::nullopt) << "key " << key;
+        }
+
+        // Cold keys only ever replace each other or the odd hot key that went unused for a
+        // whole sweep of its set.
+        const auto stats = seq.get_hint_stats();
+        EXPECT_GT(stats.hot_key_hits + stats.exact_hits, hot_lookups * 98 / 100);
+    }
+}
+
+/**
+ * @brief Tests that move assignment and construction empty the cache, so no entry outlives the keys it points at.
+ */
+TEST(HotKeyCacheTest, MovesInvalidateEntries)
+{
+    const auto options = hot_key_options(64, iterator_mutex::MruMode::Shared);
+    iterator_mutex::DataBlockSequence seq(even_numbers(1000), options);
+    for (int key : {10, 20, 30, 10, 20, 30})
+    {
+        ASSERT_EQ(seq.get_value(key), key);
+    }
+    ASSERT_GT(seq.get_hint_stats().hot_key_hits, 0);
+
+    // The same positions now hold other keys.
+    std::vector<int> shifted = even_numbers(1000);
+    for (int& value : shifted)
+    {
+        value += 1;
+    }
+    seq = iterator_mutex::DataBlockSequence(shifted, options);
+    const auto before = seq.get_hint_stats();
+    EXPECT_EQ(seq.get_value(20), std::nullopt);
+    EXPECT_EQ(seq.get_value(21), 21);
+    EXPECT_EQ(seq.get_value(31), 31);
+    EXPECT_EQ(seq.get_hint_stats().hot_key_hits, before.hot_key_hits);
+
+    iterator_mutex::DataBlockSequence moved(std::move(seq));
+    EXPECT_EQ(moved.get_value(31), 31);
+    EXPECT_EQ(moved.get_value(21), 21);
+    EXPECT_EQ(moved.get_value(31), 31);
+    EXPECT_EQ(seq.get_value(21), std::nullopt);
+    seq = iterator_mutex::DataBlockSequence(even_numbers(10), options);
+    EXPECT_EQ(seq.get_value(8), 8);
+}
+
+/**
+ * @brief Tests that position queries through the cache still resolve duplicates to the first of them.
+ */
+TEST(HotKeyCacheTest, PositionQueriesResolveDuplicates)
+{
+    const iterator_mutex::DataBlockSequence seq({5, 7, 7, 7, 9}, hot_key_options(16, iterator_mutex::MruMode::Shared));
+    // get_value may leave any of the three 7s in the cache; lower_bound must not return it.
+    for (int round = 0; round < 3; ++round)
+    {
+        EXPECT_EQ(seq.get_value(9), 9);
+        EXPECT_EQ(seq.get_value(7), 7);
+        EXPECT_EQ(seq.find_index(7), 1);
+        EXPECT_EQ(seq.lower_bound(9), 4);
+        EXPECT_EQ(seq.lower_bound(7), 1);
+    }
+}
+
+/**
+ * @brief Tests that composite keys, hashed by their bytes, are cached too.
+ */
+TEST(HotKeyCacheTest, CompositeKeys)
+{
+    using iterator_mutex::CompositeKey;
+    std::vector<CompositeKey> values;
+    for (std::uint64_t i = 0; i < 500; ++i)
+    {
+        values.push_back({i % 7, i});
+    }
+    const iterator_mutex::BasicDataBlockSequence<CompositeKey> seq(
+        values, hot_key_options(64, iterator_mutex::MruMode::PerThread));
+
+    for (int round = 0; round < 4; ++round)
+    {
+        for (std::uint64_t i : {3, 100, 250, 499})
+        {
+            ASSERT_EQ(seq.get_value(CompositeKey{i % 7, i}), (CompositeKey{i % 7, i}));
+        }
+    }
+    EXPECT_EQ(seq.get_value(CompositeKey{1, 2}), std::nullopt);
+    // Only the first round searches; the per-thread hint still holds the last key searched for.
+    const auto stats = seq.get_hint_stats();
+    EXPECT_EQ(stats.misses, 5);
+    EXPECT_EQ(stats.hot_key_hits + stats.exact_hits, 12);
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 
 #include <numeric>
+#include <span>
+#include <stdexcept>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "iterator_mutex_move_operations.hpp"
@@ -44,6 +48,85 @@ TEST(DataBlockSequenceEmptyTest, HandlesEmptyVector)
     EXPECT_FALSE(empty_seq.get_value(0).has_value());
 }
 
+// --- Zero-Copy Construction ---
+
+/**
+ * @brief Tests that constructing from an rvalue vector reuses its buffer and still sorts it.
+ */
+TEST(DataBlockSequenceZeroCopyTest, RvalueVectorIsAdoptedAndSorted)
+{
+    std::vector<int> values = {50, 10, 40, 20, 30};
+    const std::vector<int> copy = values;
+
+    iterator_mutex::DataBlockSequence seq(std::move(values));
+    EXPECT_FALSE(seq.is_view());
+    EXPECT_EQ(seq.get_total_size(), 5);
+    for (int value : copy)
+    {
+        EXPECT_EQ(seq.get_value(value), value);
+    }
+    EXPECT_FALSE(seq.get_value(25).has_value());
+}
+
+/**
+ * @brief Tests that assume_sorted keeps the given order for owned vectors.
+ */
+TEST(DataBlockSequenceZeroCopyTest, AssumeSortedSkipsTheSort)
+{
+    const std::vector<int> values = {10, 20, 30, 40, 50};
+    iterator_mutex::DataBlockSequence from_copy(iterator_mutex::assume_sorted, values);
+    iterator_mutex::DataBlockSequence from_rvalue(iterator_mutex::assume_sorted, std::vector<int>(values));
+
+    for (int value : values)
+    {
+        EXPECT_EQ(from_copy.get_value(value), value);
+        EXPECT_EQ(from_rvalue.get_value(value), value);
+    }
+}
+
+/**
+ * @brief Tests that a view searches the caller's keys in place under every layout and survives a move.
+ */
+TEST(DataBlockSequenceZeroCopyTest, SpanViewSearchesCallerKeys)
+{
+    std::vector<int> keys(1000);
+    std::iota(keys.begin(), keys.end(), 0);
+
+    for (auto layout :
+         {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        iterator_mutex::DataBlockSequence view(iterator_mutex::assume_sorted, std::span<const int>(keys), options);
+        EXPECT_TRUE(view.is_view());
+        EXPECT_EQ(view.get_total_size(), keys.size());
+        EXPECT_EQ(view.get_value(999), 999);
+
+        iterator_mutex::DataBlockSequence moved(std::move(view));
+        EXPECT_TRUE(moved.is_view());
+        EXPECT_FALSE(view.is_view());
+        EXPECT_EQ(view.get_total_size(), 0);
+        for (int value : {0, 1, 500, 999})
+        {
+            EXPECT_EQ(moved.get_value(value), value);
+        }
+        EXPECT_FALSE(moved.get_value(1000).has_value());
+    }
+}
+
+#ifndef NDEBUG
+/**
+ * @brief Tests that debug builds reject unsorted keys passed with assume_sorted.
+ */
+TEST(DataBlockSequenceZeroCopyTest, AssumeSortedChecksOrderInDebugBuilds)
+{
+    const std::vector<int> unsorted = {10, 30, 20};
+    EXPECT_THROW(iterator_mutex::DataBlockSequence(iterator_mutex::assume_sorted, unsorted), std::invalid_argument);
+    EXPECT_THROW(iterator_mutex::DataBlockSequence(iterator_mutex::assume_sorted, std::span<const int>(unsorted)),
+                 std::invalid_argument);
+}
+#endif
+
 // --- GetValue Method ---
 
 /**
@@ -114,6 +197,89 @@ TEST_F(DataBlockSequenceTest, GetValueUsesMruCache)
     ASSERT_EQ(seq_.get_value(10).value(), 10);
 }
 
+// --- Per-Thread MRU Mode ---
+
+/**
+ * @brief Tests that a sequence in per-thread MRU mode answers lookups like the shared mode.
+ *
+ * Verifies that present values are found (including repeated lookups that hit the
+ * thread's own hint) and missing values are reported as empty.
+ */
+TEST(DataBlockSequencePerThreadMruTest, GetValueMatchesSharedMode)
+{
+    iterator_mutex::SequenceOptions options;
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    iterator_mutex::DataBlockSequence seq({50, 10, 40, 20, 30}, options);
+
+    EXPECT_EQ(seq.get_mru_mode(), iterator_mutex::MruMode::PerThread);
+    ASSERT_EQ(seq.get_value(30).value(), 30);
+    ASSERT_EQ(seq.get_value(30).value(), 30);
+    ASSERT_EQ(seq.get_value(10).value(), 10);
+    EXPECT_FALSE(seq.get_value(35).has_value());
+    EXPECT_FALSE(seq.get_value(99).has_value());
+}
+
+/**
+ * @brief Tests that per-thread hints never leak across a move.
+ *
+ * Primes this thread's hint on one sequence, then move-assigns different contents into
+ * it. The stale hint must not produce a result for a value that is no longer present.
+ */
+TEST(DataBlockSequencePerThreadMruTest, HintIsInvalidatedByMoveAssignment)
+{
+    iterator_mutex::SequenceOptions options;
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    iterator_mutex::DataBlockSequence seq({1, 2, 3}, options);
+    iterator_mutex::DataBlockSequence replacement({7, 8}, options);
+
+    ASSERT_EQ(seq.get_value(3).value(), 3);
+    seq = std::move(replacement);
+
+    EXPECT_FALSE(seq.get_value(3).has_value());
+    ASSERT_TRUE(seq.get_value(8).has_value());
+    EXPECT_EQ(seq.get_value(8).value(), 8);
+    EXPECT_FALSE(replacement.get_value(8).has_value());
+    EXPECT_EQ(seq.get_mru_mode(), iterator_mutex::MruMode::PerThread);
+}
+
+/**
+ * @brief Tests that concurrent readers in per-thread MRU mode all get correct results.
+ *
+ * Each thread repeatedly looks up its own key range, so every thread's hint is hit
+ * and replaced many times while the others do the same.
+ */
+TEST(DataBlockSequencePerThreadMruTest, ConcurrentReadsAreSafe)
+{
+    std::vector<int> large_vec(1000);
+    std::iota(large_vec.begin(), large_vec.end(), 0);
+
+    iterator_mutex::SequenceOptions options;
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    const iterator_mutex::DataBlockSequence shared_seq(large_vec, options);
+
+    auto reader_task = [&](int start_value)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            int value_to_find = start_value + (i / 2) % 50;
+            auto val = shared_seq.get_value(value_to_find);
+            ASSERT_TRUE(val.has_value());
+            EXPECT_EQ(val.value(), value_to_find);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 10; ++i)
+    {
+        threads.emplace_back(reader_task, i * 50);
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+}
+
 // --- Move Semantics ---
 
 /**
@@ -177,6 +343,62 @@ TEST_F(DataBlockSequenceTest, MoveAssignmentHandlesSelfAssignment)
     EXPECT_EQ(seq_.get_value(10).value(), 10);
 }
 
+/**
+ * @brief Tests that swap exchanges keys, layouts and filters, also between an owning sequence and a view.
+ */
+TEST_F(DataBlockSequenceTest, SwapExchangesContents)
+{
+    const std::vector<int> caller_keys = {1, 3, 5, 7};
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Eytzinger;
+    options.filter_bits_per_key = 10;
+    iterator_mutex::DataBlockSequence view(iterator_mutex::assume_sorted, std::span<const int>(caller_keys), options);
+    ASSERT_TRUE(view.is_view());
+    ASSERT_EQ(seq_.get_value(10), 10);  // Leaves a hint behind.
+
+    swap(seq_, view);
+    EXPECT_TRUE(seq_.is_view());
+    EXPECT_EQ(seq_.get_layout(), iterator_mutex::Layout::Eytzinger);
+    EXPECT_GT(seq_.get_filter_bytes(), 0);
+    EXPECT_EQ(seq_.get_value(7), 7);
+    EXPECT_EQ(seq_.get_value(10), std::nullopt);
+    EXPECT_FALSE(view.is_view());
+    EXPECT_EQ(view.get_layout(), iterator_mutex::Layout::Sorted);
+    EXPECT_EQ(view.get_filter_bytes(), 0);
+    EXPECT_EQ(view.get_total_size(), 5);
+    EXPECT_EQ(view.get_value(10), 10);
+    EXPECT_EQ(view.get_value(7), std::nullopt);
+
+    view.swap(view);
+    EXPECT_EQ(view.get_value(50), 50);
+}
+
+/**
+ * @brief Tests that std::vector relocates sequences by their noexcept moves and that moved-from ones are reusable.
+ */
+TEST(DataBlockSequenceContainerTest, VectorRelocatesSequences)
+{
+    static_assert(std::is_nothrow_move_constructible_v<iterator_mutex::DataBlockSequence>);
+    static_assert(std::is_nothrow_move_assignable_v<iterator_mutex::DataBlockSequence>);
+    static_assert(std::is_nothrow_swappable_v<iterator_mutex::DataBlockSequence>);
+
+    std::vector<iterator_mutex::DataBlockSequence> sequences;
+    for (int i = 0; i < 100; ++i)
+    {
+        sequences.emplace_back(std::vector<int>{i, i + 1000});
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(sequences[static_cast<size_t>(i)].get_value(i + 1000), i + 1000);
+    }
+
+    iterator_mutex::DataBlockSequence taken(std::move(sequences.front()));
+    EXPECT_EQ(sequences.front().get_total_size(), 0);
+    sequences.front() = iterator_mutex::DataBlockSequence({42});
+    EXPECT_EQ(sequences.front().get_value(42), 42);
+    EXPECT_EQ(taken.get_value(1000), 1000);
+}
+
 // --- Thread Safety ---
 
 /**
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_filter.hpp"
+#include "test_keys.hpp"
+
+using test_keys::even_numbers;
+
+namespace
+{
+
+iterator_mutex::SequenceOptions filter_options(size_t bits_per_key)
+{
+    iterator_mutex::SequenceOptions options;
+    options.filter_bits_per_key = bits_per_key;
+    return options;
+}
+
+}  // namespace
+
+// --- BlockedBloomFilter ---
+
+/**
+ * @brief Tests that inserted hashes are always found and that about 1% of others pass at 10 bits per key.
+ */
+TEST(BlockedBloomFilterTest, NoFalseNegativesAndFewFalsePositives)
+{
+    constexpr size_t kKeys = 100000;
+    iterator_mutex::BlockedBloomFilter filter(kKeys, 10);
+    // 1,000,000 bits are 3906.25 blocks of 256, rounded up.
+    EXPECT_EQ(filter.size_in_bytes(), 3907 * 32);
+
+    std::mt19937_64 rng(21);
+    std::vector<std::uint64_t> inserted(kKeys);
+    for (auto& hash : inserted)
+    {
+        hash = rng();
+        filter.insert(hash);
+    }
+    for (std::uint64_t hash : inserted)
+    {
+        ASSERT_TRUE(filter.may_contain(hash));
+    }
+
+    size_t false_positives = 0;
+    for (size_t i = 0; i < kKeys; ++i)
+    {
+        false_positives += filter.may_contain(rng());
+    }
+    EXPECT_LT(false_positives, kKeys * 2 / 100);
+}
+
+/**
+ * @brief Tests that an empty filter rejects everything.
+ */
+TEST(BlockedBloomFilterTest, EmptyRejectsEverything)
+{
+    const iterator_mutex::BlockedBloomFilter filter(0, 10);
+    EXPECT_EQ(filter.size_in_bytes(), 32);
+    for (std::uint64_t hash : {0ULL, 1ULL, ~0ULL, 0x123456789abcdefULL})
+    {
+        EXPECT_FALSE(filter.may_contain(hash));
+    }
+}
+
+// --- Sequences with a filter ---
+
+/**
+ * @brief Tests that lookups through the filter find every key and no absent one, for every hashable key type.
+ */
+TEST(KeyFilterTest, LookupsMatchWithoutFilter)
+{
+    const iterator_mutex::DataBlockSequence seq(even_numbers(50000), filter_options(10));
+    EXPECT_GT(seq.get_filter_bytes(), 0);
+    for (int v = -10; v < 100010; ++v)
+    {
+        const auto expected = v >= 0 && v < 100000 && v % 2 == 0 ? std::optional<int>(v) : std::nullopt;
+        ASSERT_EQ(seq.get_value(v), expected) << "value " << v;
+        ASSERT_EQ(seq.find_index(v), expected ? std::optional<size_t>(static_cast<size_t>(v / 2)) : std::nullopt);
+    }
+
+    using iterator_mutex::CompositeKey;
+    const iterator_mutex::BasicDataBlockSequence<CompositeKey> composite(
+        std::vector<CompositeKey>{{1, 1}, {1, 2}, {2, 0}, {3, 7}}, filter_options(16));
+    EXPECT_GT(composite.get_filter_bytes(), 0);
+    EXPECT_EQ(composite.get_value(CompositeKey{2, 0}), (CompositeKey{2, 0}));
+    EXPECT_EQ(composite.get_value(CompositeKey{2, 1}), std::nullopt);
+
+    const iterator_mutex::BasicDataBlockSequence<std::uint64_t> wide(std::vector<std::uint64_t>{1, ~0ULL},
+                                                                     filter_options(10));
+    EXPECT_EQ(wide.get_value(~0ULL), ~0ULL);
+    EXPECT_EQ(wide.get_value(2), std::nullopt);
+}
+
+/**
+ * @brief Tests that the filter travels with the keys through move construction and move assignment.
+ */
+TEST(KeyFilterTest, MovesCarryTheFilter)
+{
+    iterator_mutex::DataBlockSequence seq(even_numbers(1000), filter_options(10));
+    const size_t bytes = seq.get_filter_bytes();
+    ASSERT_GT(bytes, 0);
+
+    iterator_mutex::DataBlockSequence moved(std::move(seq));
+    EXPECT_EQ(moved.get_filter_bytes(), bytes);
+    EXPECT_EQ(seq.get_filter_bytes(), 0);
+    EXPECT_EQ(seq.get_value(10), std::nullopt);
+    EXPECT_EQ(moved.get_value(10), 10);
+
+    // Into a sequence without a filter, and over a sequence with one of its own.
+    iterator_mutex::DataBlockSequence plain(std::vector<int>{1, 3, 5});
+    EXPECT_EQ(plain.get_filter_bytes(), 0);
+    plain = std::move(moved);
+    EXPECT_EQ(plain.get_filter_bytes(), bytes);
+    EXPECT_EQ(plain.get_value(998), 998);
+    EXPECT_EQ(plain.get_value(3), std::nullopt);
+
+    iterator_mutex::DataBlockSequence other(std::vector<int>{7, 9}, filter_options(10));
+    other = std::move(plain);
+    EXPECT_EQ(other.get_value(7), std::nullopt);
+    EXPECT_EQ(other.get_value(500), 500);
+    plain = iterator_mutex::DataBlockSequence(std::vector<int>{4});
+    EXPECT_EQ(plain.get_filter_bytes(), 0);
+    EXPECT_EQ(plain.get_value(4), 4);
+}
+
+/**
+ * @brief Tests that readers probing the filter without the lock see one set of keys or the other while moves swap them.
+ */
+TEST(KeyFilterTest, ReadersRaceMoves)
+{
+    // The keys alternate between the even and the odd numbers, so every answer either matches
+    // one of the two sets or is a miss of the moved-from sequence.
+    std::vector<int> odd = even_numbers(4096);
+    for (int& v : odd)
+    {
+        v += 1;
+    }
+    iterator_mutex::DataBlockSequence seq(even_numbers(4096), filter_options(10));
+    std::atomic<bool> stop{false};
+    std::atomic<bool> wrong{false};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+    {
+        readers.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t));
+            std::uniform_int_distribution<int> dist(0, 8191);
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                const int key = dist(rng);
+                const auto value = seq.get_value(key);
+                if (value && *value != key)
+                {
+                    wrong.store(true);
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 50; ++round)
+    {
+        seq = iterator_mutex::DataBlockSequence(round % 2 == 0 ? odd : even_numbers(4096), filter_options(10));
+        iterator_mutex::DataBlockSequence moved(std::move(seq));
+        seq = std::move(moved);
+    }
+    stop.store(true);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_FALSE(wrong.load());
+    EXPECT_EQ(seq.get_value(8190), 8190);
+    EXPECT_EQ(seq.get_value(8191), std::nullopt);
+}
+
+/**
+ * @brief Tests that the stats count filter rejections as lookups that missed.
+ */
+TEST(KeyFilterTest, StatsCountRejections)
+{
+    const iterator_mutex::DataBlockSequence seq(even_numbers(10000), filter_options(16));
+    for (int v = 1; v < 2001; v += 2)
+    {
+        ASSERT_EQ(seq.get_value(v), std::nullopt);
+    }
+    const auto stats = seq.stats();
+    if constexpr (iterator_mutex::kStatsEnabled)
+    {
+        EXPECT_EQ(stats.lookups, 1000);
+        EXPECT_EQ(stats.lookup_hits, 0);
+        EXPECT_GT(stats.filter_rejections, 980);
+    }
+    else
+    {
+        EXPECT_EQ(stats.filter_rejections, 0);
+    }
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_types.hpp"
+#include "search_layouts.hpp"
+#include "snapshot_block_sequence.hpp"
+
+namespace
+{
+
+// The i-th key of a test sequence, strictly increasing in i for every key type.
+template <typename T>
+T make_key(size_t i);
+
+template <>
+std::int64_t make_key<std::int64_t>(size_t i)
+{
+    // Spans the sign bit so that negative and positive keys sit side by side.
+    return static_cast<std::int64_t>(i) * 1000003 - 500000000;
+}
+
+template <>
+std::uint64_t make_key<std::uint64_t>(size_t i)
+{
+    // Crosses 2^63, where a signed compare would get the order wrong.
+    return (std::uint64_t{1} << 63) - 256 * 1000 + i * 1000;
+}
+
+template <>
+iterator_mutex::CompositeKey make_key<iterator_mutex::CompositeKey>(size_t i)
+{
+    // Several keys share a high word, so the order depends on both words.
+    return {i / 7, (i % 7) * 2};
+}
+
+// A key ordered strictly between make_key(i) and make_key(i + 1).
+template <typename T>
+T make_missing_key(size_t i)
+{
+    if constexpr (std::is_same_v<T, iterator_mutex::CompositeKey>)
+    {
+        return {i / 7, (i % 7) * 2 + 1};
+    }
+    else
+    {
+        return make_key<T>(i) + 1;
+    }
+}
+
+}  // namespace
+
+// --- Typed over the Key Types the Library Instantiates ---
+template <typename T>
+class KeyTypeTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t kSize = 300;
+
+    // Keys in descending order, so the constructor has to sort them.
+    static std::vector<T> make_values()
+    {
+        std::vector<T> values;
+        for (size_t i = kSize; i-- > 0;)
+        {
+            values.push_back(make_key<T>(i));
+        }
+        return values;
+    }
+};
+
+using KeyTypes = ::testing::Types<std::int64_t, std::uint64_t, iterator_mutex::CompositeKey>;
+TYPED_TEST_SUITE(KeyTypeTest, KeyTypes);
+
+/**
+ * @brief Tests single lookups of present and missing keys under every layout.
+ */
+TYPED_TEST(KeyTypeTest, GetValueFindsPresentKeysOnly)
+{
+    for (auto layout :
+         {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        iterator_mutex::BasicDataBlockSequence<TypeParam> seq(this->make_values(), options);
+
+        EXPECT_EQ(seq.get_total_size(), this->kSize);
+        for (size_t i = 0; i < this->kSize; ++i)
+        {
+            EXPECT_EQ(seq.get_value(make_key<TypeParam>(i)), make_key<TypeParam>(i)) << "index " << i;
+            EXPECT_EQ(seq.get_value(make_missing_key<TypeParam>(i)), std::nullopt) << "index " << i;
+        }
+    }
+}
+
+/**
+ * @brief Tests both batch paths against single lookups.
+ */
+TYPED_TEST(KeyTypeTest, GetValuesMatchesSingleLookups)
+{
+    iterator_mutex::BasicDataBlockSequence<TypeParam> seq(this->make_values());
+
+    std::vector<TypeParam> keys;
+    for (size_t i = 0; i < this->kSize; i += 3)
+    {
+        keys.push_back(make_key<TypeParam>(i));
+        keys.push_back(make_missing_key<TypeParam>(i));
+    }
+    std::vector<std::optional<TypeParam>> results(keys.size());
+
+    EXPECT_EQ(seq.get_values(keys, results), keys.size() / 2);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(results[i], seq.get_value(keys[i])) << "key index " << i;
+    }
+
+    // Reversed keys take the unsorted path.
+    std::reverse(keys.begin(), keys.end());
+    std::vector<std::uint64_t> found((keys.size() + 63) / 64);
+    EXPECT_EQ(seq.get_values(keys, found), keys.size() / 2);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(((found[i / 64] >> (i % 64)) & 1) != 0, seq.get_value(keys[i]).has_value()) << "key index " << i;
+    }
+}
+
+/**
+ * @brief Tests the per-thread MRU path, which returns the stored key on a hint hit.
+ */
+TYPED_TEST(KeyTypeTest, PerThreadMruReturnsStoredKey)
+{
+    iterator_mutex::BasicDataBlockSequence<TypeParam> seq(this->make_values(), {iterator_mutex::MruMode::PerThread});
+
+    const TypeParam key = make_key<TypeParam>(42);
+    EXPECT_EQ(seq.get_value(key), key);
+    EXPECT_EQ(seq.get_value(key), key);  // Served from the hint.
+    EXPECT_EQ(seq.get_value(make_missing_key<TypeParam>(42)), std::nullopt);
+}
+
+/**
+ * @brief Tests the snapshot handle with a non-int key.
+ */
+TYPED_TEST(KeyTypeTest, SnapshotPublishesKeys)
+{
+    iterator_mutex::BasicSnapshotBlockSequence<TypeParam> handle(this->make_values());
+    EXPECT_EQ(handle.get_value(make_key<TypeParam>(7)), make_key<TypeParam>(7));
+
+    handle.publish(std::vector<TypeParam>{make_missing_key<TypeParam>(7)});
+    EXPECT_EQ(handle.get_total_size(), 1);
+    EXPECT_EQ(handle.get_value(make_key<TypeParam>(7)), std::nullopt);
+    EXPECT_EQ(handle.get_value(make_missing_key<TypeParam>(7)), make_missing_key<TypeParam>(7));
+}
+
+/**
+ * @brief Tests that every layout honours a descending comparator.
+ */
+TEST(BlockIndexTest, DescendingComparatorMatchesStd)
+{
+    std::vector<std::uint64_t> blocks(1000);
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i] = (blocks.size() - i) * 2;
+    }
+
+    for (auto layout :
+         {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree})
+    {
+        const iterator_mutex::BlockIndex<std::uint64_t, std::greater<std::uint64_t>> index(layout, blocks);
+        for (std::uint64_t value = 0; value <= 2002; ++value)
+        {
+            const auto expected = static_cast<size_t>(
+                std::lower_bound(blocks.begin(), blocks.end(), value, std::greater<>()) - blocks.begin());
+            EXPECT_EQ(index.lower_bound(blocks, value), expected) << "value " << value;
+        }
+    }
+}
@@ -0,0 +1,381 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+namespace
+{
+
+// Waits for future, and aborts if it does not become ready in time: the threads it waits for
+// are deadlocked and could never be joined.
+void wait_or_abort(std::future<void>& future, const char* what)
+{
+    if (future.wait_for(std::chrono::seconds(10)) != std::future_status::ready)
+    {
+        std::fprintf(stderr, "%s did not finish: deadlock\n", what);
+        std::abort();
+    }
+    future.get();
+}
+
+}  // namespace
+
+// --- Typed Fixture over every Lock Policy ---
+template <typename LockPolicy>
+class LockPolicySequenceTest : public ::testing::Test
+{
+protected:
+    using Sequence = iterator_mutex::BasicDataBlockSequence<int, std::less<int>, LockPolicy>;
+};
+
+using LockPolicies =
+    ::testing::Types<iterator_mutex::ExclusiveMutex, std::shared_mutex, iterator_mutex::EpochMutex>;
+TYPED_TEST_SUITE(LockPolicySequenceTest, LockPolicies);
+
+/**
+ * @brief Tests that every lock policy gives the same lookup results.
+ */
+TYPED_TEST(LockPolicySequenceTest, GetValueRetrievesCorrectValues)
+{
+    typename TestFixture::Sequence seq({50, 10, 40, 20, 30});
+
+    EXPECT_EQ(seq.get_total_size(), 5);
+    ASSERT_TRUE(seq.get_value(40).has_value());
+    EXPECT_EQ(seq.get_value(40).value(), 40);
+    EXPECT_FALSE(seq.get_value(45).has_value());
+}
+
+/**
+ * @brief Tests that both move operations work with every lock policy.
+ */
+TYPED_TEST(LockPolicySequenceTest, MoveOperationsTransferState)
+{
+    typename TestFixture::Sequence seq({3, 1, 2});
+    typename TestFixture::Sequence moved(std::move(seq));
+    EXPECT_EQ(moved.get_total_size(), 3);
+    EXPECT_EQ(seq.get_total_size(), 0);
+
+    typename TestFixture::Sequence target({9});
+    target = std::move(moved);
+    EXPECT_EQ(target.get_total_size(), 3);
+    EXPECT_TRUE(target.get_value(2).has_value());
+    EXPECT_FALSE(moved.get_value(2).has_value());
+}
+
+/**
+ * @brief Tests readers in both MRU modes racing against repeated move assignments.
+ *
+ * Readers keep looking up a value that is present in both sequences being swapped back
+ * and forth, so every lookup must succeed no matter which contents it sees.
+ */
+TYPED_TEST(LockPolicySequenceTest, ReadersRunConcurrentlyWithMoves)
+{
+    using Sequence = typename TestFixture::Sequence;
+
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+
+    for (auto mode : {iterator_mutex::MruMode::Shared, iterator_mutex::MruMode::PerThread})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.mru_mode = mode;
+        Sequence shared_seq(values, options);
+        Sequence spare(values, options);
+
+        std::atomic<bool> keep_reading = true;
+        std::atomic<int> failures = 0;
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; ++r)
+        {
+            readers.emplace_back(
+                [&, r]()
+                {
+                    int i = r;
+                    while (keep_reading)
+                    {
+                        const int key = (i++ * 7) % 1000;
+                        auto val = shared_seq.get_value(key);
+                        if (val.has_value() && val.value() != key)
+                        {
+                            ++failures;
+                        }
+                        // std::shared_mutex may prefer readers; leave the mover a window.
+                        std::this_thread::yield();
+                    }
+                });
+        }
+
+        for (int i = 0; i < 200; ++i)
+        {
+            Sequence tmp(std::move(shared_seq));
+            shared_seq = std::move(spare);
+            spare = std::move(tmp);
+        }
+
+        keep_reading = false;
+        for (auto& t : readers)
+        {
+            t.join();
+        }
+
+        EXPECT_EQ(failures, 0);
+        EXPECT_EQ(shared_seq.get_total_size() + spare.get_total_size(), 2000u);
+    }
+}
+
+/**
+ * @brief Tests moves and swaps that lock two sequences while a reader holds a snapshot of one of them and
+ *        then reads the other.
+ *
+ * The writer may lock either sequence first. Whichever it cannot get at once, it must let go of the
+ * other, or the reader's lookup waits behind it while it waits for the reader's snapshot.
+ */
+TYPED_TEST(LockPolicySequenceTest, ReaderAcrossTwoSequencesDoesNotBlockWriter)
+{
+    using Sequence = typename TestFixture::Sequence;
+
+    for (const bool swap : {false, true})
+    {
+        for (const bool snapshot_source : {false, true})
+        {
+            Sequence a({1, 2, 3});
+            Sequence b({4, 5, 6});
+            Sequence& held = snapshot_source ? b : a;
+            Sequence& read = snapshot_source ? a : b;
+            const int held_key = snapshot_source ? 5 : 2;
+            const int read_key = snapshot_source ? 2 : 5;
+
+            std::promise<void> snapshot_taken;
+            std::promise<void> writer_started;
+            auto writer_started_future = writer_started.get_future();
+            std::packaged_task<void()> reader_task(
+                [&]()
+                {
+                    const auto snapshot = held.snapshot();
+                    snapshot_taken.set_value();
+                    writer_started_future.wait();
+                    // Give the writer time to take one lock and reach the other.
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    EXPECT_EQ(read.get_value(read_key), read_key);
+                    EXPECT_EQ(snapshot.get_value(held_key), held_key);
+                });
+            auto reader_done = reader_task.get_future();
+            std::thread reader(std::move(reader_task));
+            snapshot_taken.get_future().wait();
+
+            std::packaged_task<void()> writer_task(
+                [&]()
+                {
+                    if (swap)
+                    {
+                        a.swap(b);
+                    }
+                    else
+                    {
+                        a = std::move(b);
+                    }
+                });
+            auto writer_done = writer_task.get_future();
+            std::thread writer(std::move(writer_task));
+            writer_started.set_value();
+
+            wait_or_abort(reader_done, "reader");
+            wait_or_abort(writer_done, swap ? "swap" : "move assignment");
+            reader.join();
+            writer.join();
+            EXPECT_EQ(a.get_value(5), 5);
+            EXPECT_EQ(b.get_total_size(), swap ? 3 : 0);
+        }
+    }
+}
+
+/**
+ * @brief Tests set operations, which hold the shared locks of both inputs at once, racing swaps of them.
+ */
+TYPED_TEST(LockPolicySequenceTest, SetOperationsRunConcurrentlyWithSwaps)
+{
+    using Sequence = typename TestFixture::Sequence;
+
+    std::vector<int> evens(1000);
+    std::vector<int> thirds(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        evens[static_cast<size_t>(i)] = 2 * i;
+        thirds[static_cast<size_t>(i)] = 3 * i;
+    }
+    Sequence a(evens);
+    Sequence b(thirds);
+    // The multiples of 6 below 2000, whichever way round the two are.
+    constexpr size_t kCommon = 334;
+
+    std::promise<void> readers_running;
+    std::packaged_task<void()> reader_task(
+        [&]()
+        {
+            readers_running.set_value();
+            for (int i = 0; i < 200; ++i)
+            {
+                EXPECT_EQ(Sequence::intersect_count(a, b), kCommon);
+                std::this_thread::yield();
+            }
+        });
+    auto reader_done = reader_task.get_future();
+    std::thread reader(std::move(reader_task));
+    readers_running.get_future().wait();
+
+    std::packaged_task<void()> writer_task(
+        [&]()
+        {
+            for (int i = 0; i < 200; ++i)
+            {
+                a.swap(b);
+                std::this_thread::yield();
+            }
+        });
+    auto writer_done = writer_task.get_future();
+    std::thread writer(std::move(writer_task));
+
+    wait_or_abort(reader_done, "intersect_count");
+    wait_or_abort(writer_done, "swap");
+    reader.join();
+    writer.join();
+    EXPECT_EQ(a.get_total_size() + b.get_total_size(), 2000u);
+}
+
+// --- EpochMutex ---
+
+/**
+ * @brief Tests that EpochMutex admits several readers but excludes a writer while any are active.
+ */
+TEST(EpochMutexTest, ReadersShareAndWritersExclude)
+{
+    iterator_mutex::EpochMutex mutex;
+
+    mutex.lock_shared();
+    std::thread other_reader(
+        [&]()
+        {
+            EXPECT_TRUE(mutex.try_lock_shared());
+            mutex.unlock_shared();
+        });
+    other_reader.join();
+
+    std::atomic<bool> writer_done = false;
+    std::thread writer(
+        [&]()
+        {
+            mutex.lock();
+            writer_done = true;
+            mutex.unlock();
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(writer_done);
+
+    mutex.unlock_shared();
+    writer.join();
+    EXPECT_TRUE(writer_done);
+}
+
+/**
+ * @brief Tests that readers are kept out while a writer holds EpochMutex.
+ */
+TEST(EpochMutexTest, WriterBlocksNewReaders)
+{
+    iterator_mutex::EpochMutex mutex;
+
+    mutex.lock();
+    std::thread reader(
+        [&]()
+        {
+            EXPECT_FALSE(mutex.try_lock_shared());
+        });
+    reader.join();
+    mutex.unlock();
+
+    EXPECT_TRUE(mutex.try_lock_shared());
+    mutex.unlock_shared();
+}
+
+/**
+ * @brief Tests that try_lock backs off instead of waiting for readers, and lets new readers in after.
+ */
+TEST(EpochMutexTest, TryLockFailsWhileReadersHold)
+{
+    iterator_mutex::EpochMutex mutex;
+
+    mutex.lock_shared();
+    std::packaged_task<void()> writer_task([&]() { EXPECT_FALSE(mutex.try_lock()); });
+    auto writer_done = writer_task.get_future();
+    std::thread writer(std::move(writer_task));
+    wait_or_abort(writer_done, "try_lock");
+    writer.join();
+
+    // The failed attempt left no writer behind to keep readers out.
+    std::thread reader(
+        [&]()
+        {
+            EXPECT_TRUE(mutex.try_lock_shared());
+            mutex.unlock_shared();
+        });
+    reader.join();
+    mutex.unlock_shared();
+
+    EXPECT_TRUE(mutex.try_lock());
+    mutex.unlock();
+}
+
+/**
+ * @brief Tests that a move between two EpochMutex sequences finishes while a reader holds a snapshot of
+ *        its source and then reads its target.
+ *
+ * The move locks its target, then tries the source. A try_lock that waited for the snapshot would keep
+ * the target's writer flag up, which blocks the reader's lookup on the target, which keeps the snapshot.
+ */
+TEST(EpochMutexTest, MoveFinishesWhileSourceSnapshotReadsTarget)
+{
+    using Sequence = iterator_mutex::BasicDataBlockSequence<int, std::less<int>, iterator_mutex::EpochMutex>;
+    Sequence a({1, 2, 3});
+    Sequence b({4, 5, 6});
+
+    std::promise<void> snapshot_taken;
+    std::promise<void> mover_started;
+    auto mover_started_future = mover_started.get_future();
+    std::packaged_task<void()> reader_task(
+        [&]()
+        {
+            const auto snapshot = b.snapshot();
+            snapshot_taken.set_value();
+            mover_started_future.wait();
+            // Give the mover time to lock a and reach b.
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            EXPECT_EQ(a.get_value(2), 2);
+            EXPECT_EQ(snapshot.get_value(5), 5);
+        });
+    auto reader_done = reader_task.get_future();
+    std::thread reader(std::move(reader_task));
+    snapshot_taken.get_future().wait();
+
+    std::packaged_task<void()> mover_task([&]() { a = std::move(b); });
+    auto mover_done = mover_task.get_future();
+    std::thread mover(std::move(mover_task));
+    mover_started.set_value();
+
+    wait_or_abort(reader_done, "reader");
+    wait_or_abort(mover_done, "move assignment");
+    reader.join();
+    mover.join();
+    EXPECT_EQ(a.get_value(5), 5);
+    EXPECT_EQ(b.get_total_size(), 0);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "memory_resources.hpp"
+
+namespace
+{
+
+constexpr size_t kKeyCount = 1 << 19;  // 2MB of int keys, above the default recycling threshold.
+
+std::pmr::vector<int> make_keys(std::pmr::memory_resource* resource, int offset)
+{
+    std::pmr::vector<int> keys(resource);
+    keys.reserve(kKeyCount);
+    for (size_t i = kKeyCount; i-- > 0;)
+    {
+        keys.push_back(static_cast<int>(i) * 2 + offset);
+    }
+    return keys;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that a pmr sequence keeps the vector's buffer and resource, and a rebuild reuses the freed buffer.
+ */
+TEST(MemoryResourcesTest, RebuildReusesRecycledBuffer)
+{
+    iterator_mutex::RecyclingResource recycling;
+    auto keys = make_keys(&recycling, 0);
+    const int* buffer = keys.data();
+
+    iterator_mutex::pmr::DataBlockSequence seq(std::move(keys));
+    EXPECT_EQ(seq.get_keys().data(), buffer);
+    EXPECT_EQ(seq.get_value(10), 10);
+    EXPECT_EQ(seq.get_value(11), std::nullopt);
+
+    // Each cycle frees the previous keys into the cache, and the next cycle picks them up.
+    for (int cycle = 1; cycle <= 3; ++cycle)
+    {
+        seq = iterator_mutex::pmr::DataBlockSequence(make_keys(&recycling, cycle % 2));
+        EXPECT_EQ(seq.get_total_size(), kKeyCount);
+        EXPECT_EQ(seq.get_value(21), cycle % 2 == 1 ? std::optional<int>(21) : std::nullopt);
+    }
+    EXPECT_GE(recycling.reuse_count(), 2);
+    EXPECT_GT(recycling.cached_bytes(), 0);
+
+    recycling.release();
+    EXPECT_EQ(recycling.cached_bytes(), 0);
+}
+
+/**
+ * @brief Tests that move assignment between sequences on different resources keeps the target's resource.
+ */
+TEST(MemoryResourcesTest, MoveBetweenResources)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    iterator_mutex::RecyclingResource recycling;
+
+    iterator_mutex::pmr::DataBlockSequence target(std::pmr::vector<int>({5, 1, 3}, &arena));
+    iterator_mutex::pmr::DataBlockSequence source(make_keys(&recycling, 1));
+    target = std::move(source);
+
+    EXPECT_EQ(target.get_total_size(), kKeyCount);
+    EXPECT_EQ(target.get_value(7), 7);
+    EXPECT_EQ(target.get_value(8), std::nullopt);
+    EXPECT_EQ(target.get_value(5), 5);
+    EXPECT_EQ(source.get_total_size(), 0);
+    EXPECT_EQ(source.get_value(7), std::nullopt);
+}
+
+/**
+ * @brief Tests that swap between sequences on different resources moves the keys across both ways.
+ */
+TEST(MemoryResourcesTest, SwapBetweenResources)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    iterator_mutex::RecyclingResource recycling;
+
+    iterator_mutex::pmr::DataBlockSequence small(std::pmr::vector<int>({5, 1, 3}, &arena));
+    iterator_mutex::pmr::DataBlockSequence large(make_keys(&recycling, 1));
+    small.swap(large);
+
+    EXPECT_EQ(small.get_total_size(), kKeyCount);
+    EXPECT_EQ(small.get_value(7), 7);
+    EXPECT_EQ(small.get_value(8), std::nullopt);
+    EXPECT_EQ(large.get_total_size(), 3);
+    EXPECT_EQ(large.get_value(5), 5);
+}
+
+/**
+ * @brief Tests that large allocations are mapped on whole 2MB-aligned huge pages and small ones are not.
+ */
+TEST(MemoryResourcesTest, HugePageAllocations)
+{
+    iterator_mutex::HugePageResource resource;
+    EXPECT_EQ(resource.pages(), iterator_mutex::HugePages::Transparent);
+
+    void* small = resource.allocate(4096, 64);
+    EXPECT_EQ(resource.mapped_bytes(), 0);
+
+    const size_t bytes = (size_t{3} << 20) + 1;
+    void* large = resource.allocate(bytes, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % (size_t{2} << 20), 0);
+    EXPECT_EQ(resource.mapped_bytes(), size_t{4} << 20);
+    std::memset(large, 0x5a, bytes);
+
+    resource.deallocate(large, bytes, 64);
+    resource.deallocate(small, 4096, 64);
+    EXPECT_EQ(resource.mapped_bytes(), 0);
+    EXPECT_THROW(static_cast<void>(resource.allocate(size_t{4} << 20, size_t{4} << 20)), std::bad_alloc);
+}
+
+/**
+ * @brief Tests that with 1GB pages an allocation of a few MB is still mapped, on 2MB pages rather than a whole 1GB one.
+ */
+TEST(MemoryResourcesTest, ExplicitOneGigabyteMapsSmallAllocationsOnTransparentPages)
+{
+    iterator_mutex::HugePageResource resource(iterator_mutex::HugePages::Explicit1G);
+
+    const size_t bytes = (size_t{3} << 20) + 1;
+    void* p = resource.allocate(bytes, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % (size_t{2} << 20), 0);
+    EXPECT_EQ(resource.mapped_bytes(), size_t{4} << 20);
+    std::memset(p, 0x5a, bytes);
+
+    resource.deallocate(p, bytes, 64);
+    EXPECT_EQ(resource.mapped_bytes(), 0);
+}
+
+/**
+ * @brief Tests that explicit huge pages fall back to transparent ones when no hugetlb pool is configured.
+ */
+TEST(MemoryResourcesTest, ExplicitHugePagesFallBack)
+{
+    iterator_mutex::HugePageResource resource(iterator_mutex::HugePages::Explicit2M);
+    iterator_mutex::RecyclingResource recycling(&resource);
+
+    {
+        iterator_mutex::pmr::DataBlockSequence seq(make_keys(&recycling, 0));
+        EXPECT_EQ(seq.get_value(4), 4);
+        EXPECT_EQ(seq.get_value(5), std::nullopt);
+        EXPECT_GT(resource.mapped_bytes(), 0);
+    }
+    // The keys are cached rather than unmapped, until the cache is released.
+    EXPECT_GT(resource.mapped_bytes(), 0);
+    recycling.release();
+    EXPECT_EQ(resource.mapped_bytes(), 0);
+}
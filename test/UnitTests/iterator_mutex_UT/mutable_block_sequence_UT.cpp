@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "key_types.hpp"
+#include "mutable_block_sequence.hpp"
+
+namespace
+{
+
+// Compacts only when asked, so tests control when the delta is merged.
+iterator_mutex::MutableSequenceOptions manual_compaction()
+{
+    iterator_mutex::MutableSequenceOptions options;
+    options.compaction_threshold = SIZE_MAX;
+    options.background_compaction = false;
+    return options;
+}
+
+}  // namespace
+
+// --- MutableBlockSequence ---
+
+/**
+ * @brief Tests that inserts and erases are visible to the next lookup, before any compaction.
+ */
+TEST(MutableBlockSequenceTest, InsertAndEraseAreVisibleImmediately)
+{
+    iterator_mutex::MutableBlockSequence sequence({10, 20, 30}, manual_compaction());
+
+    EXPECT_TRUE(sequence.insert(15));
+    EXPECT_TRUE(sequence.erase(20));
+    EXPECT_EQ(sequence.get_value(15), 15);
+    EXPECT_EQ(sequence.get_value(20), std::nullopt);
+    EXPECT_EQ(sequence.get_value(30), 30);
+    EXPECT_EQ(sequence.get_total_size(), 3);
+    EXPECT_EQ(sequence.get_pending_changes(), 2);
+
+    // Undoing a change removes it from the delta instead of stacking a second entry.
+    EXPECT_TRUE(sequence.insert(20));
+    EXPECT_TRUE(sequence.erase(15));
+    EXPECT_EQ(sequence.get_pending_changes(), 0);
+    EXPECT_EQ(sequence.get_value(20), 20);
+    EXPECT_EQ(sequence.get_total_size(), 3);
+}
+
+/**
+ * @brief Tests that changes which would not alter the contents are rejected and not recorded.
+ */
+TEST(MutableBlockSequenceTest, RedundantChangesReturnFalse)
+{
+    iterator_mutex::MutableBlockSequence sequence({1, 2, 2, 3}, manual_compaction());
+
+    // Duplicates in the initial keys collapse into one.
+    EXPECT_EQ(sequence.get_total_size(), 3);
+    EXPECT_FALSE(sequence.insert(2));
+    EXPECT_FALSE(sequence.erase(7));
+    EXPECT_TRUE(sequence.insert(7));
+    EXPECT_FALSE(sequence.insert(7));
+    EXPECT_EQ(sequence.get_pending_changes(), 1);
+    EXPECT_EQ(sequence.get_total_size(), 4);
+}
+
+/**
+ * @brief Tests that compact() folds the delta into the base array without changing any lookup.
+ */
+TEST(MutableBlockSequenceTest, CompactMatchesReferenceSet)
+{
+    std::vector<int> values;
+    for (int i = 0; i < 3000; i += 3)
+    {
+        values.push_back(i);
+    }
+    std::set<int> expected(values.begin(), values.end());
+    iterator_mutex::MutableBlockSequence sequence(values, manual_compaction());
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> key(-10, 3010);
+    for (int round = 0; round < 4; ++round)
+    {
+        for (int i = 0; i < 500; ++i)
+        {
+            const int k = key(rng);
+            if (rng() % 2 == 0)
+            {
+                EXPECT_EQ(sequence.insert(k), expected.insert(k).second);
+            }
+            else
+            {
+                EXPECT_EQ(sequence.erase(k), expected.erase(k) == 1);
+            }
+        }
+
+        sequence.compact();
+        EXPECT_EQ(sequence.get_pending_changes(), 0);
+        EXPECT_EQ(sequence.get_total_size(), expected.size());
+        for (int k = -10; k <= 3010; ++k)
+        {
+            EXPECT_EQ(sequence.get_value(k).has_value(), expected.count(k) == 1) << "round " << round << " key " << k;
+        }
+    }
+}
+
+/**
+ * @brief Tests that the write reaching the threshold compacts inline when there is no background thread.
+ */
+TEST(MutableBlockSequenceTest, ThresholdTriggersInlineCompaction)
+{
+    auto options = manual_compaction();
+    options.compaction_threshold = 8;
+    iterator_mutex::MutableBlockSequence sequence({}, options);
+
+    for (int i = 0; i < 7; ++i)
+    {
+        sequence.insert(i);
+    }
+    EXPECT_EQ(sequence.get_pending_changes(), 7);
+    sequence.insert(7);
+    EXPECT_EQ(sequence.get_pending_changes(), 0);
+    EXPECT_EQ(sequence.get_total_size(), 8);
+    EXPECT_EQ(sequence.get_value(7), 7);
+}
+
+/**
+ * @brief Tests that the background thread compacts once the threshold is reached.
+ */
+TEST(MutableBlockSequenceTest, BackgroundCompactionDrainsDelta)
+{
+    iterator_mutex::MutableSequenceOptions options;
+    options.compaction_threshold = 64;
+    iterator_mutex::MutableBlockSequence sequence({}, options);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        sequence.insert(i);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (sequence.get_pending_changes() != 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(sequence.get_pending_changes(), 0);
+    EXPECT_EQ(sequence.get_total_size(), 64);
+    EXPECT_EQ(sequence.get_value(63), 63);
+}
+
+/**
+ * @brief Tests wide and composite keys, which go through the same delta and merge.
+ */
+TEST(MutableBlockSequenceTest, WorksForEveryKeyType)
+{
+    iterator_mutex::BasicMutableBlockSequence<std::uint64_t> ids({std::uint64_t{1} << 63, 5}, manual_compaction());
+    EXPECT_TRUE(ids.erase(5));
+    EXPECT_TRUE(ids.insert(UINT64_MAX));
+    ids.compact();
+    EXPECT_EQ(ids.get_value(5), std::nullopt);
+    EXPECT_EQ(ids.get_value(UINT64_MAX), UINT64_MAX);
+
+    iterator_mutex::BasicMutableBlockSequence<iterator_mutex::CompositeKey> pairs({{1, 2}, {3, 4}},
+                                                                                  manual_compaction());
+    EXPECT_TRUE(pairs.insert({1, 3}));
+    pairs.compact();
+    EXPECT_EQ(pairs.get_value({1, 3}), (iterator_mutex::CompositeKey{1, 3}));
+    EXPECT_EQ(pairs.get_total_size(), 3);
+}
+
+/**
+ * @brief Tests readers racing against writers and background compactions.
+ *
+ * Writers only touch odd keys, so every even key must be found no matter which version
+ * a lookup lands on. A use-after-free would typically crash here or show up under a sanitizer.
+ */
+TEST(MutableBlockSequenceTest, ReadersRunConcurrentlyWithWritesAndCompactions)
+{
+    std::vector<int> values;
+    for (int i = 0; i < 2000; i += 2)
+    {
+        values.push_back(i);
+    }
+    iterator_mutex::MutableSequenceOptions options;
+    options.compaction_threshold = 100;
+    iterator_mutex::MutableBlockSequence sequence(values, options);
+
+    std::atomic<bool> keep_reading = true;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back(
+            [&, r]()
+            {
+                int i = r;
+                while (keep_reading)
+                {
+                    const int key = (i++ * 26) % 2000;
+                    if (sequence.get_value(key) != key)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+    }
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        const int key = (i * 7 % 1000) * 2 + 1;
+        if (i % 3 == 0)
+        {
+            sequence.erase(key);
+        }
+        else
+        {
+            sequence.insert(key);
+        }
+    }
+
+    keep_reading = false;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    EXPECT_EQ(failures, 0);
+    sequence.compact();
+    EXPECT_EQ(sequence.get_pending_changes(), 0);
+}
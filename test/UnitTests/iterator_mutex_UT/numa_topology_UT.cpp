@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <sched.h>
+
+#include "numa_topology.hpp"
+
+// --- Test Fixture for Fake sysfs Trees ---
+class NumaTopologyTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory_ = std::filesystem::temp_directory_path() /
+                     (std::string("iterator_mutex_") + info->test_suite_name() + "_" + info->name());
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory_);
+    }
+
+    void add_node(const std::string& name, const std::string& cpulist)
+    {
+        std::filesystem::create_directories(directory_ / name);
+        std::ofstream(directory_ / name / "cpulist") << cpulist << "\n";
+    }
+
+    std::filesystem::path directory_;
+};
+
+/**
+ * @brief Tests that nodes are numbered densely in kernel id order and CPU lists are expanded.
+ */
+TEST_F(NumaTopologyTest, ParsesNodesAndCpuLists)
+{
+    add_node("node2", "4-5,7");
+    add_node("node0", "0-3");
+    add_node("node1", "");  // Memory only.
+    add_node("nodefoo", "9");
+    add_node("possible", "0-2");
+
+    const iterator_mutex::NumaTopology topology(directory_.string());
+    ASSERT_EQ(topology.node_count(), 2);
+    EXPECT_EQ(topology.cpus_of(0), (std::vector<int>{0, 1, 2, 3}));
+    EXPECT_EQ(topology.cpus_of(1), (std::vector<int>{4, 5, 7}));
+    EXPECT_EQ(topology.node_of_cpu(2), 0);
+    EXPECT_EQ(topology.node_of_cpu(7), 1);
+    EXPECT_EQ(topology.node_of_cpu(6), 0);
+    EXPECT_EQ(topology.node_of_cpu(1000), 0);
+    EXPECT_THROW(topology.cpus_of(2), std::out_of_range);
+}
+
+/**
+ * @brief Tests that a missing node directory falls back to a single node.
+ */
+TEST_F(NumaTopologyTest, MissingDirectoryIsOneNode)
+{
+    const iterator_mutex::NumaTopology topology((directory_ / "missing").string());
+    EXPECT_EQ(topology.node_count(), 1);
+    EXPECT_FALSE(topology.cpus_of(0).empty());
+    EXPECT_EQ(topology.current_node(), 0);
+    EXPECT_GE(iterator_mutex::NumaTopology::system().node_count(), 1);
+}
+
+/**
+ * @brief Tests that every node runs its function once, pinned to its CPUs, and errors come back.
+ */
+TEST_F(NumaTopologyTest, RunOnEachNodePinsAndRethrows)
+{
+    const int cpu = ::sched_getcpu();
+    ASSERT_GE(cpu, 0);
+    add_node("node0", std::to_string(cpu));
+    add_node("node1", std::to_string(cpu));
+    const iterator_mutex::NumaTopology topology(directory_.string());
+
+    std::atomic<int> runs = 0;
+    std::atomic<int> pinned = 0;
+    topology.run_on_each_node(
+        [&](size_t)
+        {
+            ++runs;
+            pinned += ::sched_getcpu() == cpu;
+        });
+    EXPECT_EQ(runs, 2);
+    EXPECT_EQ(pinned, 2);
+
+    EXPECT_THROW(topology.run_on_each_node(
+                     [](size_t node)
+                     {
+                         if (node == 1)
+                         {
+                             throw std::runtime_error("node 1");
+                         }
+                     }),
+                 std::runtime_error);
+}
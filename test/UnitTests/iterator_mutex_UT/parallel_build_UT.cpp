@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "parallel_sort.hpp"
+#include "thread_pool.hpp"
+
+// --- Thread Pool ---
+
+/**
+ * @brief Tests that parallel_for calls the function exactly once per index.
+ */
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce)
+{
+    iterator_mutex::ThreadPool pool(3);
+    EXPECT_EQ(pool.size(), 3);
+
+    for (size_t count : {0, 1, 2, 3, 4, 1000})
+    {
+        std::vector<std::atomic<int>> visits(count);
+        pool.parallel_for(count, [&](size_t i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+        for (size_t i = 0; i < count; ++i)
+        {
+            EXPECT_EQ(visits[i].load(), 1) << "count " << count << " index " << i;
+        }
+    }
+}
+
+/**
+ * @brief Tests that an exception thrown by one call reaches the caller.
+ */
+TEST(ThreadPoolTest, ParallelForRethrowsFirstException)
+{
+    iterator_mutex::ThreadPool pool(2);
+    EXPECT_THROW(pool.parallel_for(100,
+                                   [](size_t i)
+                                   {
+                                       if (i == 42)
+                                       {
+                                           throw std::runtime_error("boom");
+                                       }
+                                   }),
+                 std::runtime_error);
+
+    // The pool stays usable.
+    std::atomic<size_t> calls{0};
+    pool.parallel_for(10, [&](size_t) { ++calls; });
+    EXPECT_EQ(calls.load(), 10);
+}
+
+/**
+ * @brief Tests that a call made from inside a pool task completes instead of deadlocking.
+ */
+TEST(ThreadPoolTest, NestedParallelForCompletes)
+{
+    iterator_mutex::ThreadPool pool(2);
+    std::atomic<size_t> calls{0};
+    pool.parallel_for(4, [&](size_t) { pool.parallel_for(8, [&](size_t) { ++calls; }); });
+    EXPECT_EQ(calls.load(), 32);
+}
+
+// --- Parallel Sort ---
+
+/**
+ * @brief Tests parallel_sort against std::sort for sizes around the run and piece boundaries.
+ */
+TEST(ParallelSortTest, MatchesStdSort)
+{
+    iterator_mutex::ThreadPool pool(4);
+    std::mt19937 rng(5);
+
+    for (size_t n : {0, 1, 100, 16383, 16384, 32768, 50001, 81920, 300000})
+    {
+        // Few distinct values, so runs share many duplicates across the merge splits.
+        std::uniform_int_distribution<int> dist(-1000, 1000);
+        std::vector<int> values(n);
+        std::generate(values.begin(), values.end(), [&]() { return dist(rng); });
+        std::vector<int> expected = values;
+        std::sort(expected.begin(), expected.end());
+
+        iterator_mutex::parallel_sort(values, std::less<int>(), &pool);
+        EXPECT_EQ(values, expected) << "n " << n;
+    }
+}
+
+/**
+ * @brief Tests that every pool size, including none, sorts by the given comparator.
+ */
+TEST(ParallelSortTest, HonoursComparatorForEveryPoolSize)
+{
+    std::mt19937_64 rng(9);
+    std::vector<std::uint64_t> input(200000);
+    std::generate(input.begin(), input.end(), [&]() { return rng(); });
+    std::vector<std::uint64_t> expected = input;
+    std::sort(expected.begin(), expected.end(), std::greater<>());
+
+    iterator_mutex::parallel_sort(input, std::greater<>(), nullptr);
+    EXPECT_EQ(input, expected);
+
+    for (size_t threads : {1, 2, 6})
+    {
+        iterator_mutex::ThreadPool pool(threads);
+        std::shuffle(input.begin(), input.end(), rng);
+        iterator_mutex::parallel_sort(input, std::greater<>(), &pool);
+        EXPECT_EQ(input, expected) << "threads " << threads;
+    }
+}
+
+// --- Parallel Sequence Build ---
+
+/**
+ * @brief Tests that a sequence built on a pool answers exactly like one built inline, for every layout.
+ */
+TEST(ParallelBuildTest, PoolBuildMatchesSerialBuild)
+{
+    iterator_mutex::ThreadPool pool(3);
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> dist(0, 400000);
+    std::vector<int> values(200000);
+    std::generate(values.begin(), values.end(), [&]() { return dist(rng); });
+
+    std::vector<int> keys(20000);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+
+    for (auto layout :
+         {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        iterator_mutex::DataBlockSequence serial(values, options);
+        options.build_pool = &pool;
+        iterator_mutex::DataBlockSequence parallel(values, options);
+
+        EXPECT_EQ(parallel.get_total_size(), values.size());
+        for (int key : keys)
+        {
+            EXPECT_EQ(parallel.get_value(key), serial.get_value(key)) << "key " << key;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "mpmc_queue.hpp"
+#include "query_executor.hpp"
+
+namespace
+{
+
+// Sequence i holds the multiples of i + 1 in [0, 1000).
+std::vector<iterator_mutex::DataBlockSequence> make_sequences(int count)
+{
+    std::vector<iterator_mutex::DataBlockSequence> sequences;
+    for (int i = 0; i < count; ++i)
+    {
+        std::vector<int> keys;
+        for (int key = 0; key < 1000; key += i + 1)
+        {
+            keys.push_back(key);
+        }
+        sequences.emplace_back(iterator_mutex::assume_sorted, std::move(keys));
+    }
+    return sequences;
+}
+
+}  // namespace
+
+// --- MpmcQueue ---
+
+/**
+ * @brief Tests FIFO order and the full and empty edges of a single-threaded queue.
+ */
+TEST(MpmcQueueTest, FifoWithinCapacity)
+{
+    iterator_mutex::MpmcQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4);
+
+    int out = 0;
+    EXPECT_FALSE(queue.try_pop(out));
+    for (int lap = 0; lap < 3; ++lap)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            int value = lap * 10 + i;
+            ASSERT_TRUE(queue.try_push(value));
+        }
+        int extra = -1;
+        EXPECT_FALSE(queue.try_push(extra));
+        EXPECT_EQ(extra, -1);
+        for (int i = 0; i < 4; ++i)
+        {
+            ASSERT_TRUE(queue.try_pop(out));
+            EXPECT_EQ(out, lap * 10 + i);
+        }
+        EXPECT_FALSE(queue.try_pop(out));
+    }
+}
+
+/**
+ * @brief Tests that every item pushed by several producers is popped exactly once by several consumers.
+ */
+TEST(MpmcQueueTest, ConcurrentProducersAndConsumers)
+{
+    constexpr int kThreads = 4;
+    constexpr int kPerProducer = 20000;
+    iterator_mutex::MpmcQueue<int> queue(64);
+    std::vector<std::atomic<int>> seen(kThreads * kPerProducer);
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&queue, t] {
+            for (int i = 0; i < kPerProducer; ++i)
+            {
+                int value = t * kPerProducer + i;
+                while (!queue.try_push(value))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&] {
+            int value = 0;
+            while (popped.load() < kThreads * kPerProducer)
+            {
+                if (queue.try_pop(value))
+                {
+                    seen[static_cast<size_t>(value)].fetch_add(1);
+                    popped.fetch_add(1);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (size_t i = 0; i < seen.size(); ++i)
+    {
+        ASSERT_EQ(seen[i].load(), 1) << "item " << i;
+    }
+}
+
+// --- QueryExecutor ---
+
+/**
+ * @brief Tests that futures answer lookups on the right sequence, and that bad indices throw at once.
+ */
+TEST(QueryExecutorTest, FuturesAnswerEachSequence)
+{
+    iterator_mutex::QueryExecutor executor(make_sequences(3), {.threads = 2, .pin_workers = false});
+    EXPECT_EQ(executor.sequence_count(), 3);
+    EXPECT_EQ(executor.worker_count(), 2);
+    EXPECT_EQ(executor.sequence(2).get_total_size(), 334);
+
+    std::vector<std::pair<std::future<std::optional<int>>, bool>> pending;
+    for (int key = 0; key < 60; ++key)
+    {
+        const size_t index = static_cast<size_t>(key % 3);
+        pending.emplace_back(executor.lookup(index, key), key % static_cast<int>(index + 1) == 0);
+    }
+    for (int key = 0; key < 60; ++key)
+    {
+        auto& [future, present] = pending[static_cast<size_t>(key)];
+        EXPECT_EQ(future.get(), present ? std::optional<int>(key) : std::nullopt) << "key " << key;
+    }
+
+    EXPECT_THROW(executor.lookup(3, 1), std::out_of_range);
+    EXPECT_THROW(executor.lookup(3, 1, [](std::optional<int>) {}), std::out_of_range);
+    EXPECT_THROW(static_cast<void>(executor.sequence(3)), std::out_of_range);
+}
+
+/**
+ * @brief Tests callbacks from several submitting threads through queues small enough to fill up.
+ */
+TEST(QueryExecutorTest, CallbacksUnderBackpressure)
+{
+    constexpr int kSubmitters = 4;
+    constexpr int kPerSubmitter = 5000;
+    std::atomic<int> hits{0};
+    std::atomic<int> answered{0};
+    {
+        const iterator_mutex::QueryExecutorOptions options{
+            .threads = 2, .queue_capacity = 8, .max_batch = 16, .pin_workers = false};
+        iterator_mutex::QueryExecutor executor(make_sequences(2), options);
+        std::vector<std::thread> submitters;
+        for (int t = 0; t < kSubmitters; ++t)
+        {
+            submitters.emplace_back([&executor, &hits, &answered, t] {
+                const auto on_done = [&hits, &answered](std::optional<int> result) {
+                    hits.fetch_add(result.has_value() ? 1 : 0);
+                    answered.fetch_add(1);
+                };
+                for (int i = 0; i < kPerSubmitter; ++i)
+                {
+                    executor.lookup(static_cast<size_t>(t % 2), i % 1000, on_done);
+                }
+            });
+        }
+        for (auto& submitter : submitters)
+        {
+            submitter.join();
+        }
+    }
+    // The destructor answers everything still queued.
+    EXPECT_EQ(answered.load(), kSubmitters * kPerSubmitter);
+    // Sequence 0 holds every key in [0, 1000), sequence 1 the even ones.
+    EXPECT_EQ(hits.load(), 2 * kPerSubmitter + 2 * kPerSubmitter / 2);
+}
+
+/**
+ * @brief Tests that idle workers sleep and wake up for work submitted later.
+ */
+TEST(QueryExecutorTest, WakesIdleWorkers)
+{
+    iterator_mutex::BasicQueryExecutor<std::uint64_t> executor(
+        [] {
+            std::vector<iterator_mutex::BasicDataBlockSequence<std::uint64_t>> sequences;
+            sequences.emplace_back(std::vector<std::uint64_t>{7, 11});
+            return sequences;
+        }(),
+        {.threads = 3});
+    for (int round = 0; round < 5; ++round)
+    {
+        // Long enough for every worker to spin out and go to sleep.
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_EQ(executor.lookup(0, 11).get(), 11u);
+        EXPECT_EQ(executor.lookup(0, 8).get(), std::nullopt);
+    }
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+
+// --- Parameterized over Layout and MRU Mode ---
+class RangeQueryTest : public ::testing::TestWithParam<std::tuple<iterator_mutex::Layout, iterator_mutex::MruMode>>
+{
+protected:
+    void SetUp() override
+    {
+        // Random values with plenty of duplicates and gaps, over several index leaves.
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> dist(0, 600);
+        values_.resize(1000);
+        std::generate(values_.begin(), values_.end(), [&]() { return dist(rng); });
+
+        iterator_mutex::SequenceOptions options;
+        options.layout = std::get<0>(GetParam());
+        options.mru_mode = std::get<1>(GetParam());
+        seq_.emplace(values_, options);
+        std::sort(values_.begin(), values_.end());
+    }
+
+    size_t expected_lower_bound(int value) const
+    {
+        return static_cast<size_t>(std::lower_bound(values_.begin(), values_.end(), value) - values_.begin());
+    }
+
+    std::vector<int> values_;
+    std::optional<iterator_mutex::DataBlockSequence> seq_;
+};
+
+/**
+ * @brief Tests find_index and lower_bound against std::lower_bound, before and after MRU hints are set.
+ */
+TEST_P(RangeQueryTest, PositionsMatchStdLowerBound)
+{
+    // The second pass runs with hints left by the first, so it takes the hint path for repeats.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int value = -1; value <= 602; ++value)
+        {
+            const size_t expected = expected_lower_bound(value);
+            ASSERT_EQ(seq_->lower_bound(value), expected) << "value " << value;
+            ASSERT_EQ(seq_->lower_bound(value), expected) << "value " << value;
+
+            const bool present = expected < values_.size() && values_[expected] == value;
+            ASSERT_EQ(seq_->find_index(value), present ? std::optional<size_t>(expected) : std::nullopt)
+                << "value " << value;
+            // A get_value hit may leave the hint on any of several duplicates.
+            seq_->get_value(value);
+            ASSERT_EQ(seq_->find_index(value), present ? std::optional<size_t>(expected) : std::nullopt)
+                << "value " << value;
+        }
+    }
+}
+
+/**
+ * @brief Tests count_range, get_range and for_each_in_range against the sorted input.
+ */
+TEST_P(RangeQueryTest, RangesMatchSortedInput)
+{
+    for (int lo = -5; lo <= 605; lo += 7)
+    {
+        for (int width : {0, 1, 3, 50, 700})
+        {
+            const int hi = lo + width;
+            const size_t first = expected_lower_bound(lo);
+            const size_t last = expected_lower_bound(hi);
+
+            ASSERT_EQ(seq_->count_range(lo, hi), last - first) << lo << ", " << hi;
+
+            const auto range = seq_->get_range(lo, hi);
+            ASSERT_EQ(range.size(), last - first);
+            EXPECT_TRUE(std::equal(range.begin(), range.end(), values_.begin() + first));
+
+            std::vector<int> visited;
+            EXPECT_EQ(seq_->for_each_in_range(lo, hi, [&](int key) { visited.push_back(key); }), last - first);
+            EXPECT_TRUE(std::equal(visited.begin(), visited.end(), range.begin(), range.end()));
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLayouts, RangeQueryTest,
+                         ::testing::Combine(::testing::Values(iterator_mutex::Layout::Sorted,
+                                                              iterator_mutex::Layout::Eytzinger,
+                                                              iterator_mutex::Layout::BTree),
+                                            ::testing::Values(iterator_mutex::MruMode::Shared,
+                                                              iterator_mutex::MruMode::PerThread)));
+
+// --- Edge Cases ---
+
+/**
+ * @brief Tests empty and reversed ranges, and every query on an empty sequence.
+ */
+TEST(RangeQueryEdgeTest, EmptyRangesAndSequences)
+{
+    const iterator_mutex::DataBlockSequence seq({10, 20, 20, 30});
+    EXPECT_EQ(seq.count_range(20, 20), 0);
+    EXPECT_EQ(seq.count_range(30, 10), 0);
+    EXPECT_TRUE(seq.get_range(30, 10).empty());
+    EXPECT_EQ(seq.for_each_in_range(30, 10, [](int) { FAIL(); }), 0);
+    EXPECT_EQ(seq.count_range(20, 21), 2);
+    EXPECT_EQ(seq.count_range(0, 100), 4);
+    EXPECT_EQ(seq.lower_bound(100), 4);
+    EXPECT_EQ(seq.find_index(100), std::nullopt);
+
+    const iterator_mutex::DataBlockSequence empty(std::vector<int>{});
+    EXPECT_EQ(empty.lower_bound(1), 0);
+    EXPECT_EQ(empty.find_index(1), std::nullopt);
+    EXPECT_EQ(empty.count_range(0, 10), 0);
+    EXPECT_TRUE(empty.get_range(0, 10).empty());
+}
+
+/**
+ * @brief Tests the queries on composite keys, which take the generic comparison path.
+ */
+TEST(RangeQueryEdgeTest, CompositeKeys)
+{
+    using iterator_mutex::CompositeKey;
+    const iterator_mutex::BasicDataBlockSequence<CompositeKey> seq(
+        std::vector<CompositeKey>{{2, 0}, {1, 5}, {1, 1}, {3, 0}, {1, 9}});
+
+    EXPECT_EQ(seq.find_index(CompositeKey{1, 1}), 0);
+    EXPECT_EQ(seq.find_index(CompositeKey{3, 0}), 4);
+    EXPECT_EQ(seq.find_index(CompositeKey{1, 2}), std::nullopt);
+    EXPECT_EQ(seq.lower_bound(CompositeKey{1, 6}), 2);
+    EXPECT_EQ(seq.count_range(CompositeKey{1, 2}, CompositeKey{2, 1}), 3);
+
+    std::vector<CompositeKey> visited;
+    seq.for_each_in_range(CompositeKey{1, 0}, CompositeKey{2, 0},
+                          [&](const CompositeKey& key) { visited.push_back(key); });
+    EXPECT_EQ(visited, (std::vector<CompositeKey>{{1, 1}, {1, 5}, {1, 9}}));
+}
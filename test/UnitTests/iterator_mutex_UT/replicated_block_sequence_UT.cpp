@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "numa_topology.hpp"
+#include "replicated_block_sequence.hpp"
+
+// --- Test Fixture for a Fake Two-Node Machine ---
+// Both nodes list the CPU the test starts on, so replicas can be built and pinned on any host.
+class ReplicatedBlockSequenceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory_ = std::filesystem::temp_directory_path() /
+                     (std::string("iterator_mutex_") + info->test_suite_name() + "_" + info->name());
+        std::filesystem::remove_all(directory_);
+        for (const char* node : {"node0", "node1"})
+        {
+            std::filesystem::create_directories(directory_ / node);
+            std::ofstream(directory_ / node / "cpulist") << std::max(0, ::sched_getcpu()) << "\n";
+        }
+        topology_ = std::make_unique<iterator_mutex::NumaTopology>(directory_.string());
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory_);
+    }
+
+    iterator_mutex::ReplicatedSequenceOptions options() const
+    {
+        iterator_mutex::ReplicatedSequenceOptions options;
+        options.topology = topology_.get();
+        return options;
+    }
+
+    std::filesystem::path directory_;
+    std::unique_ptr<iterator_mutex::NumaTopology> topology_;
+};
+
+/**
+ * @brief Tests that every replica holds the full, sorted contents.
+ */
+TEST_F(ReplicatedBlockSequenceTest, ReplicasMatchPlainSequence)
+{
+    std::vector<int> values = {50, 10, 40, 20, 30, 10};
+    const iterator_mutex::DataBlockSequence reference(values);
+    const iterator_mutex::ReplicatedBlockSequence replicated(values, options());
+
+    ASSERT_EQ(replicated.get_replica_count(), 2);
+    EXPECT_EQ(replicated.get_total_size(), values.size());
+    for (int key = 0; key <= 60; ++key)
+    {
+        EXPECT_EQ(replicated.get_value(key), reference.get_value(key)) << "key " << key;
+    }
+
+    std::vector<std::optional<int>> results(3);
+    EXPECT_EQ(replicated.get_values(std::vector<int>{10, 15, 50}, std::span<std::optional<int>>(results)), 2);
+    EXPECT_EQ(results[1], std::nullopt);
+}
+
+/**
+ * @brief Tests that replication can be switched off, leaving one replica.
+ */
+TEST_F(ReplicatedBlockSequenceTest, SingleReplicaWithoutReplication)
+{
+    auto single = options();
+    single.replicate = false;
+    const iterator_mutex::ReplicatedBlockSequence replicated({3, 1, 2}, single);
+
+    EXPECT_EQ(replicated.get_replica_count(), 1);
+    EXPECT_EQ(replicated.get_value(2), 2);
+    EXPECT_EQ(&replicated.local_replica(), &replicated.local_replica());
+}
+
+/**
+ * @brief Tests that rebuild and move assignment update every replica.
+ */
+TEST_F(ReplicatedBlockSequenceTest, RebuildAndMoveUpdateEveryReplica)
+{
+    iterator_mutex::ReplicatedBlockSequence replicated({1, 2, 3}, options());
+
+    replicated.rebuild({7, 8});
+    EXPECT_EQ(replicated.get_total_size(), 2);
+    EXPECT_EQ(replicated.get_value(8), 8);
+    EXPECT_EQ(replicated.get_value(1), std::nullopt);
+
+    iterator_mutex::ReplicatedBlockSequence other({42}, options());
+    replicated = std::move(other);
+    EXPECT_EQ(replicated.get_value(42), 42);
+    EXPECT_EQ(other.get_total_size(), 0);
+
+    auto single = options();
+    single.replicate = false;
+    iterator_mutex::ReplicatedBlockSequence unreplicated({5}, single);
+    EXPECT_THROW(replicated = std::move(unreplicated), std::invalid_argument);
+    EXPECT_EQ(replicated.get_value(42), 42);
+}
+
+/**
+ * @brief Tests readers racing against rebuilds that swap the replicas one by one.
+ */
+TEST_F(ReplicatedBlockSequenceTest, ReadersRunConcurrentlyWithRebuilds)
+{
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::ReplicatedBlockSequence replicated(values, options());
+
+    std::atomic<bool> keep_reading = true;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back(
+            [&, r]()
+            {
+                int i = r;
+                while (keep_reading)
+                {
+                    const int key = (i++ * 13) % 1000;
+                    if (replicated.get_value(key) != key)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        replicated.rebuild(values);
+    }
+
+    keep_reading = false;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    EXPECT_EQ(failures, 0);
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "search_kernels.hpp"
+
+// --- Parameterized over every Search Kernel ---
+class SearchKernelTest : public ::testing::TestWithParam<iterator_mutex::SearchKernel>
+{
+protected:
+    void SetUp() override
+    {
+        if (!iterator_mutex::is_search_kernel_supported(GetParam()))
+        {
+            GTEST_SKIP() << "kernel not supported on this CPU";
+        }
+        iterator_mutex::use_search_kernel(GetParam());
+    }
+
+    void TearDown() override
+    {
+        iterator_mutex::use_search_kernel(iterator_mutex::detected_search_kernel());
+    }
+};
+
+/**
+ * @brief Tests count_less against a scalar count for every length up to a few vectors,
+ * including keys at the ends of the int range.
+ */
+TEST_P(SearchKernelTest, CountLessMatchesScalar)
+{
+    EXPECT_EQ(iterator_mutex::active_search_kernel(), GetParam());
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> dist(-50, 50);
+    std::vector<int> keys(40);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    keys[3] = INT_MIN;
+    keys[17] = INT_MAX;
+
+    for (size_t count = 0; count <= keys.size(); ++count)
+    {
+        for (int value : {INT_MIN, -51, -10, 0, 10, 51, INT_MAX})
+        {
+            const auto expected =
+                static_cast<size_t>(std::count_if(keys.begin(), keys.begin() + count, [&](int k) { return k < value; }));
+            EXPECT_EQ(iterator_mutex::count_less(keys.data(), count, value), expected)
+                << "count " << count << " value " << value;
+        }
+    }
+}
+
+// Compares count_less with a scalar count for keys of type T, around the sign bit and the
+// ends of the range where a wrong signed/unsigned compare would show.
+template <typename T>
+void expect_count_less_matches_scalar()
+{
+    using Limits = std::numeric_limits<T>;
+    const T half = static_cast<T>(Limits::max() / 2);
+    const std::vector<T> probes = {Limits::min(), static_cast<T>(Limits::min() + 1), T{0}, T{1}, half,
+                                   static_cast<T>(half + 1), static_cast<T>(Limits::max() - 1), Limits::max()};
+
+    std::mt19937_64 rng(3);
+    std::vector<T> keys(40);
+    std::generate(keys.begin(), keys.end(), [&]() { return probes[rng() % probes.size()]; });
+
+    for (size_t count = 0; count <= keys.size(); ++count)
+    {
+        for (T value : probes)
+        {
+            const auto expected =
+                static_cast<size_t>(std::count_if(keys.begin(), keys.begin() + count, [&](T k) { return k < value; }));
+            EXPECT_EQ(iterator_mutex::count_less(keys.data(), count, value), expected)
+                << "count " << count << " value " << value;
+        }
+    }
+}
+
+/**
+ * @brief Tests count_less for unsigned and 64-bit keys, which need their own compares in every kernel.
+ */
+TEST_P(SearchKernelTest, CountLessMatchesScalarForEveryKeyType)
+{
+    expect_count_less_matches_scalar<std::int32_t>();
+    expect_count_less_matches_scalar<std::uint32_t>();
+    expect_count_less_matches_scalar<std::int64_t>();
+    expect_count_less_matches_scalar<std::uint64_t>();
+}
+
+/**
+ * @brief Tests search_lower_bound against std::lower_bound on sorted data with duplicates.
+ */
+TEST_P(SearchKernelTest, LowerBoundMatchesStd)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> dist(0, 300);
+    for (size_t n : {0, 1, 16, 17, 33, 100, 1000})
+    {
+        std::vector<int> data(n);
+        std::generate(data.begin(), data.end(), [&]() { return dist(rng); });
+        std::sort(data.begin(), data.end());
+
+        for (int value = -1; value <= 301; ++value)
+        {
+            const auto expected = static_cast<size_t>(std::lower_bound(data.begin(), data.end(), value) - data.begin());
+            EXPECT_EQ(iterator_mutex::search_lower_bound(data.data(), n, value), expected)
+                << "n " << n << " value " << value;
+        }
+    }
+}
+
+/**
+ * @brief Tests search_lower_bound with a comparator that has no vector kernel.
+ */
+TEST(SearchLowerBoundTest, CustomComparatorMatchesStd)
+{
+    static_assert(iterator_mutex::has_simd_kernel_v<std::uint64_t, std::less<std::uint64_t>>);
+    static_assert(!iterator_mutex::has_simd_kernel_v<std::uint64_t, std::greater<std::uint64_t>>);
+    static_assert(!iterator_mutex::has_simd_kernel_v<double, std::less<double>>);
+
+    std::vector<std::uint64_t> data(100);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (data.size() - i) * 2;
+    }
+
+    for (std::uint64_t value = 0; value <= 202; ++value)
+    {
+        const auto expected = static_cast<size_t>(
+            std::lower_bound(data.begin(), data.end(), value, std::greater<>()) - data.begin());
+        EXPECT_EQ(iterator_mutex::search_lower_bound(data.data(), data.size(), value, std::greater<>()), expected)
+            << "value " << value;
+    }
+}
+
+// Compares intersect_sorted with a lookup of every key of a in b, for sorted keys of type T
+// with many repeats, drawn around the sign bit, over every pair of lengths up to a few vectors.
+template <typename T>
+void expect_intersect_matches_reference()
+{
+    using Limits = std::numeric_limits<T>;
+    const T half = static_cast<T>(Limits::max() / 2);
+    const std::vector<T> probes = {Limits::min(), T{0}, T{1}, T{2}, T{3}, T{5}, T{8}, half,
+                                   static_cast<T>(half + 1), Limits::max()};
+
+    std::mt19937_64 rng(5);
+    for (size_t a_count = 0; a_count <= 40; a_count += 3)
+    {
+        for (size_t b_count = 0; b_count <= 40; b_count += 5)
+        {
+            std::vector<T> a(a_count);
+            std::vector<T> b(b_count);
+            std::generate(a.begin(), a.end(), [&]() { return probes[rng() % probes.size()]; });
+            std::generate(b.begin(), b.end(), [&]() { return probes[rng() % (probes.size() - 2)]; });
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+
+            std::vector<T> expected;
+            std::copy_if(a.begin(), a.end(), std::back_inserter(expected),
+                         [&](T key) { return std::binary_search(b.begin(), b.end(), key); });
+            std::vector<T> out(a_count);
+            const size_t found = iterator_mutex::intersect_sorted(a.data(), a_count, b.data(), b_count, out.data());
+            ASSERT_EQ(found, expected.size()) << "a " << a_count << " b " << b_count;
+            out.resize(found);
+            EXPECT_EQ(out, expected) << "a " << a_count << " b " << b_count;
+            EXPECT_EQ(iterator_mutex::intersect_sorted(a.data(), a_count, b.data(), b_count, nullptr), found);
+        }
+    }
+}
+
+/**
+ * @brief Tests intersect_sorted for every key type, with repeated keys and keys beyond the signed range.
+ */
+TEST_P(SearchKernelTest, IntersectMatchesReference)
+{
+    expect_intersect_matches_reference<std::int32_t>();
+    expect_intersect_matches_reference<std::uint32_t>();
+    expect_intersect_matches_reference<std::int64_t>();
+    expect_intersect_matches_reference<std::uint64_t>();
+}
+
+/**
+ * @brief Tests that every layout gives the same answers with this kernel, for single and batch lookups.
+ */
+TEST_P(SearchKernelTest, SequenceLookupsAgreeAcrossLayouts)
+{
+    std::vector<int> values(777);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = static_cast<int>(i * 3);
+    }
+    std::vector<int> keys(values.size() * 3 + 2);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<int>(i) - 1;
+    }
+
+    for (auto layout :
+         {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        iterator_mutex::DataBlockSequence seq(values, options);
+
+        std::vector<std::uint64_t> found((keys.size() + 63) / 64);
+        EXPECT_EQ(seq.get_values(keys, found), values.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            const bool expected = keys[i] >= 0 && keys[i] % 3 == 0 && keys[i] < 3 * 777;
+            EXPECT_EQ(seq.get_value(keys[i]).has_value(), expected) << "key " << keys[i];
+            EXPECT_EQ(((found[i / 64] >> (i % 64)) & 1) != 0, expected) << "key " << keys[i];
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllKernels, SearchKernelTest,
+                         ::testing::Values(iterator_mutex::SearchKernel::Scalar, iterator_mutex::SearchKernel::Avx2,
+                                           iterator_mutex::SearchKernel::Avx512,
+                                           iterator_mutex::SearchKernel::Neon),
+                         [](const ::testing::TestParamInfo<iterator_mutex::SearchKernel>& info)
+                         {
+                             switch (info.param)
+                             {
+                                 case iterator_mutex::SearchKernel::Avx2:
+                                     return "Avx2";
+                                 case iterator_mutex::SearchKernel::Avx512:
+                                     return "Avx512";
+                                 case iterator_mutex::SearchKernel::Neon:
+                                     return "Neon";
+                                 default:
+                                     return "Scalar";
+                             }
+                         });
@@ -0,0 +1,324 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_types.hpp"
+#include "search_layouts.hpp"
+
+// --- Parameterized over Layout and Sequence Size ---
+class SearchLayoutTest : public ::testing::TestWithParam<std::tuple<iterator_mutex::Layout, int>>
+{
+protected:
+    // Random values with duplicates, spread so that about half of all keys in range are misses.
+    static std::vector<int> make_values(int size)
+    {
+        std::mt19937 rng(size);
+        std::uniform_int_distribution<int> dist(0, 2 * size);
+        std::vector<int> values(size);
+        std::generate(values.begin(), values.end(), [&]() { return dist(rng); });
+        return values;
+    }
+
+    static iterator_mutex::SequenceOptions options_for(iterator_mutex::Layout layout)
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        return options;
+    }
+};
+
+/**
+ * @brief Tests that every layout finds exactly the values a plain binary search finds.
+ *
+ * Sizes around the 16-key leaf and node boundaries exercise partial leaves, padded
+ * B+tree nodes and padded Eytzinger trees.
+ */
+TEST_P(SearchLayoutTest, GetValueMatchesBinarySearch)
+{
+    const auto [layout, size] = GetParam();
+    auto values = make_values(size);
+    iterator_mutex::DataBlockSequence seq(values, options_for(layout));
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(seq.get_layout(), layout);
+    EXPECT_EQ(seq.get_total_size(), static_cast<size_t>(size));
+    for (int key = -1; key <= 2 * size + 1; ++key)
+    {
+        const bool present = std::binary_search(values.begin(), values.end(), key);
+        EXPECT_EQ(seq.get_value(key).has_value(), present) << "key " << key;
+    }
+}
+
+/**
+ * @brief Tests that unsorted batch lookups go through the layout and agree with get_value.
+ */
+TEST_P(SearchLayoutTest, BatchLookupMatchesGetValue)
+{
+    const auto [layout, size] = GetParam();
+    iterator_mutex::DataBlockSequence seq(make_values(size), options_for(layout));
+
+    std::vector<int> keys(2 * size + 3);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<int>(keys.size() - i) - 2;  // Descending, so not the merge walk.
+    }
+    std::vector<std::optional<int>> results(keys.size());
+    seq.get_values(keys, results);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(results[i], seq.get_value(keys[i])) << "key " << keys[i];
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllLayouts, SearchLayoutTest,
+                         ::testing::Combine(::testing::Values(iterator_mutex::Layout::Sorted,
+                                                              iterator_mutex::Layout::Eytzinger,
+                                                              iterator_mutex::Layout::BTree,
+                                                              iterator_mutex::Layout::Learned),
+                                            ::testing::Values(0, 1, 15, 16, 17, 255, 256, 257, 4097)));
+
+// --- Interleaved Searches ---
+
+/**
+ * @brief Tests that lockstep searches agree with one search at a time, for every layout and group size.
+ *
+ * Group sizes that do not divide the key count leave a partial last group; 100 is clamped
+ * to the maximum.
+ */
+TEST(InterleavedSearchTest, LowerBoundsMatchLowerBound)
+{
+    std::mt19937 rng(24);
+    std::uniform_int_distribution<int> dist(-50, 20000);
+    for (size_t size : {0, 1, 17, 300, 10000})
+    {
+        std::vector<int> blocks(size);
+        std::generate(blocks.begin(), blocks.end(), [&]() { return dist(rng); });
+        std::sort(blocks.begin(), blocks.end());
+        std::vector<int> keys(517);
+        std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+        keys[0] = INT_MIN;
+        keys[1] = INT_MAX;
+
+        for (auto layout : {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger,
+                            iterator_mutex::Layout::BTree, iterator_mutex::Layout::Learned})
+        {
+            const iterator_mutex::BlockIndex<int> index(layout, blocks);
+            for (size_t in_flight : {1, 3, 16, 32, 100})
+            {
+                size_t calls = 0;
+                index.lower_bounds(
+                    blocks, keys,
+                    [&](size_t i, size_t position)
+                    {
+                        ASSERT_EQ(i, calls++);
+                        ASSERT_EQ(position, index.lower_bound(blocks, keys[i]))
+                            << "size " << size << " in flight " << in_flight << " key " << keys[i];
+                    },
+                    in_flight);
+                EXPECT_EQ(calls, keys.size());
+            }
+        }
+    }
+}
+
+// --- Layout-specific Edge Cases ---
+
+/**
+ * @brief Tests the extreme int values, which collide with the index padding key.
+ */
+TEST(SearchLayoutEdgeTest, HandlesExtremeKeys)
+{
+    for (auto layout :
+         {iterator_mutex::Layout::Eytzinger, iterator_mutex::Layout::BTree, iterator_mutex::Layout::Learned})
+    {
+        iterator_mutex::SequenceOptions options;
+        options.layout = layout;
+        std::vector<int> values(40, 5);
+        values.push_back(INT_MIN);
+        values.push_back(INT_MAX);
+        iterator_mutex::DataBlockSequence seq(values, options);
+
+        EXPECT_TRUE(seq.get_value(INT_MAX).has_value());
+        EXPECT_TRUE(seq.get_value(INT_MIN).has_value());
+        EXPECT_TRUE(seq.get_value(5).has_value());
+        EXPECT_FALSE(seq.get_value(INT_MAX - 1).has_value());
+    }
+}
+
+/**
+ * @brief Tests that the layout and its index travel with the data on a move.
+ */
+TEST(SearchLayoutEdgeTest, MovesCarryTheIndex)
+{
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::BTree;
+    std::vector<int> values(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        values[i] = 3 * i;
+    }
+    iterator_mutex::DataBlockSequence seq(values, options);
+    iterator_mutex::DataBlockSequence target({1, 2});
+
+    target = std::move(seq);
+    EXPECT_EQ(target.get_layout(), iterator_mutex::Layout::BTree);
+    EXPECT_TRUE(target.get_value(2997).has_value());
+    EXPECT_FALSE(target.get_value(2998).has_value());
+    EXPECT_FALSE(seq.get_value(2997).has_value());
+}
+
+// --- Learned Layout ---
+
+namespace
+{
+
+// Checks index.lower_bound against std::lower_bound for every key, its neighbours and the extremes.
+template <typename T>
+void expect_lower_bounds(const iterator_mutex::BlockIndex<T>& index, const std::vector<T>& keys)
+{
+    std::vector<T> probes = {std::numeric_limits<T>::min(), std::numeric_limits<T>::max()};
+    for (const T& key : keys)
+    {
+        probes.push_back(key);
+        if (key > std::numeric_limits<T>::min())
+        {
+            probes.push_back(key - 1);
+        }
+        if (key < std::numeric_limits<T>::max())
+        {
+            probes.push_back(key + 1);
+        }
+    }
+    for (const T& probe : probes)
+    {
+        const auto expected = static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin());
+        ASSERT_EQ(index.lower_bound(keys, probe), expected) << "probe " << probe;
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Tests the model on random 64-bit keys over the full signed range, for several error bounds.
+ */
+TEST(LearnedLayoutTest, MatchesLowerBoundOnRandomKeys)
+{
+    std::mt19937_64 rng(23);
+    std::vector<std::int64_t> keys(20000);
+    for (auto& key : keys)
+    {
+        key = static_cast<std::int64_t>(rng());
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (size_t epsilon : {1, 4, 32, 256})
+    {
+        const iterator_mutex::BlockIndex<std::int64_t> index(iterator_mutex::Layout::Learned, keys, {}, nullptr,
+                                                             epsilon);
+        ASSERT_EQ(index.layout(), iterator_mutex::Layout::Learned);
+        expect_lower_bounds(index, keys);
+    }
+}
+
+/**
+ * @brief Tests keys that no line fits: long runs of equal keys and exponentially spaced keys.
+ */
+TEST(LearnedLayoutTest, MatchesLowerBoundOnSkewedKeys)
+{
+    std::vector<std::uint64_t> runs;
+    for (std::uint64_t key = 0; key < 50; ++key)
+    {
+        runs.insert(runs.end(), key % 7 == 0 ? 500 : 1, key * 1000);
+    }
+    const iterator_mutex::BlockIndex<std::uint64_t> run_index(iterator_mutex::Layout::Learned, runs, {}, nullptr, 4);
+    expect_lower_bounds(run_index, runs);
+
+    // Every segment covers two keys, so the levels run out before the top gets small.
+    std::vector<std::uint64_t> exponential;
+    for (unsigned shift = 0; shift < 64; ++shift)
+    {
+        for (std::uint64_t step = 0; step < 200; ++step)
+        {
+            exponential.push_back((std::uint64_t{1} << shift) + (step << shift) / 256);
+        }
+    }
+    std::sort(exponential.begin(), exponential.end());
+    exponential.erase(std::unique(exponential.begin(), exponential.end()), exponential.end());
+    const iterator_mutex::BlockIndex<std::uint64_t> index(iterator_mutex::Layout::Learned, exponential, {}, nullptr, 1);
+    expect_lower_bounds(index, exponential);
+    EXPECT_TRUE(iterator_mutex::BlockIndex<std::uint64_t>::is_consistent(index.image(), exponential.size()));
+}
+
+/**
+ * @brief Tests that the error bound trades model size: near-uniform keys need fewer segments as it grows.
+ */
+TEST(LearnedLayoutTest, EpsilonTradesSegmentsForSearch)
+{
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> dist(0, 1 << 30);
+    std::vector<int> keys(100000);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    std::sort(keys.begin(), keys.end());
+
+    size_t previous = keys.size();
+    for (size_t epsilon : {2, 8, 32, 128})
+    {
+        const iterator_mutex::BlockIndex<int> index(iterator_mutex::Layout::Learned, keys, {}, nullptr, epsilon);
+        const auto image = index.image();
+        EXPECT_EQ(image.learned_epsilon, epsilon);
+        EXPECT_LT(image.learned_segments.size(), previous) << "epsilon " << epsilon;
+        previous = image.learned_segments.size();
+    }
+    // Uniform keys: at the largest bound the model is a sliver of the keys.
+    EXPECT_LT(previous * sizeof(iterator_mutex::LearnedSegment), keys.size() * sizeof(int) / 100);
+
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Learned;
+    options.learned_epsilon = 8;
+    const iterator_mutex::DataBlockSequence seq(keys, options);
+    EXPECT_EQ(seq.get_layout(), iterator_mutex::Layout::Learned);
+    for (size_t i = 0; i < keys.size(); i += 97)
+    {
+        EXPECT_EQ(seq.get_value(keys[i]), keys[i]);
+    }
+}
+
+/**
+ * @brief Tests that models which do not fit the keys are caught, and that keys without a distance get Sorted.
+ */
+TEST(LearnedLayoutTest, RejectsBadModelsAndFallsBack)
+{
+    std::vector<int> keys(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys[static_cast<size_t>(i)] = i * i;
+    }
+    const iterator_mutex::BlockIndex<int> index(iterator_mutex::Layout::Learned, keys, {}, nullptr, 2);
+    auto image = index.image();
+    ASSERT_TRUE(iterator_mutex::BlockIndex<int>::is_consistent(image, keys.size()));
+    EXPECT_FALSE(iterator_mutex::BlockIndex<int>::is_consistent(image, keys.size() / 4));
+
+    std::vector<iterator_mutex::LearnedSegment> segments(image.learned_segments.begin(), image.learned_segments.end());
+    ASSERT_GT(segments.size(), 1);
+    segments[1].position = segments[0].position;
+    image.learned_segments = segments;
+    EXPECT_FALSE(iterator_mutex::BlockIndex<int>::is_consistent(image, keys.size()));
+    image.learned_segments = image.learned_segments.first(segments.size() - 1);
+    EXPECT_FALSE(iterator_mutex::BlockIndex<int>::is_consistent(image, keys.size()));
+
+    const std::vector<iterator_mutex::CompositeKey> pairs = {{1, 2}, {1, 5}, {3, 0}};
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Learned;
+    const iterator_mutex::BasicDataBlockSequence<iterator_mutex::CompositeKey> seq(pairs, options);
+    EXPECT_EQ(seq.get_layout(), iterator_mutex::Layout::Sorted);
+    EXPECT_EQ(seq.get_value({1, 5}), (iterator_mutex::CompositeKey{1, 5}));
+}
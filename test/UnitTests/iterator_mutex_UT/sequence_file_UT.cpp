@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_types.hpp"
+#include "sequence_file.hpp"
+
+// --- Test Fixture for Saved Sequences ---
+class SequenceFileTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        directory_ = std::filesystem::temp_directory_path() /
+                     (std::string("iterator_mutex_") + info->test_suite_name() + "_" + info->name());
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory_);
+    }
+
+    std::string path(const std::string& name) const
+    {
+        return (directory_ / name).string();
+    }
+
+    std::filesystem::path directory_;
+};
+
+/**
+ * @brief Tests that a mapped sequence answers like the saved one, for every layout and sizes around a leaf.
+ */
+TEST_F(SequenceFileTest, RoundTripMatchesEveryLayout)
+{
+    for (size_t size : {0, 1, 16, 17, 1000, 5000})
+    {
+        std::vector<int> values(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            values[i] = static_cast<int>(i * 2);
+        }
+
+        for (auto layout : {iterator_mutex::Layout::Sorted, iterator_mutex::Layout::Eytzinger,
+                            iterator_mutex::Layout::BTree, iterator_mutex::Layout::Learned})
+        {
+            iterator_mutex::SequenceOptions options;
+            options.layout = layout;
+            iterator_mutex::DataBlockSequence saved(values, options);
+            saved.save(path("seq"));
+
+            const auto mapped = iterator_mutex::DataBlockSequence::open_mmap(path("seq"));
+            EXPECT_EQ(mapped.get_layout(), layout);
+            EXPECT_EQ(mapped.get_total_size(), size);
+            EXPECT_EQ(mapped.is_view(), size > 0);
+            for (int key = -1; key <= static_cast<int>(size * 2); ++key)
+            {
+                EXPECT_EQ(mapped.get_value(key), saved.get_value(key)) << "size " << size << " key " << key;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tests 64-bit and composite keys, which the file tags with their own key type.
+ */
+TEST_F(SequenceFileTest, RoundTripForWideKeys)
+{
+    std::vector<std::uint64_t> ids(300);
+    std::iota(ids.begin(), ids.end(), std::uint64_t{1} << 63);
+    iterator_mutex::BasicDataBlockSequence<std::uint64_t>(ids, {iterator_mutex::MruMode::Shared,
+                                                                iterator_mutex::Layout::BTree})
+        .save(path("ids"));
+    const auto mapped_ids = iterator_mutex::BasicDataBlockSequence<std::uint64_t>::open_mmap(path("ids"));
+    EXPECT_EQ(mapped_ids.get_value(ids[123]), ids[123]);
+    EXPECT_EQ(mapped_ids.get_value(5), std::nullopt);
+
+    const std::vector<iterator_mutex::CompositeKey> pairs = {{1, 2}, {1, 5}, {3, 0}};
+    using PairSequence = iterator_mutex::BasicDataBlockSequence<iterator_mutex::CompositeKey>;
+    PairSequence(pairs).save(path("pairs"));
+    const auto mapped_pairs = PairSequence::open_mmap(path("pairs"));
+    EXPECT_EQ(mapped_pairs.get_value({1, 5}), (iterator_mutex::CompositeKey{1, 5}));
+    EXPECT_EQ(mapped_pairs.get_value({1, 3}), std::nullopt);
+
+    // Same key size, different key type.
+    EXPECT_THROW(iterator_mutex::BasicDataBlockSequence<std::int64_t>::open_mmap(path("ids")), std::runtime_error);
+    EXPECT_THROW(iterator_mutex::DataBlockSequence::open_mmap(path("ids")), std::runtime_error);
+}
+
+/**
+ * @brief Tests that a Learned model is mapped with its error bound and still finds skewed keys.
+ */
+TEST_F(SequenceFileTest, RoundTripForLearnedModel)
+{
+    std::vector<std::int64_t> values;
+    for (std::int64_t i = 0; i < 20000; ++i)
+    {
+        values.push_back(i * i * (i % 3 == 0 ? -1 : 1));
+    }
+    iterator_mutex::SequenceOptions options;
+    options.layout = iterator_mutex::Layout::Learned;
+    options.learned_epsilon = 4;
+    using Sequence = iterator_mutex::BasicDataBlockSequence<std::int64_t>;
+    const Sequence saved(values, options);
+    saved.save(path("learned"));
+
+    const auto mapped = Sequence::open_mmap(path("learned"));
+    EXPECT_EQ(mapped.get_layout(), iterator_mutex::Layout::Learned);
+    for (std::int64_t i = 0; i < 20000; i += 7)
+    {
+        const std::int64_t key = values[static_cast<size_t>(i)];
+        EXPECT_EQ(mapped.get_value(key), key);
+        EXPECT_EQ(mapped.lower_bound(key + 1), saved.lower_bound(key + 1)) << "key " << key;
+    }
+}
+
+/**
+ * @brief Tests that a mapping stays valid after the file is replaced and after the sequence is moved.
+ */
+TEST_F(SequenceFileTest, MappingOutlivesReplacedFileAndMoves)
+{
+    iterator_mutex::DataBlockSequence({1, 2, 3}).save(path("seq"));
+    auto mapped = iterator_mutex::DataBlockSequence::open_mmap(path("seq"));
+
+    // save() renames over the old file, so the existing mapping keeps the old contents.
+    iterator_mutex::DataBlockSequence({7, 8}).save(path("seq"));
+    EXPECT_EQ(mapped.get_value(2), 2);
+    EXPECT_EQ(iterator_mutex::DataBlockSequence::open_mmap(path("seq")).get_value(8), 8);
+
+    iterator_mutex::DataBlockSequence moved(std::move(mapped));
+    EXPECT_EQ(moved.get_value(3), 3);
+    EXPECT_EQ(mapped.get_total_size(), 0);
+}
+
+/**
+ * @brief Tests that missing, foreign and damaged files are rejected instead of mapped.
+ */
+TEST_F(SequenceFileTest, RejectsBadFiles)
+{
+    EXPECT_THROW(iterator_mutex::DataBlockSequence::open_mmap(path("missing")), std::system_error);
+
+    {
+        std::ofstream out(path("foreign"), std::ios::binary);
+        out << std::string(1024, 'x');
+    }
+    EXPECT_THROW(iterator_mutex::DataBlockSequence::open_mmap(path("foreign")), std::runtime_error);
+
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::DataBlockSequence(values, {iterator_mutex::MruMode::Shared, iterator_mutex::Layout::Eytzinger})
+        .save(path("seq"));
+    std::filesystem::resize_file(path("seq"), std::filesystem::file_size(path("seq")) / 2);
+    EXPECT_THROW(iterator_mutex::DataBlockSequence::open_mmap(path("seq")), std::runtime_error);
+
+    std::filesystem::resize_file(path("seq"), sizeof(iterator_mutex::SequenceFileHeader) - 1);
+    EXPECT_THROW(iterator_mutex::DataBlockSequence::open_mmap(path("seq")), std::runtime_error);
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "lock_policies.hpp"
+
+namespace
+{
+
+// Keys {version, version + 10, ..., version + 10 * (count - 1)}.
+std::vector<int> versioned_keys(int version, int count)
+{
+    std::vector<int> keys(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        keys[static_cast<size_t>(i)] = version + 10 * i;
+    }
+    return keys;
+}
+
+}  // namespace
+
+/**
+ * @brief Tests that every query on a snapshot answers as the same query on the sequence.
+ */
+TEST(SequenceSnapshotTest, AnswersLikeTheSequence)
+{
+    iterator_mutex::SequenceOptions options;
+    options.mru_mode = iterator_mutex::MruMode::PerThread;
+    options.filter_bits_per_key = 10;
+    const iterator_mutex::DataBlockSequence seq(std::vector<int>{1, 3, 3, 5, 8, 13, 21}, options);
+
+    std::optional<int> values[7];
+    std::vector<std::uint64_t> bitmap(1);
+    const std::vector<int> keys = {21, 4, 3, 1, 22, 13, 0};
+    {
+        const auto snap = seq.snapshot();
+        EXPECT_EQ(snap.get_total_size(), 7);
+        EXPECT_EQ(snap.get_keys().data(), seq.get_keys().data());
+        for (int key = -1; key <= 23; ++key)
+        {
+            EXPECT_EQ(snap.get_value(key), seq.get_value(key)) << "key " << key;
+            EXPECT_EQ(snap.find_index(key), seq.find_index(key)) << "key " << key;
+            EXPECT_EQ(snap.lower_bound(key), seq.lower_bound(key)) << "key " << key;
+            EXPECT_EQ(snap.count_range(key, key + 5), seq.count_range(key, key + 5)) << "key " << key;
+            EXPECT_EQ(snap.get_range(key, key + 5).data(), seq.get_range(key, key + 5).data()) << "key " << key;
+        }
+        EXPECT_EQ(snap.get_values(keys, values), 4);
+        EXPECT_EQ(snap.get_values(keys, bitmap), 4);
+        EXPECT_THROW(snap.get_values(keys, std::span<std::optional<int>>(values, 3)), std::invalid_argument);
+    }
+    EXPECT_EQ(values[0], 21);
+    EXPECT_EQ(values[1], std::nullopt);
+    EXPECT_EQ(bitmap[0], 0b0101101u);
+}
+
+/**
+ * @brief Tests that the generation changes with every hand-over of the keys and only then.
+ */
+TEST(SequenceSnapshotTest, GenerationFollowsTheContents)
+{
+    iterator_mutex::DataBlockSequence a(versioned_keys(1, 100));
+    iterator_mutex::DataBlockSequence b(versioned_keys(2, 100));
+    const std::uint64_t first = a.generation();
+    EXPECT_NE(first, b.generation());
+
+    static_cast<void>(a.get_value(11));
+    static_cast<void>(a.snapshot().get_value(21));
+    EXPECT_EQ(a.generation(), first);
+    EXPECT_EQ(a.snapshot().generation(), first);
+
+    std::vector<std::uint64_t> seen = {first, b.generation()};
+    auto expect_new = [&seen](std::uint64_t generation)
+    {
+        for (std::uint64_t old : seen)
+        {
+            EXPECT_NE(generation, old);
+        }
+        seen.push_back(generation);
+    };
+
+    a.swap(b);
+    expect_new(a.generation());
+    expect_new(b.generation());
+    a = std::move(b);
+    expect_new(a.generation());
+    expect_new(b.generation());
+    iterator_mutex::DataBlockSequence c(std::move(a));
+    expect_new(a.generation());
+    expect_new(c.generation());
+    EXPECT_EQ(c.get_value(1), 1);
+}
+
+/**
+ * @brief Tests that a move into the sequence waits until the snapshot that pins it is gone.
+ */
+TEST(SequenceSnapshotTest, MoveWaitsForSnapshot)
+{
+    iterator_mutex::DataBlockSequence seq(versioned_keys(1, 1000));
+    std::atomic<bool> moved{false};
+    std::thread writer;
+    {
+        const auto snap = seq.snapshot();
+        const std::uint64_t generation = snap.generation();
+        writer = std::thread(
+            [&]
+            {
+                seq = iterator_mutex::DataBlockSequence(versioned_keys(2, 1000));
+                moved.store(true);
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(moved.load());
+        EXPECT_EQ(snap.get_value(11), 11);
+        EXPECT_EQ(snap.get_value(12), std::nullopt);
+        EXPECT_EQ(snap.generation(), generation);
+    }
+    writer.join();
+    EXPECT_TRUE(moved.load());
+    EXPECT_EQ(seq.get_value(12), 12);
+}
+
+/**
+ * @brief Tests that readers see one version per snapshot while a writer keeps replacing the contents.
+ */
+TEST(SequenceSnapshotTest, ConsistentUnderConcurrentMoves)
+{
+    iterator_mutex::BasicDataBlockSequence<int, std::less<int>, iterator_mutex::EpochMutex> seq(
+        versioned_keys(0, 500));
+    std::atomic<bool> stop{false};
+    std::atomic<int> checked{0};
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!stop.load())
+                {
+                    const auto snap = seq.snapshot();
+                    // The smallest key is the version; every other key must be of that one.
+                    const int version = snap.get_keys().front();
+                    for (int i = 0; i < 500; i += 37)
+                    {
+                        ASSERT_EQ(snap.get_value(version + 10 * i), version + 10 * i);
+                        ASSERT_EQ(snap.find_index(version + 10 * i), static_cast<size_t>(i));
+                    }
+                    ASSERT_EQ(snap.count_range(version, version + 5000), 500);
+                    checked.fetch_add(1);
+                }
+            });
+    }
+    for (int version = 1; version < 100; ++version)
+    {
+        seq = decltype(seq)(versioned_keys(version % 10, 500));
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_GT(checked.load(), 0);
+}
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "sequence_stats.hpp"
+#include "sharded_block_sequence.hpp"
+
+using iterator_mutex::LatencyHistogram;
+
+// --- LatencyHistogram ---
+
+/**
+ * @brief Tests that every value falls into a bucket whose bounds enclose it, and that buckets stay narrow.
+ */
+TEST(LatencyHistogramTest, BucketsEncloseTheirValues)
+{
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t v = 0; v < 4096; ++v)
+    {
+        values.push_back(v);
+    }
+    for (std::uint64_t v = 4096; v < (std::uint64_t{1} << 40); v = v * 3 / 2 + 7)
+    {
+        values.push_back(v);
+    }
+
+    for (std::uint64_t value : values)
+    {
+        const size_t bucket = LatencyHistogram::bucket_of(value);
+        ASSERT_LT(bucket, LatencyHistogram::kBucketCount);
+        ASSERT_LE(LatencyHistogram::bucket_lower_bound(bucket), value) << "value " << value;
+        ASSERT_GE(LatencyHistogram::bucket_upper_bound(bucket), value) << "value " << value;
+        // A bucket is no wider than an eighth of its lower bound.
+        const std::uint64_t width =
+            LatencyHistogram::bucket_upper_bound(bucket) - LatencyHistogram::bucket_lower_bound(bucket);
+        ASSERT_LE(width * 8, std::max<std::uint64_t>(value, 8)) << "value " << value;
+    }
+
+    // Buckets tile the values without gaps.
+    for (size_t bucket = 0; bucket + 2 < LatencyHistogram::kBucketCount; ++bucket)
+    {
+        ASSERT_EQ(LatencyHistogram::bucket_upper_bound(bucket) + 1, LatencyHistogram::bucket_lower_bound(bucket + 1));
+    }
+    EXPECT_EQ(LatencyHistogram::bucket_of(UINT64_MAX), LatencyHistogram::kBucketCount - 1);
+}
+
+/**
+ * @brief Tests count, sum, mean, percentiles and merging.
+ */
+TEST(LatencyHistogramTest, PercentilesAndMerge)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0);
+    EXPECT_EQ(histogram.mean(), 0.0);
+
+    for (std::uint64_t v = 1; v <= 1000; ++v)
+    {
+        histogram.record(v);
+    }
+    EXPECT_EQ(histogram.count(), 1000);
+    EXPECT_EQ(histogram.sum(), 500500);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 500.5);
+    EXPECT_EQ(histogram.percentile(0.0), 1);
+    // The true median is 500; its bucket is [480, 511].
+    EXPECT_EQ(histogram.percentile(0.5), 511);
+    EXPECT_GE(histogram.percentile(0.99), 990);
+    EXPECT_LE(histogram.percentile(0.99), 1023);
+    EXPECT_EQ(histogram.percentile(1.0), 1023);
+
+    LatencyHistogram other;
+    other.record(1'000'000, 1000);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 2000);
+    EXPECT_EQ(histogram.percentile(0.5), 1023);
+    const size_t million = LatencyHistogram::bucket_of(1'000'000);
+    EXPECT_EQ(histogram.percentile(0.75), LatencyHistogram::bucket_upper_bound(million));
+}
+
+// --- Recorder ---
+
+/**
+ * @brief Tests that the enabled recorder sums what threads record on different shards.
+ */
+TEST(StatsRecorderTest, SumsAcrossThreads)
+{
+    const iterator_mutex::BasicStatsRecorder<true> recorder;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&recorder] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                recorder.add(iterator_mutex::StatCounter::Lookups);
+                recorder.add(iterator_mutex::StatCounter::BatchKeys, 3);
+                recorder.record(iterator_mutex::StatHistogram::SharedLockWait, 100);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const auto stats = recorder.snapshot();
+    EXPECT_EQ(stats.lookups, 8000);
+    EXPECT_EQ(stats.batch_keys, 24000);
+    EXPECT_EQ(stats.lookup_hits, 0);
+    EXPECT_EQ(stats.shared_lock_wait.count(), 8000);
+    EXPECT_EQ(stats.shared_lock_wait.sum(), 800000);
+    EXPECT_EQ(stats.move_hold.count(), 0);
+}
+
+/**
+ * @brief Tests that the disabled recorder takes no space in the sequence and reports nothing.
+ */
+TEST(StatsRecorderTest, DisabledIsEmpty)
+{
+    static_assert(std::is_empty_v<iterator_mutex::BasicStatsRecorder<false>>);
+    const iterator_mutex::BasicStatsRecorder<false> recorder;
+    recorder.add(iterator_mutex::StatCounter::Lookups);
+    EXPECT_EQ(recorder.snapshot().lookups, 0);
+}
+
+// --- Sequence Stats ---
+
+/**
+ * @brief Tests what a sequence counts: all of it with stats compiled in, none of it without.
+ */
+TEST(SequenceStatsTest, CountsQueries)
+{
+    iterator_mutex::SequenceOptions options;
+    options.hint_search = iterator_mutex::HintSearch::Finger;
+    iterator_mutex::DataBlockSequence seq({2, 4, 6, 8, 10, 12}, options);
+
+    EXPECT_EQ(seq.get_value(4), 4);
+    EXPECT_EQ(seq.get_value(4), 4);
+    EXPECT_EQ(seq.get_value(5), std::nullopt);
+    EXPECT_EQ(seq.find_index(8), 3);
+    EXPECT_EQ(seq.lower_bound(7), 3);
+    EXPECT_EQ(seq.count_range(4, 10), 3);
+    const std::vector<int> keys{2, 3, 12};
+    std::vector<std::optional<int>> results(keys.size());
+    EXPECT_EQ(seq.get_values(keys, results), 2);
+
+    iterator_mutex::DataBlockSequence moved(std::move(seq));
+    const auto stats = seq.stats();
+    const auto moved_stats = moved.stats();
+    if constexpr (!iterator_mutex::kStatsEnabled)
+    {
+        EXPECT_EQ(stats.lookups + stats.position_queries + stats.batch_lookups, 0);
+        EXPECT_EQ(moved_stats.moves, 0);
+        return;
+    }
+
+    EXPECT_EQ(stats.lookups, 3);
+    EXPECT_EQ(stats.lookup_hits, 2);
+    EXPECT_EQ(stats.position_queries, 2);
+    EXPECT_EQ(stats.range_queries, 1);
+    EXPECT_EQ(stats.batch_lookups, 1);
+    EXPECT_EQ(stats.batch_keys, 3);
+    EXPECT_EQ(stats.batch_hits, 2);
+    // Every single-key query, the start of the range included, is answered one way or another,
+    // and every one the hint does not answer gallops from it.
+    EXPECT_GE(stats.hints.exact_hits, 1);
+    EXPECT_EQ(stats.hints.exact_hits + stats.hints.hot_key_hits + stats.hints.near_hits + stats.hints.misses, 6);
+    EXPECT_EQ(stats.finger_steps.count(), stats.hints.near_hits + stats.hints.misses);
+    EXPECT_EQ(stats.moves, 0);
+
+    // A move counts towards the sequence it moves into, which starts its stats afresh.
+    EXPECT_EQ(moved_stats.moves, 1);
+    EXPECT_EQ(moved_stats.lookups, 0);
+    EXPECT_EQ(moved_stats.exclusive_lock_wait.count(), 1);
+    EXPECT_EQ(moved_stats.move_hold.count(), 1);
+}
+
+/**
+ * @brief Tests that a sharded sequence merges the stats of its shards.
+ */
+TEST(SequenceStatsTest, ShardedMergesShards)
+{
+    std::vector<int> values(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        values[static_cast<size_t>(i)] = i;
+    }
+    iterator_mutex::ShardedSequenceOptions options;
+    options.shard_count = 4;
+    const iterator_mutex::ShardedBlockSequence seq(values, options);
+    for (int key : {1, 300, 600, 999, 1000})
+    {
+        static_cast<void>(seq.get_value(key));
+    }
+    const auto stats = seq.stats();
+    EXPECT_EQ(stats.lookups, iterator_mutex::kStatsEnabled ? 5 : 0);
+    EXPECT_EQ(stats.lookup_hits, iterator_mutex::kStatsEnabled ? 4 : 0);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory_resource>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "set_operations.hpp"
+#include "thread_pool.hpp"
+
+namespace
+{
+
+using Sequence = iterator_mutex::DataBlockSequence;
+
+// count sorted keys drawn from [0, range), so small ranges repeat keys.
+std::vector<int> random_keys(size_t count, int range, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(0, range - 1);
+    std::vector<int> keys(count);
+    std::generate(keys.begin(), keys.end(), [&]() { return dist(rng); });
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+// The keys of a that occur in b.
+std::vector<int> reference_intersect(const std::vector<int>& a, const std::vector<int>& b)
+{
+    std::vector<int> expected;
+    std::copy_if(a.begin(), a.end(), std::back_inserter(expected),
+                 [&](int key) { return std::binary_search(b.begin(), b.end(), key); });
+    return expected;
+}
+
+// Every key as often as the input holding it most often.
+std::vector<int> reference_union(const std::vector<std::vector<int>>& inputs)
+{
+    std::map<int, size_t> most;
+    for (const auto& input : inputs)
+    {
+        std::map<int, size_t> counts;
+        for (int key : input)
+        {
+            ++counts[key];
+        }
+        for (const auto& [key, count] : counts)
+        {
+            most[key] = std::max(most[key], count);
+        }
+    }
+    std::vector<int> expected;
+    for (const auto& [key, count] : most)
+    {
+        expected.insert(expected.end(), count, key);
+    }
+    return expected;
+}
+
+std::vector<int> keys_of(const Sequence& seq)
+{
+    const auto keys = seq.get_keys();
+    return {keys.begin(), keys.end()};
+}
+
+}  // namespace
+
+/**
+ * @brief Tests intersect and intersect_count against a reference, for comparable and for skewed sizes either way.
+ */
+TEST(SetOperationsTest, IntersectMatchesReference)
+{
+    for (auto [a_size, b_size] : {std::pair<size_t, size_t>{0, 0}, {0, 100}, {100, 0}, {1000, 1200}, {10, 5000},
+                                  {5000, 10}, {3, 100000}, {100000, 3}})
+    {
+        const auto a = random_keys(a_size, 20000, 1);
+        const auto b = random_keys(b_size, 20000, 2);
+        const Sequence sa(iterator_mutex::assume_sorted, a);
+        const Sequence sb(iterator_mutex::assume_sorted, b);
+
+        const auto expected = reference_intersect(a, b);
+        EXPECT_EQ(keys_of(Sequence::intersect(sa, sb)), expected) << "a " << a_size << " b " << b_size;
+        EXPECT_EQ(Sequence::intersect_count(sa, sb), expected.size()) << "a " << a_size << " b " << b_size;
+    }
+}
+
+/**
+ * @brief Tests that intersect keeps every repeat of a key of a, whatever b holds of it, on every path.
+ */
+TEST(SetOperationsTest, IntersectKeepsRepeatsOfA)
+{
+    const std::vector<int> a = {1, 1, 2, 3, 3, 3, 7};
+    const std::vector<int> b = {1, 3, 3, 4, 7, 7};
+    const Sequence sa(a);
+    const Sequence sb(b);
+    EXPECT_EQ(keys_of(Sequence::intersect(sa, sb)), (std::vector<int>{1, 1, 3, 3, 3, 7}));
+    EXPECT_EQ(keys_of(Sequence::intersect(sb, sa)), (std::vector<int>{1, 3, 3, 7, 7}));
+
+    // The same keys with b a few hundred times larger take the galloping paths both ways.
+    std::vector<int> large = b;
+    for (int key = 100; key < 1000; ++key)
+    {
+        large.push_back(key);
+    }
+    const Sequence sl(large);
+    EXPECT_EQ(keys_of(Sequence::intersect(sa, sl)), (std::vector<int>{1, 1, 3, 3, 3, 7}));
+    EXPECT_EQ(keys_of(Sequence::intersect(sl, sa)), (std::vector<int>{1, 3, 3, 7, 7}));
+    EXPECT_EQ(iterator_mutex::detail::intersect_ranges<int>(large, a, nullptr, std::less<int>()), 5);
+}
+
+/**
+ * @brief Tests merge_union against a reference for zero to five inputs with repeated keys.
+ */
+TEST(SetOperationsTest, MergeUnionMatchesReference)
+{
+    std::vector<std::vector<int>> inputs;
+    std::vector<Sequence> sequences;
+    for (unsigned k = 0; k <= 5; ++k)
+    {
+        std::vector<const Sequence*> pointers;
+        for (const Sequence& seq : sequences)
+        {
+            pointers.push_back(&seq);
+        }
+        EXPECT_EQ(keys_of(Sequence::merge_union(pointers)), reference_union(inputs)) << "inputs " << k;
+
+        inputs.push_back(random_keys(300 * (k + 1), 500, k));
+        sequences.emplace_back(iterator_mutex::assume_sorted, inputs.back());
+    }
+}
+
+/**
+ * @brief Tests that a sequence named twice is read under a single lock and gives the expected result.
+ */
+TEST(SetOperationsTest, SameSequenceTwice)
+{
+    const auto keys = random_keys(1000, 400, 9);
+    const Sequence seq(iterator_mutex::assume_sorted, keys);
+    EXPECT_EQ(keys_of(Sequence::intersect(seq, seq)), keys);
+    const Sequence* inputs[] = {&seq, &seq, &seq};
+    EXPECT_EQ(keys_of(Sequence::merge_union(inputs)), keys);
+}
+
+/**
+ * @brief Tests that the partitioned operations on a pool give the serial results, cuts falling inside runs of a key.
+ */
+TEST(SetOperationsTest, ParallelMatchesSerial)
+{
+    iterator_mutex::ThreadPool pool(3);
+    iterator_mutex::SequenceOptions options;
+    options.build_pool = &pool;
+    options.layout = iterator_mutex::Layout::Eytzinger;
+
+    // Few distinct keys, so every cut lands inside a long run.
+    const auto a = random_keys(400000, 1000, 3);
+    const auto b = random_keys(300000, 3000, 4);
+    const auto c = random_keys(5000, 100000, 5);
+    const Sequence sa(iterator_mutex::assume_sorted, a);
+    const Sequence sb(iterator_mutex::assume_sorted, b);
+    const Sequence sc(iterator_mutex::assume_sorted, c);
+
+    const Sequence intersection = Sequence::intersect(sa, sb, options);
+    EXPECT_EQ(intersection.get_layout(), iterator_mutex::Layout::Eytzinger);
+    EXPECT_EQ(keys_of(intersection), reference_intersect(a, b));
+    EXPECT_EQ(Sequence::intersect_count(sb, sa, &pool), reference_intersect(b, a).size());
+    EXPECT_EQ(Sequence::intersect_count(sc, sa, &pool), reference_intersect(c, a).size());
+
+    const Sequence* inputs[] = {&sc, &sa, &sb};
+    EXPECT_EQ(keys_of(Sequence::merge_union(inputs, options)), reference_union({c, a, b}));
+}
+
+/**
+ * @brief Tests keys without a vector kernel, whose merge goes through the comparator.
+ */
+TEST(SetOperationsTest, CompositeKeys)
+{
+    using Key = iterator_mutex::CompositeKey;
+    using KeySequence = iterator_mutex::BasicDataBlockSequence<Key>;
+    std::vector<Key> a;
+    std::vector<Key> b;
+    for (std::uint64_t i = 0; i < 200; ++i)
+    {
+        a.push_back({i % 7, i});
+        b.push_back({i % 5, i});
+    }
+    const KeySequence sa(a);
+    const KeySequence sb(b);
+
+    const auto intersection = KeySequence::intersect(sa, sb);
+    EXPECT_EQ(intersection.get_total_size(), KeySequence::intersect_count(sb, sa));
+    for (const Key& key : intersection.get_keys())
+    {
+        EXPECT_TRUE(sa.get_value(key).has_value());
+        EXPECT_TRUE(sb.get_value(key).has_value());
+    }
+    const KeySequence* inputs[] = {&sa, &sb};
+    const auto merged = KeySequence::merge_union(inputs);
+    EXPECT_EQ(merged.get_total_size(), a.size() + b.size() - intersection.get_total_size());
+    EXPECT_TRUE(std::is_sorted(merged.get_keys().begin(), merged.get_keys().end()));
+}
+
+/**
+ * @brief Tests that the result takes its keys from the first input's memory resource.
+ */
+TEST(SetOperationsTest, ResultUsesFirstInputsResource)
+{
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    using PmrSequence = iterator_mutex::pmr::DataBlockSequence;
+    const PmrSequence a(std::pmr::vector<int>({1, 2, 3, 4}, &arena));
+    const PmrSequence b(std::pmr::vector<int>({2, 4, 6}));
+
+    const auto intersection = PmrSequence::intersect(a, b);
+    const auto keys = intersection.get_keys();
+    EXPECT_EQ(std::vector<int>(keys.begin(), keys.end()), (std::vector<int>{2, 4}));
+    const auto* data = reinterpret_cast<const std::byte*>(keys.data());
+    EXPECT_TRUE(data >= buffer.data() && data < buffer.data() + buffer.size());
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_types.hpp"
+#include "lock_policies.hpp"
+#include "sharded_block_sequence.hpp"
+#include "thread_pool.hpp"
+
+// --- ShardedBlockSequence ---
+
+/**
+ * @brief Tests that a sharded sequence answers like a single one, for shard counts around the key count.
+ */
+TEST(ShardedBlockSequenceTest, MatchesUnshardedSequence)
+{
+    for (size_t size : {0, 1, 5, 16, 1000})
+    {
+        std::vector<int> values(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            values[i] = static_cast<int>((i * 37) % size) * 3;
+        }
+        const iterator_mutex::DataBlockSequence reference(values);
+
+        for (size_t shards : {1, 2, 7, 16, 64})
+        {
+            iterator_mutex::ShardedSequenceOptions options;
+            options.shard_count = shards;
+            const iterator_mutex::ShardedBlockSequence sharded(values, options);
+
+            EXPECT_EQ(sharded.get_total_size(), size);
+            EXPECT_LE(sharded.get_shard_count(), std::max<size_t>(1, std::min(size, shards)));
+            for (int key = -1; key <= static_cast<int>(size * 3); ++key)
+            {
+                EXPECT_EQ(sharded.get_value(key), reference.get_value(key)) << "size " << size << " key " << key;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tests that a run of equal keys never ends up behind the wrong fence.
+ */
+TEST(ShardedBlockSequenceTest, DuplicatesStayInOneShard)
+{
+    std::vector<int> values(100, 5);
+    values.push_back(1);
+    values.push_back(9);
+    iterator_mutex::ShardedSequenceOptions options;
+    options.shard_count = 8;
+    const iterator_mutex::ShardedBlockSequence sharded(values, options);
+
+    // Every fence candidate but the first falls on 5, so there is one fence: 5.
+    EXPECT_EQ(sharded.get_shard_count(), 2);
+    EXPECT_EQ(sharded.get_total_size(), 102);
+    EXPECT_EQ(sharded.get_value(5), 5);
+    EXPECT_EQ(sharded.get_value(1), 1);
+    EXPECT_EQ(sharded.get_value(9), 9);
+    EXPECT_EQ(sharded.get_value(6), std::nullopt);
+}
+
+/**
+ * @brief Tests that batch lookups report keys of every shard at the caller's positions.
+ */
+TEST(ShardedBlockSequenceTest, BatchLookupsMatchSingleLookups)
+{
+    std::vector<int> values(5000);
+    std::iota(values.begin(), values.end(), 0);
+    for (auto& v : values)
+    {
+        v *= 2;
+    }
+    iterator_mutex::ShardedSequenceOptions options;
+    options.shard_count = 9;
+    const iterator_mutex::ShardedBlockSequence sharded(values, options);
+
+    std::mt19937 rng(11);
+    std::vector<int> keys(777);
+    for (auto& k : keys)
+    {
+        k = static_cast<int>(rng() % 10001);
+    }
+
+    for (bool sorted : {false, true})
+    {
+        if (sorted)
+        {
+            std::sort(keys.begin(), keys.end());
+        }
+        std::vector<std::optional<int>> results(keys.size());
+        std::vector<std::uint64_t> found((keys.size() + 63) / 64);
+        const size_t hits = sharded.get_values(keys, std::span<std::optional<int>>(results));
+        EXPECT_EQ(sharded.get_values(keys, std::span<std::uint64_t>(found)), hits);
+
+        size_t expected_hits = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            const auto expected = sharded.get_value(keys[i]);
+            expected_hits += expected.has_value();
+            EXPECT_EQ(results[i], expected) << "key " << keys[i];
+            EXPECT_EQ((found[i / 64] >> (i % 64)) & 1, expected.has_value() ? 1u : 0u) << "key " << keys[i];
+        }
+        EXPECT_EQ(hits, expected_hits);
+    }
+
+    std::vector<std::optional<int>> too_small(1);
+    EXPECT_THROW(sharded.get_values(keys, std::span<std::optional<int>>(too_small)), std::invalid_argument);
+}
+
+/**
+ * @brief Tests that rebuild replaces the contents under the original fences, with and without a pool.
+ */
+TEST(ShardedBlockSequenceTest, RebuildReplacesContents)
+{
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::ThreadPool pool(3);
+    iterator_mutex::ShardedSequenceOptions options;
+    options.shard_count = 4;
+    options.sequence.build_pool = &pool;
+    iterator_mutex::ShardedBlockSequence sharded(values, options);
+
+    // Keys far outside the original range all land in the first and last shards.
+    sharded.rebuild({-50, 250, 750, 5000});
+    EXPECT_EQ(sharded.get_shard_count(), 4);
+    EXPECT_EQ(sharded.get_total_size(), 4);
+    EXPECT_EQ(sharded.get_value(-50), -50);
+    EXPECT_EQ(sharded.get_value(5000), 5000);
+    EXPECT_EQ(sharded.get_value(251), std::nullopt);
+
+    sharded.rebuild(values, &pool);
+    EXPECT_EQ(sharded.get_total_size(), 1000);
+    EXPECT_EQ(sharded.get_value(999), 999);
+    EXPECT_EQ(sharded.get_value(-50), std::nullopt);
+}
+
+/**
+ * @brief Tests composite keys under a non-default lock policy.
+ */
+TEST(ShardedBlockSequenceTest, WorksForCompositeKeys)
+{
+    using PairSequence = iterator_mutex::BasicShardedBlockSequence<iterator_mutex::CompositeKey,
+                                                                   std::less<iterator_mutex::CompositeKey>,
+                                                                   iterator_mutex::EpochMutex>;
+    std::vector<iterator_mutex::CompositeKey> pairs;
+    for (std::uint64_t i = 0; i < 100; ++i)
+    {
+        pairs.push_back({i % 10, i});
+    }
+    const PairSequence sharded(pairs, {4, {}});
+
+    EXPECT_EQ(sharded.get_shard_count(), 4);
+    EXPECT_EQ(sharded.get_value({3, 13}), (iterator_mutex::CompositeKey{3, 13}));
+    EXPECT_EQ(sharded.get_value({3, 14}), std::nullopt);
+}
+
+/**
+ * @brief Tests readers racing against shard-by-shard rebuilds.
+ *
+ * Every rebuild holds the same keys, so each lookup must succeed no matter which shards
+ * have been swapped already.
+ */
+TEST(ShardedBlockSequenceTest, ReadersRunConcurrentlyWithRebuilds)
+{
+    std::vector<int> values(2000);
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::ShardedSequenceOptions options;
+    options.shard_count = 8;
+    iterator_mutex::ShardedBlockSequence sharded(values, options);
+
+    std::atomic<bool> keep_reading = true;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back(
+            [&, r]()
+            {
+                int i = r;
+                while (keep_reading)
+                {
+                    const int key = (i++ * 13) % 2000;
+                    if (sharded.get_value(key) != key)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        sharded.rebuild(values);
+    }
+
+    keep_reading = false;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    EXPECT_EQ(failures, 0);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "epoch_domain.hpp"
+#include "snapshot_block_sequence.hpp"
+
+// --- SnapshotBlockSequence ---
+
+/**
+ * @brief Tests that the handle serves lookups from its initial snapshot.
+ */
+TEST(SnapshotBlockSequenceTest, GetValueReadsInitialSnapshot)
+{
+    iterator_mutex::SnapshotBlockSequence handle({50, 10, 40, 20, 30});
+
+    EXPECT_EQ(handle.get_total_size(), 5);
+    ASSERT_TRUE(handle.get_value(20).has_value());
+    EXPECT_EQ(handle.get_value(20).value(), 20);
+    EXPECT_FALSE(handle.get_value(25).has_value());
+}
+
+/**
+ * @brief Tests that publish replaces the contents seen by later lookups.
+ */
+TEST(SnapshotBlockSequenceTest, PublishReplacesContents)
+{
+    iterator_mutex::SnapshotBlockSequence handle({1, 2, 3});
+
+    handle.publish({7, 8});
+    EXPECT_EQ(handle.get_total_size(), 2);
+    EXPECT_FALSE(handle.get_value(1).has_value());
+    EXPECT_TRUE(handle.get_value(8).has_value());
+
+    handle.publish(iterator_mutex::SnapshotBlockSequence::Snapshot({4, 5, 6, 9}));
+    EXPECT_EQ(handle.get_total_size(), 4);
+    EXPECT_TRUE(handle.get_value(9).has_value());
+}
+
+/**
+ * @brief Tests that an acquired snapshot keeps its contents across later publishes.
+ */
+TEST(SnapshotBlockSequenceTest, AcquiredSnapshotOutlivesPublish)
+{
+    iterator_mutex::SnapshotBlockSequence handle({1, 2, 3});
+
+    auto pinned = handle.acquire();
+    handle.publish({100});
+    handle.publish({200});
+
+    EXPECT_EQ(pinned->get_total_size(), 3);
+    EXPECT_TRUE(pinned->get_value(2).has_value());
+    EXPECT_TRUE(handle.get_value(200).has_value());
+}
+
+/**
+ * @brief Tests readers racing against a stream of publishes.
+ *
+ * Every published snapshot contains the same key range, so each lookup must succeed
+ * regardless of which snapshot it lands on. A use-after-free would typically crash
+ * here or show up under a sanitizer.
+ */
+TEST(SnapshotBlockSequenceTest, ReadersRunConcurrentlyWithPublishes)
+{
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 0);
+    iterator_mutex::SnapshotBlockSequence handle(values);
+
+    std::atomic<bool> keep_reading = true;
+    std::atomic<int> failures = 0;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+    {
+        readers.emplace_back(
+            [&, r]()
+            {
+                int i = r;
+                while (keep_reading)
+                {
+                    const int key = (i++ * 13) % 1000;
+                    if (handle.get_value(key) != key)
+                    {
+                        ++failures;
+                    }
+                }
+            });
+    }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        handle.publish(values);
+    }
+
+    keep_reading = false;
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+    EXPECT_EQ(failures, 0);
+}
+
+// --- EpochDomain ---
+
+/**
+ * @brief Tests that synchronize waits for a read section that started before it.
+ */
+TEST(EpochDomainTest, SynchronizeWaitsForActiveReaders)
+{
+    iterator_mutex::EpochDomain domain;
+    std::atomic<bool> synchronized = false;
+
+    auto guard = std::make_unique<iterator_mutex::EpochDomain::ReadGuard>(domain);
+    std::thread writer(
+        [&]()
+        {
+            domain.synchronize();
+            synchronized = true;
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(synchronized);
+
+    guard.reset();
+    writer.join();
+    EXPECT_TRUE(synchronized);
+}
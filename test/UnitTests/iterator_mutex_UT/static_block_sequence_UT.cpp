@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "key_types.hpp"
+#include "static_block_sequence.hpp"
+
+namespace
+{
+
+constexpr auto kPrimes = iterator_mutex::make_static_sequence<int>({13, 2, 7, 3, 11, 5, 19, 17});
+
+// Answered at compile time: the table is sorted and searched in constant expressions.
+static_assert(kPrimes.get_total_size() == 8);
+static_assert(kPrimes.get_keys()[0] == 2 && kPrimes.get_keys()[7] == 19);
+static_assert(kPrimes.get_value(11) == 11);
+static_assert(kPrimes.get_value(12) == std::nullopt);
+static_assert(kPrimes.lower_bound(12) == 5);
+static_assert(kPrimes.count_range(3, 17) == 5);
+
+constexpr iterator_mutex::StaticBlockSequence<0> kEmpty(std::array<int, 0>{});
+static_assert(kEmpty.get_value(1) == std::nullopt && kEmpty.lower_bound(1) == 0);
+
+// Code written once against the shared interface.
+template <typename Sequence>
+std::vector<std::optional<int>> look_up_all(const Sequence& sequence, int end)
+{
+    std::vector<std::optional<int>> results;
+    for (int key = 0; key < end; ++key)
+    {
+        results.push_back(sequence.get_value(key));
+    }
+    return results;
+}
+
+template <size_t N>
+void expect_matches_reference(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> dist(0, 3 * static_cast<int>(N) + 3);
+    std::array<int, N> values{};
+    for (int& value : values)
+    {
+        value = dist(rng);
+    }
+    const iterator_mutex::StaticBlockSequence<N> sequence(values);
+    std::vector<int> sorted(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    ASSERT_TRUE(std::equal(sorted.begin(), sorted.end(), sequence.get_keys().begin()));
+
+    for (int key = -1; key <= 3 * static_cast<int>(N) + 4; ++key)
+    {
+        const auto it = std::lower_bound(sorted.begin(), sorted.end(), key);
+        const bool present = it != sorted.end() && *it == key;
+        ASSERT_EQ(sequence.lower_bound(key), static_cast<size_t>(it - sorted.begin())) << "N " << N << " key " << key;
+        ASSERT_EQ(sequence.get_value(key), present ? std::optional<int>(key) : std::nullopt);
+        ASSERT_EQ(sequence.find_index(key), present ? std::optional<size_t>(it - sorted.begin()) : std::nullopt);
+    }
+}
+
+}  // namespace
+
+/**
+ * @brief Tests every query against std::lower_bound, for sizes around powers of two and with repeated keys.
+ */
+TEST(StaticBlockSequenceTest, MatchesReference)
+{
+    std::mt19937 rng(29);
+    for (int round = 0; round < 20; ++round)
+    {
+        expect_matches_reference<1>(rng);
+        expect_matches_reference<2>(rng);
+        expect_matches_reference<3>(rng);
+        expect_matches_reference<7>(rng);
+        expect_matches_reference<8>(rng);
+        expect_matches_reference<9>(rng);
+        expect_matches_reference<31>(rng);
+        expect_matches_reference<64>(rng);
+        expect_matches_reference<100>(rng);
+    }
+}
+
+/**
+ * @brief Tests that templated code gives the same answer for a static table and a sequence of the same keys.
+ */
+TEST(StaticBlockSequenceTest, InterchangeableWithDataBlockSequence)
+{
+    const std::vector<int> keys(kPrimes.get_keys().begin(), kPrimes.get_keys().end());
+    const iterator_mutex::DataBlockSequence sequence(keys);
+    EXPECT_EQ(kPrimes.get_total_size(), sequence.get_total_size());
+    const auto results = look_up_all(kPrimes, 25);
+    EXPECT_EQ(results, look_up_all(sequence, 25));
+    EXPECT_EQ(std::count(results.begin(), results.end(), std::nullopt), 25 - 8);
+}
+
+/**
+ * @brief Tests composite keys and a custom comparator, both sorted at compile time.
+ */
+TEST(StaticBlockSequenceTest, CompositeKeysAndComparator)
+{
+    using iterator_mutex::CompositeKey;
+    static constexpr auto kComposite =
+        iterator_mutex::make_static_sequence<CompositeKey>({{2, 1}, {1, 9}, {2, 0}, {1, 3}});
+    static_assert(kComposite.get_keys()[0] == CompositeKey{1, 3});
+    EXPECT_EQ(kComposite.get_value(CompositeKey{2, 0}), (CompositeKey{2, 0}));
+    EXPECT_EQ(kComposite.get_value(CompositeKey{2, 2}), std::nullopt);
+    EXPECT_EQ(kComposite.lower_bound(CompositeKey{2, 0}), 2u);
+
+    static constexpr auto kDescending =
+        iterator_mutex::make_static_sequence<std::uint64_t>({4, 9, 1}, std::greater<>{});
+    static_assert(kDescending.get_keys()[0] == 9);
+    EXPECT_EQ(kDescending.find_index(1), 2u);
+    EXPECT_EQ(kDescending.find_index(5), std::nullopt);
+    EXPECT_EQ(kDescending.count_range(9, 1), 2u);
+}
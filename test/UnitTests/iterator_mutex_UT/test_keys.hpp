@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Key sets shared by several test files.
+namespace test_keys
+{
+
+// 0, 2, ..., 2 * (count - 1): sorted, with every odd key a miss.
+inline std::vector<int> even_numbers(int count)
+{
+    std::vector<int> values(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i)
+    {
+        values[static_cast<size_t>(i)] = 2 * i;
+    }
+    return values;
+}
+
+}  // namespace test_keys
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "iterator_mutex_move_operations.hpp"
+#include "trace_points.hpp"
+
+using iterator_mutex::TraceEvent;
+
+namespace
+{
+
+struct RecordedEvent
+{
+    TraceEvent event;
+    const void* sequence;
+    std::uint64_t arg;
+};
+
+std::mutex g_recorded_mutex;
+std::vector<RecordedEvent> g_recorded;
+
+void record_event(TraceEvent event, const void* sequence, std::uint64_t arg)
+{
+    const std::lock_guard lock(g_recorded_mutex);
+    g_recorded.push_back({event, sequence, arg});
+}
+
+// The events recorded for sequence since the last call, in order, and forgets all of them.
+std::vector<TraceEvent> take_events(const void* sequence)
+{
+    const std::lock_guard lock(g_recorded_mutex);
+    std::vector<TraceEvent> events;
+    for (const RecordedEvent& recorded : g_recorded)
+    {
+        if (recorded.sequence == sequence)
+        {
+            events.push_back(recorded.event);
+        }
+    }
+    g_recorded.clear();
+    return events;
+}
+
+// Installs record_event for the lifetime of a test.
+class ScopedHandler
+{
+public:
+    ScopedHandler()
+    {
+        take_events(nullptr);
+        iterator_mutex::set_trace_handler(&record_event);
+    }
+    ~ScopedHandler()
+    {
+        iterator_mutex::set_trace_handler(nullptr);
+    }
+};
+
+}  // namespace
+
+/**
+ * @brief Tests that every event has a distinct name fit for a USDT probe.
+ */
+TEST(TracePointsTest, NamesEveryEvent)
+{
+    std::vector<const char*> names;
+    for (size_t i = 0; i < static_cast<size_t>(TraceEvent::Count); ++i)
+    {
+        const char* name = iterator_mutex::trace_event_name(static_cast<TraceEvent>(i));
+        EXPECT_STRNE(name, "unknown");
+        for (const char* other : names)
+        {
+            EXPECT_STRNE(name, other);
+        }
+        names.push_back(name);
+    }
+    EXPECT_STREQ(iterator_mutex::trace_event_name(TraceEvent::MoveLocked), "move_locked");
+}
+
+/**
+ * @brief Tests that without tracing readers hold a plain std::shared_lock and no handler is installed.
+ */
+TEST(TracePointsTest, DisabledAddsNothing)
+{
+    if constexpr (iterator_mutex::kTracingEnabled)
+    {
+        GTEST_SKIP() << "tracing is compiled in";
+    }
+    else
+    {
+        EXPECT_TRUE((std::is_same_v<iterator_mutex::DataBlockSequence::shared_lock_type,
+                                    std::shared_lock<std::shared_mutex>>));
+        const ScopedHandler handler;
+        EXPECT_EQ(iterator_mutex::get_trace_handler(), nullptr);
+        iterator_mutex::DataBlockSequence seq({3, 1, 2});
+        EXPECT_EQ(seq.get_value(2), 2);
+        EXPECT_TRUE(take_events(&seq).empty());
+    }
+}
+
+/**
+ * @brief Tests the events of a build, of lookups and of a move, in order and for the right sequence.
+ */
+TEST(TracePointsTest, SequenceEmitsEvents)
+{
+    if constexpr (!iterator_mutex::kTracingEnabled)
+    {
+        GTEST_SKIP() << "tracing is compiled out";
+    }
+    const ScopedHandler handler;
+    EXPECT_EQ(iterator_mutex::get_trace_handler(), &record_event);
+
+    iterator_mutex::DataBlockSequence seq({8, 2, 6, 4});
+    EXPECT_EQ(take_events(&seq),
+              (std::vector<TraceEvent>{TraceEvent::BuildBegin, TraceEvent::SortEnd, TraceEvent::BuildEnd}));
+
+    // A first lookup of 6 has no hint to go by; the repeat is answered by it.
+    EXPECT_EQ(seq.get_value(6), 6);
+    EXPECT_EQ(seq.get_value(6), 6);
+    EXPECT_EQ(take_events(&seq),
+              (std::vector<TraceEvent>{TraceEvent::SharedLockAcquire, TraceEvent::HintMiss,
+                                       TraceEvent::SharedLockRelease, TraceEvent::SharedLockAcquire,
+                                       TraceEvent::HintHit, TraceEvent::SharedLockRelease}));
+
+    {
+        const auto snapshot = seq.snapshot();
+        EXPECT_EQ(snapshot.lower_bound(5), 2);
+        EXPECT_EQ(snapshot.count_range(2, 8), 3);
+    }
+    const auto events = take_events(&seq);
+    ASSERT_GE(events.size(), 2u);
+    EXPECT_EQ(events.front(), TraceEvent::SharedLockAcquire);
+    EXPECT_EQ(events.back(), TraceEvent::SharedLockRelease);
+    EXPECT_EQ(std::count(events.begin(), events.end(), TraceEvent::SharedLockAcquire), 1);
+
+    // A move is traced on the sequence it moves into, with both lock times.
+    iterator_mutex::DataBlockSequence target(iterator_mutex::assume_sorted, std::vector<int>{1});
+    take_events(nullptr);
+    target = std::move(seq);
+    {
+        const std::lock_guard lock(g_recorded_mutex);
+        ASSERT_EQ(g_recorded.size(), 3u);
+        EXPECT_EQ(g_recorded[0].event, TraceEvent::MoveBegin);
+        EXPECT_EQ(g_recorded[1].event, TraceEvent::MoveLocked);
+        EXPECT_EQ(g_recorded[2].event, TraceEvent::MoveEnd);
+        for (const RecordedEvent& recorded : g_recorded)
+        {
+            EXPECT_EQ(recorded.sequence, &target);
+        }
+    }
+    take_events(nullptr);
+
+    iterator_mutex::set_trace_handler(nullptr);
+    EXPECT_EQ(target.get_value(4), 4);
+    EXPECT_TRUE(take_events(&target).empty());
+}